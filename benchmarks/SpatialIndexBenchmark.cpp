@@ -0,0 +1,226 @@
+// Compares the scene BVH against a linear scan for frustum, box and ray
+// queries at several object counts. Built with -DPLASTER_BUILD_BENCHMARKS=ON.
+
+#include "scene/DynamicAABBTree.h"
+#include "math/Frustum.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace Plaster;
+
+namespace {
+
+using Clock = std::chrono::high_resolution_clock;
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+struct World {
+    std::vector<BoundingBox> boxes;
+    float size;
+};
+
+// Props scattered at constant density, so larger levels are also wider
+World makeWorld(uint32_t count, std::mt19937& rng) {
+    World world;
+    world.size = std::cbrt(static_cast<float>(count)) * 8.0f;
+    std::uniform_real_distribution<float> position(-world.size * 0.5f, world.size * 0.5f);
+    std::uniform_real_distribution<float> extent(0.25f, 2.0f);
+
+    world.boxes.reserve(count);
+    for (uint32_t i = 0; i < count; i++) {
+        glm::vec3 center(position(rng), position(rng) * 0.1f, position(rng));
+        glm::vec3 half(extent(rng), extent(rng), extent(rng));
+        world.boxes.emplace_back(center - half, center + half);
+    }
+    return world;
+}
+
+std::vector<Frustum> makeFrustums(const World& world, uint32_t count, std::mt19937& rng) {
+    std::uniform_real_distribution<float> position(-world.size * 0.5f, world.size * 0.5f);
+    std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+    glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+
+    std::vector<Frustum> frustums;
+    for (uint32_t i = 0; i < count; i++) {
+        glm::vec3 eye(position(rng), 2.0f, position(rng));
+        float yaw = angle(rng);
+        glm::vec3 target = eye + glm::vec3(std::cos(yaw), -0.1f, std::sin(yaw));
+        frustums.emplace_back(projection * glm::lookAt(eye, target, glm::vec3(0.0f, 1.0f, 0.0f)));
+    }
+    return frustums;
+}
+
+void printRow(const char* name, double treeMs, double linearMs, size_t treeHits, size_t linearHits) {
+    std::cout << "  " << std::left << std::setw(16) << name << std::right
+              << std::setw(12) << std::fixed << std::setprecision(3) << treeMs
+              << std::setw(12) << linearMs
+              << std::setw(10) << std::setprecision(1) << (treeMs > 0.0 ? linearMs / treeMs : 0.0) << "x"
+              << (treeHits == linearHits ? "" : "  RESULT MISMATCH") << std::endl;
+}
+
+void runBenchmark(uint32_t count) {
+    std::mt19937 rng(1234 + count);
+    World world = makeWorld(count, rng);
+
+    std::vector<uint32_t> userData(count);
+    for (uint32_t i = 0; i < count; i++) {
+        userData[i] = i;
+    }
+
+    std::cout << count << " objects" << std::endl;
+
+    // Construction
+    DynamicAABBTree incremental;
+    auto start = Clock::now();
+    for (uint32_t i = 0; i < count; i++) {
+        incremental.createProxy(world.boxes[i], i);
+    }
+    double insertMs = elapsedMs(start);
+
+    DynamicAABBTree tree;
+    std::vector<int32_t> proxies;
+    start = Clock::now();
+    tree.build(world.boxes, userData, proxies);
+    double buildMs = elapsedMs(start);
+
+    std::cout << "  incremental insert " << std::fixed << std::setprecision(3) << insertMs
+              << " ms (height " << incremental.getHeight() << "), SAH build " << buildMs
+              << " ms (height " << tree.getHeight() << ")" << std::endl;
+    std::cout << "  " << std::left << std::setw(16) << "query" << std::right
+              << std::setw(12) << "tree ms" << std::setw(12) << "linear ms" << std::setw(11) << "speedup" << std::endl;
+
+    // Frustum culling: tree query plus exact re-test, against a full scan
+    std::vector<Frustum> frustums = makeFrustums(world, 100, rng);
+    size_t treeHits = 0;
+    start = Clock::now();
+    for (const Frustum& frustum : frustums) {
+        tree.query(frustum, [&](uint32_t index) {
+            treeHits += frustum.intersects(world.boxes[index]) ? 1 : 0;
+            return true;
+        });
+    }
+    double treeMs = elapsedMs(start);
+
+    size_t linearHits = 0;
+    start = Clock::now();
+    for (const Frustum& frustum : frustums) {
+        for (const BoundingBox& box : world.boxes) {
+            linearHits += frustum.intersects(box) ? 1 : 0;
+        }
+    }
+    printRow("frustum x100", treeMs, elapsedMs(start), treeHits, linearHits);
+
+    BoundsSoA bounds;
+    bounds.reserve(count);
+    for (const BoundingBox& box : world.boxes) {
+        bounds.push(box);
+    }
+    std::vector<uint8_t> visible;
+    size_t simdHits = 0;
+    start = Clock::now();
+    for (const Frustum& frustum : frustums) {
+        simdHits += cullBoxes(frustum, bounds, visible);
+    }
+    printRow("frustum simd", treeMs, elapsedMs(start), treeHits, simdHits);
+
+    // Box queries, e.g. a light's area of effect
+    std::uniform_real_distribution<float> position(-world.size * 0.5f, world.size * 0.5f);
+    std::vector<BoundingBox> regions;
+    for (uint32_t i = 0; i < 1000; i++) {
+        glm::vec3 center(position(rng), 0.0f, position(rng));
+        regions.emplace_back(center - glm::vec3(8.0f), center + glm::vec3(8.0f));
+    }
+
+    treeHits = 0;
+    start = Clock::now();
+    for (const BoundingBox& region : regions) {
+        tree.query(region, [&](uint32_t index) {
+            treeHits += region.overlaps(world.boxes[index]) ? 1 : 0;
+            return true;
+        });
+    }
+    treeMs = elapsedMs(start);
+
+    linearHits = 0;
+    start = Clock::now();
+    for (const BoundingBox& region : regions) {
+        for (const BoundingBox& box : world.boxes) {
+            linearHits += region.overlaps(box) ? 1 : 0;
+        }
+    }
+    printRow("box x1000", treeMs, elapsedMs(start), treeHits, linearHits);
+
+    // Closest-hit picking rays
+    std::uniform_real_distribution<float> direction(-1.0f, 1.0f);
+    std::vector<Ray> rays;
+    for (uint32_t i = 0; i < 1000; i++) {
+        glm::vec3 dir = glm::normalize(glm::vec3(direction(rng), direction(rng) * 0.2f, direction(rng)) + glm::vec3(0.0f, 0.0f, 0.001f));
+        rays.emplace_back(glm::vec3(position(rng), 1.0f, position(rng)), dir);
+    }
+
+    const float maxDistance = 200.0f;
+    treeHits = 0;
+    start = Clock::now();
+    for (const Ray& ray : rays) {
+        float closest = maxDistance;
+        bool hit = false;
+        tree.raycast(ray, maxDistance, [&](uint32_t index, float) {
+            float distance = 0.0f;
+            if (ray.intersects(world.boxes[index], closest, distance)) {
+                closest = distance;
+                hit = true;
+            }
+            return closest;
+        });
+        treeHits += hit ? 1 : 0;
+    }
+    treeMs = elapsedMs(start);
+
+    linearHits = 0;
+    start = Clock::now();
+    for (const Ray& ray : rays) {
+        float closest = maxDistance;
+        bool hit = false;
+        for (const BoundingBox& box : world.boxes) {
+            float distance = 0.0f;
+            if (ray.intersects(box, closest, distance)) {
+                closest = distance;
+                hit = true;
+            }
+        }
+        linearHits += hit ? 1 : 0;
+    }
+    printRow("raycast x1000", treeMs, elapsedMs(start), treeHits, linearHits);
+
+    // Moves: a tenth of the objects drift a little each frame
+    std::uniform_real_distribution<float> jitter(-0.3f, 0.3f);
+    uint32_t reinserted = 0;
+    start = Clock::now();
+    for (uint32_t frame = 0; frame < 10; frame++) {
+        for (uint32_t i = frame; i < count; i += 10) {
+            glm::vec3 offset(jitter(rng), 0.0f, jitter(rng));
+            world.boxes[i] = BoundingBox(world.boxes[i].min + offset, world.boxes[i].max + offset);
+            reinserted += tree.moveProxy(proxies[i], world.boxes[i]) ? 1 : 0;
+        }
+    }
+    std::cout << "  moves: " << count << " updates in " << std::setprecision(3) << elapsedMs(start)
+              << " ms, " << reinserted << " reinserted (height " << tree.getHeight() << ")" << std::endl
+              << std::endl;
+}
+
+}
+
+int main() {
+    for (uint32_t count : {1000u, 10000u, 100000u, 200000u}) {
+        runBenchmark(count);
+    }
+    return 0;
+}
@@ -0,0 +1,470 @@
+#include "PostProcessor.h"
+#include "../renderer/PushConstants.h"
+#include "../renderer/ShaderCompiler.h"
+#include <algorithm>
+#include <iostream>
+
+namespace Plaster {
+
+namespace {
+
+const char* NOISE_SHADER_PATH = "src/shaders/organic_noise_generator.frag";
+
+}
+
+PostProcessor::PostProcessor()
+    : m_shaderCacheDirectory(ShaderCompiler::DEFAULT_CACHE_DIRECTORY)
+    , m_sceneFormat(VK_FORMAT_UNDEFINED)
+    , m_depthFormat(VK_FORMAT_UNDEFINED)
+    , m_outputFormat(VK_FORMAT_UNDEFINED)
+    , m_descriptorLayout(VK_NULL_HANDLE)
+    , m_pipelineLayout(VK_NULL_HANDLE)
+    , m_noisePipeline(VK_NULL_HANDLE)
+    , m_sampler(VK_NULL_HANDLE)
+    , m_sceneResource(0)
+    , m_depthResource(0)
+    , m_outputResource(0)
+    , m_noiseResource(0)
+    , m_noisePass(0)
+    , m_depthRange(0.1f, 100.0f)
+    , m_time(0.0f)
+    , m_frameNumber(0)
+{
+}
+
+PostProcessor::~PostProcessor() {
+}
+
+void PostProcessor::addEffect(const std::string& fragmentShaderPath, float scale, PostEffectInputs inputs) {
+    Effect effect;
+    effect.fragmentShaderPath = fragmentShaderPath;
+    effect.scale = scale;
+    effect.inputs = inputs;
+    m_effects.push_back(effect);
+}
+
+bool PostProcessor::readsDepth() const {
+    return std::any_of(m_effects.begin(), m_effects.end(),
+                       [](const Effect& effect) { return effect.inputs.depth; });
+}
+
+bool PostProcessor::create(VkDevice device, VkPipelineCache pipelineCache, uint32_t frameCount,
+                           VkFormat sceneFormat, VkFormat depthFormat, VkFormat outputFormat) {
+    m_sceneFormat = sceneFormat;
+    m_depthFormat = depthFormat;
+    m_outputFormat = outputFormat;
+    m_graphs.resize(frameCount);
+    m_descriptorSets.create();
+    m_startTime = std::chrono::steady_clock::now();
+
+    // Nearest keeps the pixels hard when an effect runs at another scale
+    VkSamplerCreateInfo samplerInfo{};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = VK_FILTER_NEAREST;
+    samplerInfo.minFilter = VK_FILTER_NEAREST;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.maxLod = 0.0f;
+    if (vkCreateSampler(device, &samplerInfo, nullptr, &m_sampler) != VK_SUCCESS) {
+        std::cerr << "Failed to create post process sampler!" << std::endl;
+        return false;
+    }
+
+    // Input, scene depth and noise; effects leave unused bindings unwritten
+    VkDescriptorSetLayoutBinding bindings[3]{};
+    for (uint32_t i = 0; i < 3; i++) {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    }
+
+    VkDescriptorSetLayoutCreateInfo setLayoutInfo{};
+    setLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    setLayoutInfo.bindingCount = 3;
+    setLayoutInfo.pBindings = bindings;
+    if (vkCreateDescriptorSetLayout(device, &setLayoutInfo, nullptr, &m_descriptorLayout) != VK_SUCCESS) {
+        std::cerr << "Failed to create post process descriptor set layout!" << std::endl;
+        return false;
+    }
+
+    VkPushConstantRange pushRange{};
+    pushRange.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    pushRange.offset = 0;
+    pushRange.size = sizeof(PostPushConstants);
+
+    VkPipelineLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    layoutInfo.setLayoutCount = 1;
+    layoutInfo.pSetLayouts = &m_descriptorLayout;
+    layoutInfo.pushConstantRangeCount = 1;
+    layoutInfo.pPushConstantRanges = &pushRange;
+    if (vkCreatePipelineLayout(device, &layoutInfo, nullptr, &m_pipelineLayout) != VK_SUCCESS) {
+        std::cerr << "Failed to create post process pipeline layout!" << std::endl;
+        return false;
+    }
+
+    return createPipelines(device, pipelineCache);
+}
+
+void PostProcessor::destroy(VkDevice device, VmaAllocator allocator) {
+    for (RenderGraph& graph : m_graphs) {
+        graph.destroy(device, allocator);
+    }
+    m_graphs.clear();
+    m_descriptorSets.destroy(device);
+
+    for (Effect& effect : m_effects) {
+        if (effect.pipeline != VK_NULL_HANDLE) {
+            vkDestroyPipeline(device, effect.pipeline, nullptr);
+            effect.pipeline = VK_NULL_HANDLE;
+        }
+    }
+    if (m_noisePipeline != VK_NULL_HANDLE) {
+        vkDestroyPipeline(device, m_noisePipeline, nullptr);
+        m_noisePipeline = VK_NULL_HANDLE;
+    }
+    if (m_pipelineLayout != VK_NULL_HANDLE) {
+        vkDestroyPipelineLayout(device, m_pipelineLayout, nullptr);
+        m_pipelineLayout = VK_NULL_HANDLE;
+    }
+    if (m_descriptorLayout != VK_NULL_HANDLE) {
+        vkDestroyDescriptorSetLayout(device, m_descriptorLayout, nullptr);
+        m_descriptorLayout = VK_NULL_HANDLE;
+    }
+    if (m_sampler != VK_NULL_HANDLE) {
+        vkDestroySampler(device, m_sampler, nullptr);
+        m_sampler = VK_NULL_HANDLE;
+    }
+}
+
+bool PostProcessor::createPipelines(VkDevice device, VkPipelineCache pipelineCache) {
+    if (m_effects.empty()) {
+        return true;
+    }
+
+    // Pipelines only need a compatible render pass; the graph builds the real ones
+    VkAttachmentDescription attachment{};
+    attachment.format = m_sceneFormat;
+    attachment.samples = VK_SAMPLE_COUNT_1_BIT;
+    attachment.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    attachment.initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    attachment.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+    VkAttachmentReference colorReference{0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL};
+
+    VkSubpassDescription subpass{};
+    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpass.colorAttachmentCount = 1;
+    subpass.pColorAttachments = &colorReference;
+
+    VkRenderPassCreateInfo renderPassInfo{};
+    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    renderPassInfo.attachmentCount = 1;
+    renderPassInfo.pAttachments = &attachment;
+    renderPassInfo.subpassCount = 1;
+    renderPassInfo.pSubpasses = &subpass;
+
+    VkRenderPass renderPass = VK_NULL_HANDLE;
+    if (vkCreateRenderPass(device, &renderPassInfo, nullptr, &renderPass) != VK_SUCCESS) {
+        std::cerr << "Failed to create post process render pass!" << std::endl;
+        return false;
+    }
+
+    ShaderCompiler compiler;
+    compiler.setCacheDirectory(m_shaderCacheDirectory);
+    std::vector<uint32_t> vertexSpirv;
+    if (!compiler.compileFromFile("src/shaders/fullscreen.vert", ShaderStage::VERTEX, "main", vertexSpirv)) {
+        std::cerr << "Failed to compile fullscreen shader: " << compiler.getLastError() << std::endl;
+        vkDestroyRenderPass(device, renderPass, nullptr);
+        return false;
+    }
+    VkShaderModule vertexModule = compiler.createShaderModule(device, vertexSpirv);
+
+    VkPipelineVertexInputStateCreateInfo vertexInput{};
+    vertexInput.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+
+    VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
+    inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+    VkPipelineViewportStateCreateInfo viewportState{};
+    viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    viewportState.viewportCount = 1;
+    viewportState.scissorCount = 1;
+
+    VkPipelineRasterizationStateCreateInfo rasterizer{};
+    rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+    rasterizer.cullMode = VK_CULL_MODE_NONE;
+    rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+    rasterizer.lineWidth = 1.0f;
+
+    VkPipelineMultisampleStateCreateInfo multisampling{};
+    multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+    VkPipelineColorBlendAttachmentState blendAttachment{};
+    blendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
+                                     VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+
+    VkPipelineColorBlendStateCreateInfo colorBlending{};
+    colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    colorBlending.attachmentCount = 1;
+    colorBlending.pAttachments = &blendAttachment;
+
+    VkDynamicState dynamicStates[] = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+    VkPipelineDynamicStateCreateInfo dynamicState{};
+    dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamicState.dynamicStateCount = 2;
+    dynamicState.pDynamicStates = dynamicStates;
+
+    // The noise generator, then every effect
+    std::vector<std::pair<std::string, VkPipeline*>> pipelines;
+    pipelines.emplace_back(NOISE_SHADER_PATH, &m_noisePipeline);
+    for (Effect& effect : m_effects) {
+        pipelines.emplace_back(effect.fragmentShaderPath, &effect.pipeline);
+    }
+
+    bool success = vertexModule != VK_NULL_HANDLE;
+    for (const auto& [fragmentShaderPath, pipeline] : pipelines) {
+        if (!success) break;
+
+        std::vector<uint32_t> fragmentSpirv;
+        if (!compiler.compileFromFile(fragmentShaderPath, ShaderStage::FRAGMENT, "main", fragmentSpirv)) {
+            std::cerr << "Failed to compile post effect " << fragmentShaderPath << ": "
+                      << compiler.getLastError() << std::endl;
+            success = false;
+            break;
+        }
+        VkShaderModule fragmentModule = compiler.createShaderModule(device, fragmentSpirv);
+        if (fragmentModule == VK_NULL_HANDLE) {
+            success = false;
+            break;
+        }
+
+        VkPipelineShaderStageCreateInfo stages[2]{};
+        stages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        stages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+        stages[0].module = vertexModule;
+        stages[0].pName = "main";
+        stages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        stages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+        stages[1].module = fragmentModule;
+        stages[1].pName = "main";
+
+        VkGraphicsPipelineCreateInfo pipelineInfo{};
+        pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+        pipelineInfo.stageCount = 2;
+        pipelineInfo.pStages = stages;
+        pipelineInfo.pVertexInputState = &vertexInput;
+        pipelineInfo.pInputAssemblyState = &inputAssembly;
+        pipelineInfo.pViewportState = &viewportState;
+        pipelineInfo.pRasterizationState = &rasterizer;
+        pipelineInfo.pMultisampleState = &multisampling;
+        pipelineInfo.pColorBlendState = &colorBlending;
+        pipelineInfo.pDynamicState = &dynamicState;
+        pipelineInfo.layout = m_pipelineLayout;
+        pipelineInfo.renderPass = renderPass;
+        pipelineInfo.subpass = 0;
+
+        if (vkCreateGraphicsPipelines(device, pipelineCache, 1, &pipelineInfo, nullptr, pipeline) != VK_SUCCESS) {
+            std::cerr << "Failed to create post effect pipeline for " << fragmentShaderPath << "!" << std::endl;
+            success = false;
+        }
+        vkDestroyShaderModule(device, fragmentModule, nullptr);
+    }
+
+    if (vertexModule != VK_NULL_HANDLE) {
+        vkDestroyShaderModule(device, vertexModule, nullptr);
+    }
+    vkDestroyRenderPass(device, renderPass, nullptr);
+    return success;
+}
+
+bool PostProcessor::resize(VkDevice device, VmaAllocator allocator, VkExtent2D sceneExtent, VkExtent2D outputExtent) {
+    // Cached sets name the old views, whose handles may be reused
+    m_descriptorSets.clear(device);
+
+    for (RenderGraph& graph : m_graphs) {
+        graph.destroy(device, allocator);
+        if (!buildGraph(device, allocator, graph, sceneExtent, outputExtent)) {
+            return false;
+        }
+    }
+
+    if (!m_effects.empty()) {
+        std::cout << "Post chain: " << m_effects.size() << " effects"
+                  << (m_graphs[0].isPassCulled(m_noisePass) ? ", noise pass culled, " : " and noise, ")
+                  << getTargetMemorySize() / 1024 << " KB of targets per frame ("
+                  << getUnaliasedTargetMemorySize() / 1024 << " KB unaliased)" << std::endl;
+    }
+    return true;
+}
+
+bool PostProcessor::buildGraph(VkDevice device, VmaAllocator allocator, RenderGraph& graph,
+                               VkExtent2D sceneExtent, VkExtent2D outputExtent) {
+    // The scene pass leaves its target ready to blit; nothing reads it afterwards
+    RenderGraphImageState sceneInitial{VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                       VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                                       VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT};
+    m_sceneResource = graph.importImage("scene", {sceneExtent, m_sceneFormat}, sceneInitial, {});
+
+    // The output is acquired at the transfer stage and handed to the UI pass
+    RenderGraphImageState outputInitial{VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_TRANSFER_BIT, 0};
+    RenderGraphImageState outputFinal{VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                                      VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                                      VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT};
+    m_outputResource = graph.importImage("output", {outputExtent, m_outputFormat}, outputInitial, outputFinal);
+
+    // Depth comes straight from the scene pass, which stores it when an effect reads it
+    if (readsDepth()) {
+        RenderGraphImageState depthInitial{VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+                                           VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                                           VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT};
+        m_depthResource = graph.importImage("depth", {sceneExtent, m_depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT},
+                                            depthInitial, {});
+    }
+
+    // Declared whether or not anything reads it; compile() culls it if not
+    if (!m_effects.empty()) {
+        RenderGraphImageDesc noiseDesc;
+        noiseDesc.extent.width = std::max(1u, static_cast<uint32_t>(sceneExtent.width * NOISE_SCALE));
+        noiseDesc.extent.height = std::max(1u, static_cast<uint32_t>(sceneExtent.height * NOISE_SCALE));
+        noiseDesc.format = m_sceneFormat;
+        m_noiseResource = graph.createImage("organic noise", noiseDesc);
+
+        m_noisePass = graph.addPass("organic noise", RenderGraphPassType::GRAPHICS,
+            [this](const RenderGraphContext& context) { recordNoise(context); });
+        graph.write(m_noisePass, m_noiseResource, RenderGraphAccess::COLOR_ATTACHMENT);
+    }
+
+    RenderGraphResource input = m_sceneResource;
+    for (size_t i = 0; i < m_effects.size(); i++) {
+        RenderGraphImageDesc desc;
+        desc.extent.width = std::max(1u, static_cast<uint32_t>(sceneExtent.width * m_effects[i].scale));
+        desc.extent.height = std::max(1u, static_cast<uint32_t>(sceneExtent.height * m_effects[i].scale));
+        desc.format = m_sceneFormat;
+        RenderGraphResource target = graph.createImage(m_effects[i].fragmentShaderPath, desc);
+
+        RenderGraphPassId pass = graph.addPass(m_effects[i].fragmentShaderPath, RenderGraphPassType::GRAPHICS,
+            [this, i, input](const RenderGraphContext& context) { recordEffect(context, i, input); });
+        graph.read(pass, input, RenderGraphAccess::SAMPLED_FRAGMENT);
+        if (m_effects[i].inputs.depth) {
+            graph.read(pass, m_depthResource, RenderGraphAccess::SAMPLED_FRAGMENT);
+        }
+        if (m_effects[i].inputs.noise) {
+            graph.read(pass, m_noiseResource, RenderGraphAccess::SAMPLED_FRAGMENT);
+        }
+        graph.write(pass, target, RenderGraphAccess::COLOR_ATTACHMENT);
+        input = target;
+    }
+
+    RenderGraphPassId upscale = graph.addPass("upscale", RenderGraphPassType::TRANSFER,
+        [this, input](const RenderGraphContext& context) { recordUpscale(context, input); });
+    graph.read(upscale, input, RenderGraphAccess::TRANSFER_SRC);
+    graph.write(upscale, m_outputResource, RenderGraphAccess::TRANSFER_DST);
+
+    return graph.compile(device, allocator);
+}
+
+void PostProcessor::record(VkCommandBuffer commandBuffer, VkDevice device, uint32_t frameIndex,
+                           VkImage sceneImage, VkImageView sceneView, VkImage depthImage, VkImageView depthView,
+                           VkImage outputImage, VkImageView outputView) {
+    RenderGraph& graph = m_graphs[frameIndex];
+    graph.setImportedImage(m_sceneResource, sceneImage, sceneView);
+    if (readsDepth()) {
+        graph.setImportedImage(m_depthResource, depthImage, depthView);
+    }
+    graph.setImportedImage(m_outputResource, outputImage, outputView);
+
+    m_time = std::chrono::duration<float>(std::chrono::steady_clock::now() - m_startTime).count();
+    graph.execute(commandBuffer, device);
+    m_frameNumber++;
+}
+
+void PostProcessor::recordNoise(const RenderGraphContext& context) {
+    // Nothing to sample, so no set is bound
+    vkCmdBindPipeline(context.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_noisePipeline);
+    setFullscreenState(context, context.extent);
+    vkCmdDraw(context.commandBuffer, 3, 1, 0, 0);
+}
+
+void PostProcessor::recordEffect(const RenderGraphContext& context, size_t effectIndex, RenderGraphResource input) {
+    const RenderGraph& graph = *context.graph;
+    const Effect& effect = m_effects[effectIndex];
+
+    std::vector<DescriptorBinding> bindings = {
+        DescriptorBinding::forImage(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, graph.getImageView(input), m_sampler)
+    };
+    if (effect.inputs.depth) {
+        bindings.push_back(DescriptorBinding::forImage(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                                                       graph.getImageView(m_depthResource), m_sampler));
+    }
+    if (effect.inputs.noise) {
+        bindings.push_back(DescriptorBinding::forImage(2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                                                       graph.getImageView(m_noiseResource), m_sampler));
+    }
+    VkDescriptorSet descriptorSet = m_descriptorSets.get(context.device, m_descriptorLayout, bindings);
+    if (descriptorSet == VK_NULL_HANDLE) {
+        return;
+    }
+
+    vkCmdBindPipeline(context.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, effect.pipeline);
+    vkCmdBindDescriptorSets(context.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout,
+                            0, 1, &descriptorSet, 0, nullptr);
+    setFullscreenState(context, graph.getDesc(input).extent);
+    vkCmdDraw(context.commandBuffer, 3, 1, 0, 0);
+}
+
+void PostProcessor::setFullscreenState(const RenderGraphContext& context, VkExtent2D inputExtent) {
+    // Viewport, scissor and constants for a full-screen draw over the pass's target
+    VkViewport viewport{};
+    viewport.width = static_cast<float>(context.extent.width);
+    viewport.height = static_cast<float>(context.extent.height);
+    viewport.maxDepth = 1.0f;
+    VkRect2D scissor{{0, 0}, context.extent};
+    vkCmdSetViewport(context.commandBuffer, 0, 1, &viewport);
+    vkCmdSetScissor(context.commandBuffer, 0, 1, &scissor);
+
+    PostPushConstants constants;
+    constants.inverseInputSize = glm::vec2(1.0f / inputExtent.width, 1.0f / inputExtent.height);
+    constants.time = m_time;
+    constants.frame = m_frameNumber;
+    constants.targetSize = glm::vec2(context.extent.width, context.extent.height);
+    constants.depthRange = m_depthRange;
+    pushConstants(context.commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT, constants);
+}
+
+void PostProcessor::recordUpscale(const RenderGraphContext& context, RenderGraphResource input) {
+    // Nearest-neighbour upscale into the output image keeps the pixels hard
+    const RenderGraph& graph = *context.graph;
+    const VkExtent2D srcExtent = graph.getDesc(input).extent;
+    const VkExtent2D dstExtent = graph.getDesc(m_outputResource).extent;
+
+    VkImageBlit blit{};
+    blit.srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+    blit.srcOffsets[1] = {static_cast<int32_t>(srcExtent.width), static_cast<int32_t>(srcExtent.height), 1};
+    blit.dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+    blit.dstOffsets[1] = {static_cast<int32_t>(dstExtent.width), static_cast<int32_t>(dstExtent.height), 1};
+
+    vkCmdBlitImage(context.commandBuffer,
+                   graph.getImage(input), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                   graph.getImage(m_outputResource), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                   1, &blit, VK_FILTER_NEAREST);
+}
+
+VkDeviceSize PostProcessor::getTargetMemorySize() const {
+    return m_graphs.empty() ? 0 : m_graphs[0].getAliasedMemorySize();
+}
+
+VkDeviceSize PostProcessor::getUnaliasedTargetMemorySize() const {
+    return m_graphs.empty() ? 0 : m_graphs[0].getUnaliasedMemorySize();
+}
+
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include "../renderer/DescriptorAllocator.h"
+#include "../renderer/RenderGraph.h"
+#include <vulkan/vulkan.h>
+#include <vk_mem_alloc.h>
+#include <glm/glm.hpp>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Plaster {
+
+// Constants pushed to every effect's fragment shader
+struct PostPushConstants {
+    glm::vec2 inverseInputSize;  // One texel of the input image in UV units
+    float time;                  // Seconds since the post processor was created
+    uint32_t frame;              // Executions so far, for temporal patterns
+    glm::vec2 targetSize;        // The effect's own target in pixels
+    glm::vec2 depthRange;        // Camera near and far planes, to linearise scene depth
+};
+
+// Scene images an effect samples besides its input
+struct PostEffectInputs {
+    bool depth = false;  // Scene depth at binding 1
+    bool noise = false;  // Organic noise at binding 2, regenerated every frame
+};
+
+// Full-screen effects run in order on the scene image, then a nearest
+// upscale into the output image, all as passes of a RenderGraph so the
+// barriers, layout transitions and intermediate targets are the graph's
+// business. Each effect renders into its own target at a fraction of the
+// scene size; targets whose lifetimes do not overlap share memory.
+//
+// An effect is a fragment shader run over src/shaders/fullscreen.vert. It
+// reads its input from a sampler2D at set 0, binding 0, the UV from location
+// 0, PostPushConstants as a push constant block, and writes location 0. The
+// PostEffectInputs it asks for are bound as sampler2Ds at bindings 1 and 2.
+// The noise comes from a pass of its own at the start of the chain, which
+// the graph culls when no effect reads it.
+class PostProcessor {
+public:
+    PostProcessor();
+    ~PostProcessor();
+
+    PostProcessor(const PostProcessor&) = delete;
+    PostProcessor& operator=(const PostProcessor&) = delete;
+
+    // Append an effect; scale sizes its target against the scene. Must be
+    // called before create().
+    void addEffect(const std::string& fragmentShaderPath, float scale = 1.0f, PostEffectInputs inputs = {});
+
+    // Whether any effect samples scene depth, in which case the scene pass
+    // must store it and give it SAMPLED usage
+    bool readsDepth() const;
+
+    // Where effect SPIR-V is cached. Must be set before create().
+    void setShaderCacheDirectory(const std::string& directory) { m_shaderCacheDirectory = directory; }
+
+    // Compile the effects' pipelines. Targets use sceneFormat.
+    bool create(VkDevice device, VkPipelineCache pipelineCache, uint32_t frameCount,
+                VkFormat sceneFormat, VkFormat depthFormat, VkFormat outputFormat);
+    void destroy(VkDevice device, VmaAllocator allocator);
+
+    // (Re)build every frame's graph for new scene and output sizes. The GPU
+    // must be idle.
+    bool resize(VkDevice device, VmaAllocator allocator, VkExtent2D sceneExtent, VkExtent2D outputExtent);
+
+    // The camera the scene was drawn with, for effects reading depth
+    void setDepthRange(float nearPlane, float farPlane) { m_depthRange = glm::vec2(nearPlane, farPlane); }
+
+    // Record the chain outside any render pass. The scene must have just been
+    // written as a color attachment and left in TRANSFER_SRC_OPTIMAL, and its
+    // depth, when readsDepth(), stored in DEPTH_STENCIL_ATTACHMENT_OPTIMAL; the
+    // output is left in COLOR_ATTACHMENT_OPTIMAL for the UI pass to load.
+    void record(VkCommandBuffer commandBuffer, VkDevice device, uint32_t frameIndex,
+                VkImage sceneImage, VkImageView sceneView, VkImage depthImage, VkImageView depthView,
+                VkImage outputImage, VkImageView outputView);
+
+    size_t getEffectCount() const { return m_effects.size(); }
+
+    // Intermediate target memory of one frame's graph, and what it would take without aliasing
+    VkDeviceSize getTargetMemorySize() const;
+    VkDeviceSize getUnaliasedTargetMemorySize() const;
+
+private:
+    struct Effect {
+        std::string fragmentShaderPath;
+        float scale;
+        PostEffectInputs inputs;
+        VkPipeline pipeline = VK_NULL_HANDLE;
+    };
+
+    // The noise target is smooth, so it renders at a fraction of the scene
+    static constexpr float NOISE_SCALE = 0.5f;
+
+    std::vector<Effect> m_effects;
+    std::string m_shaderCacheDirectory;
+    std::vector<RenderGraph> m_graphs;  // One per frame in flight
+    VkFormat m_sceneFormat;
+    VkFormat m_depthFormat;
+    VkFormat m_outputFormat;
+    VkDescriptorSetLayout m_descriptorLayout;
+    VkPipelineLayout m_pipelineLayout;
+    VkPipeline m_noisePipeline;
+    VkSampler m_sampler;
+
+    // Each effect's input set is the same every time a frame slot comes round,
+    // so sets are written once and kept until resize() replaces the images
+    DescriptorSetCache m_descriptorSets;
+
+    // Per-frame values the recording callbacks read
+    RenderGraphResource m_sceneResource;
+    RenderGraphResource m_depthResource;
+    RenderGraphResource m_outputResource;
+    RenderGraphResource m_noiseResource;
+    RenderGraphPassId m_noisePass;
+    glm::vec2 m_depthRange;
+    std::chrono::steady_clock::time_point m_startTime;
+    float m_time;
+    uint32_t m_frameNumber;
+
+    bool createPipelines(VkDevice device, VkPipelineCache pipelineCache);
+    bool buildGraph(VkDevice device, VmaAllocator allocator, RenderGraph& graph,
+                    VkExtent2D sceneExtent, VkExtent2D outputExtent);
+    void recordNoise(const RenderGraphContext& context);
+    void recordEffect(const RenderGraphContext& context, size_t effectIndex, RenderGraphResource input);
+    void setFullscreenState(const RenderGraphContext& context, VkExtent2D inputExtent);
+    void recordUpscale(const RenderGraphContext& context, RenderGraphResource input);
+};
+
+}
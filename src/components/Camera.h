@@ -30,6 +30,10 @@ public:
     // Projection parameters
     void setAspectRatio(float aspectRatio);
     void setFOV(float fov);
+    float getFOV() const { return m_fov; }
+    float getAspectRatio() const { return m_aspectRatio; }
+    float getNearPlane() const { return m_nearPlane; }
+    float getFarPlane() const { return m_farPlane; }
 
 private:
     void updateVectors();
@@ -1,21 +1,166 @@
 #include <iostream>
 #include <stdexcept>
 #include <memory>
+#include <string>
+#include <chrono>
 #include "platform/Window.h"
 #include "renderer/VulkanRenderer.h"
 #include "scene/Scene.h"
 #include "renderer/MeshPrimitives.h"
 
-int main() {
+int main(int argc, char** argv) {
     try {
         std::cout << "Plaster Engine - Plastiboo Rendering Test" << std::endl;
 
-        // Create window
-        Window window(1280, 720, "Plaster Engine - Plastiboo Demo");
+        // --record-threads <n> records scene draws on n worker threads
+        // --headless renders offscreen for --frames <n> frames at --width x --height
+        // and writes the last one to --output <file> (.png or raw RGBA8)
+        // --internal-res <w>x<h> or --internal-scale <f> sets the scene resolution
+        // --depth-prepass lays down depth before the main pass
+        // --staging-mb <n> sizes the upload staging ring
+        // --cpu-culling sorts and culls on the CPU instead of in a compute pass
+        // --lod-threshold <px> sets the projected LOD error allowed (0 disables LOD)
+        // --no-bindless binds a descriptor set per material even when bindless is supported
+        // --draw-data instanced|push|descriptor picks how per-object data reaches the
+        // shaders; the per-draw modes issue a draw per object and imply --cpu-culling
+        // --object-grid <n> adds an n x n grid of small cubes to stress per-draw cost
+        // --post-effect <frag>[@scale] runs a full-screen effect on the scene before the
+        // upscale; repeat it to chain effects in order
+        // --plastiboo-post runs the Plastiboo post process and spatiotemporal dither,
+        // which sample scene depth and generated noise, ahead of any --post-effect
+        // --geometry-vertices <n> and --geometry-indices <n> size each vertex format's
+        // geometry pool (indices per index type)
+        // --shader-cache <dir> caches compiled SPIR-V in dir (empty disables the cache)
+        // --clear-shader-cache deletes the cached SPIR-V before compiling
+        uint32_t recordThreads = 0;
+        bool headless = false;
+        uint32_t frameCount = 100;
+        uint32_t width = 1280;
+        uint32_t height = 720;
+        std::string outputPath;
+        uint32_t internalWidth = 320;
+        uint32_t internalHeight = 240;
+        float internalScale = 0.0f;
+        bool depthPrepass = false;
+        uint32_t stagingMegabytes = 64;
+        bool cpuCulling = false;
+        bool bindless = true;
+        Plaster::DrawDataMode drawDataMode = Plaster::DrawDataMode::INSTANCED;
+        uint32_t objectGrid = 0;
+        std::vector<std::pair<std::string, float>> postEffects;
+        bool plastibooPost = false;
+        std::string shaderCacheDirectory = Plaster::ShaderCompiler::DEFAULT_CACHE_DIRECTORY;
+        bool clearShaderCache = false;
+        uint32_t geometryVertices = Plaster::GeometryPool::DEFAULT_VERTEX_CAPACITY;
+        uint32_t geometryIndices = Plaster::GeometryPool::DEFAULT_INDEX_CAPACITY;
+        Plaster::LodSelection lodSelection;
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            if (arg == "--record-threads" && i + 1 < argc) {
+                recordThreads = static_cast<uint32_t>(std::stoul(argv[++i]));
+            } else if (arg == "--headless") {
+                headless = true;
+            } else if (arg == "--frames" && i + 1 < argc) {
+                frameCount = static_cast<uint32_t>(std::stoul(argv[++i]));
+            } else if (arg == "--width" && i + 1 < argc) {
+                width = static_cast<uint32_t>(std::stoul(argv[++i]));
+            } else if (arg == "--height" && i + 1 < argc) {
+                height = static_cast<uint32_t>(std::stoul(argv[++i]));
+            } else if (arg == "--output" && i + 1 < argc) {
+                outputPath = argv[++i];
+            } else if (arg == "--internal-res" && i + 1 < argc) {
+                std::string res = argv[++i];
+                size_t split = res.find('x');
+                if (split != std::string::npos) {
+                    internalWidth = static_cast<uint32_t>(std::stoul(res.substr(0, split)));
+                    internalHeight = static_cast<uint32_t>(std::stoul(res.substr(split + 1)));
+                }
+            } else if (arg == "--internal-scale" && i + 1 < argc) {
+                internalScale = std::stof(argv[++i]);
+            } else if (arg == "--depth-prepass") {
+                depthPrepass = true;
+            } else if (arg == "--staging-mb" && i + 1 < argc) {
+                stagingMegabytes = static_cast<uint32_t>(std::stoul(argv[++i]));
+            } else if (arg == "--cpu-culling") {
+                cpuCulling = true;
+            } else if (arg == "--lod-threshold" && i + 1 < argc) {
+                lodSelection.thresholdPixels = std::stof(argv[++i]);
+            } else if (arg == "--no-bindless") {
+                bindless = false;
+            } else if (arg == "--draw-data" && i + 1 < argc) {
+                std::string mode = argv[++i];
+                if (mode == "push") {
+                    drawDataMode = Plaster::DrawDataMode::PER_DRAW_PUSH_CONSTANTS;
+                } else if (mode == "descriptor") {
+                    drawDataMode = Plaster::DrawDataMode::PER_DRAW_DESCRIPTOR_SETS;
+                } else {
+                    drawDataMode = Plaster::DrawDataMode::INSTANCED;
+                }
+            } else if (arg == "--object-grid" && i + 1 < argc) {
+                objectGrid = static_cast<uint32_t>(std::stoul(argv[++i]));
+            } else if (arg == "--geometry-vertices" && i + 1 < argc) {
+                geometryVertices = static_cast<uint32_t>(std::stoul(argv[++i]));
+            } else if (arg == "--geometry-indices" && i + 1 < argc) {
+                geometryIndices = static_cast<uint32_t>(std::stoul(argv[++i]));
+            } else if (arg == "--shader-cache" && i + 1 < argc) {
+                shaderCacheDirectory = argv[++i];
+            } else if (arg == "--clear-shader-cache") {
+                clearShaderCache = true;
+            } else if (arg == "--plastiboo-post") {
+                plastibooPost = true;
+            } else if (arg == "--post-effect" && i + 1 < argc) {
+                std::string effect = argv[++i];
+                size_t split = effect.rfind('@');
+                if (split != std::string::npos) {
+                    postEffects.emplace_back(effect.substr(0, split), std::stof(effect.substr(split + 1)));
+                } else {
+                    postEffects.emplace_back(effect, 1.0f);
+                }
+            }
+        }
+
+        // GPU culling draws indirectly and never splits draws per object
+        if (drawDataMode != Plaster::DrawDataMode::INSTANCED) {
+            cpuCulling = true;
+        }
+
+        // Create window (not needed offscreen)
+        std::unique_ptr<Window> window;
+        if (!headless) {
+            window = std::make_unique<Window>(static_cast<int>(width), static_cast<int>(height), "Plaster Engine - Plastiboo Demo");
+        }
 
         // Create Vulkan renderer
         VulkanRenderer renderer;
-        renderer.initialize(window);
+        renderer.setRecordingThreadCount(recordThreads);
+        renderer.setInternalResolution(internalWidth, internalHeight);
+        renderer.setInternalResolutionScale(internalScale);
+        renderer.setDepthPrepassEnabled(depthPrepass);
+        renderer.setStagingBufferSize(static_cast<VkDeviceSize>(stagingMegabytes) * 1024 * 1024);
+        renderer.setGpuCullingEnabled(!cpuCulling);
+        renderer.setLodSelection(lodSelection);
+        renderer.setBindlessEnabled(bindless);
+        renderer.setDrawDataMode(drawDataMode);
+        renderer.setGeometryPoolCapacity(geometryVertices, geometryIndices);
+        renderer.setShaderCacheDirectory(shaderCacheDirectory);
+        renderer.setClearShaderCache(clearShaderCache);
+        if (plastibooPost) {
+            Plaster::PostEffectInputs depthAndNoise;
+            depthAndNoise.depth = true;
+            depthAndNoise.noise = true;
+            Plaster::PostEffectInputs depthOnly;
+            depthOnly.depth = true;
+            renderer.addPostEffect("src/shaders/plastiboo_postprocess.frag", 1.0f, depthAndNoise);
+            renderer.addPostEffect("src/shaders/spatiotemporal_dither.frag", 1.0f, depthOnly);
+        }
+        for (const auto& effect : postEffects) {
+            renderer.addPostEffect(effect.first, effect.second);
+        }
+        if (headless) {
+            renderer.initializeHeadless(width, height);
+        } else {
+            renderer.initialize(*window);
+        }
 
         std::cout << "Vulkan initialized successfully!" << std::endl;
 
@@ -32,53 +177,60 @@ int main() {
 
         // Create cube mesh
         Plaster::MeshPrimitives::createCube(vertices, indices, 1.0f, glm::vec3(0.8f, 0.7f, 0.6f));
-        cubeMesh->create(renderer.getAllocator(), renderer.getDevice(),
-                        renderer.getCommandPool(), renderer.getGraphicsQueue(),
+        cubeMesh->create(renderer.getGeometryPool(), renderer.getUploadManager(),
                         vertices, indices);
 
-        // Create sphere mesh
+        // Create sphere and ground plane with the packed vertex layout
+        const Plaster::VertexFormat packed = Plaster::VertexFormat::PACKED;
         vertices.clear();
         indices.clear();
         Plaster::MeshPrimitives::createSphere(vertices, indices, 0.8f, 16, 16, glm::vec3(0.9f, 0.8f, 0.75f));
-        sphereMesh->create(renderer.getAllocator(), renderer.getDevice(),
-                          renderer.getCommandPool(), renderer.getGraphicsQueue(),
-                          vertices, indices);
+        sphereMesh->create(renderer.getGeometryPool(packed), renderer.getUploadManager(),
+                          vertices, indices, Plaster::MeshLodSettings(), Plaster::MeshOptimizeSettings(), packed);
 
-        // Create ground plane
         vertices.clear();
         indices.clear();
         Plaster::MeshPrimitives::createPlane(vertices, indices, 15.0f, 15.0f, 10, 10, glm::vec3(0.4f, 0.38f, 0.35f));
-        planeMesh->create(renderer.getAllocator(), renderer.getDevice(),
-                         renderer.getCommandPool(), renderer.getGraphicsQueue(),
-                         vertices, indices);
+        planeMesh->create(renderer.getGeometryPool(packed), renderer.getUploadManager(),
+                         vertices, indices, Plaster::MeshLodSettings(), Plaster::MeshOptimizeSettings(), packed);
 
         // Create materials with different Plastiboo presets
         auto medievalMat = std::make_shared<Plaster::PlastibooMaterial>();
-        medievalMat->create(renderer.getAllocator());
-        medievalMat->updateData(renderer.getAllocator(),
-                               Plaster::PlastibooMaterial::createMedievalDungeonPreset());
+        medievalMat->create(renderer.getMaterialRegistry());
+        medievalMat->updateData(Plaster::PlastibooMaterial::createMedievalDungeonPreset());
 
         auto bloodMat = std::make_shared<Plaster::PlastibooMaterial>();
-        bloodMat->create(renderer.getAllocator());
-        bloodMat->updateData(renderer.getAllocator(),
-                            Plaster::PlastibooMaterial::createBloodRitualPreset());
+        bloodMat->create(renderer.getMaterialRegistry());
+        bloodMat->updateData(Plaster::PlastibooMaterial::createBloodRitualPreset());
 
         auto plagueMat = std::make_shared<Plaster::PlastibooMaterial>();
-        plagueMat->create(renderer.getAllocator());
-        plagueMat->updateData(renderer.getAllocator(),
-                             Plaster::PlastibooMaterial::createPlagueVillagePreset());
+        plagueMat->create(renderer.getMaterialRegistry());
+        plagueMat->updateData(Plaster::PlastibooMaterial::createPlagueVillagePreset());
 
         auto forestMat = std::make_shared<Plaster::PlastibooMaterial>();
-        forestMat->create(renderer.getAllocator());
-        forestMat->updateData(renderer.getAllocator(),
-                             Plaster::PlastibooMaterial::createAncientForestPreset());
+        forestMat->create(renderer.getMaterialRegistry());
+        forestMat->updateData(Plaster::PlastibooMaterial::createAncientForestPreset());
 
-        // Add objects to scene
+        // Add objects to scene; the spatial index is built once at the end
+        scene.beginBulkAdd();
         scene.addObject(cubeMesh, medievalMat, glm::vec3(-2.5f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 0.0f));
         scene.addObject(sphereMesh, bloodMat, glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 0.0f));
         scene.addObject(cubeMesh, plagueMat, glm::vec3(2.5f, 1.0f, 0.0f), glm::vec3(0.0f, 45.0f, 0.0f));
         scene.addObject(planeMesh, forestMat, glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 0.0f));
 
+        // Small cubes spread over the ground, alternating materials so the
+        // per-material state changes too
+        for (uint32_t z = 0; z < objectGrid; z++) {
+            for (uint32_t x = 0; x < objectGrid; x++) {
+                float spacing = 12.0f / static_cast<float>(objectGrid);
+                glm::vec3 position(-6.0f + (x + 0.5f) * spacing, 0.1f, -6.0f + (z + 0.5f) * spacing);
+                auto& material = (x + z) % 2 == 0 ? medievalMat : plagueMat;
+                scene.addObject(cubeMesh, material, position, glm::vec3(0.0f, 0.0f, 0.0f),
+                                glm::vec3(spacing * 0.4f));
+            }
+        }
+        scene.endBulkAdd();
+
         // Position camera for a good view
         scene.getCamera().setPosition(glm::vec3(0.0f, 3.5f, 8.0f));
         scene.getCamera().lookAt(glm::vec3(0.0f, 1.0f, 0.0f));
@@ -89,12 +241,18 @@ int main() {
         std::cout << "  - Blood Ritual (sphere)" << std::endl;
         std::cout << "  - Plague Village (right cube)" << std::endl;
         std::cout << "  - Ancient Forest (ground)" << std::endl;
-        std::cout << "Close the window to exit." << std::endl;
+        if (!headless) {
+            std::cout << "Close the window to exit." << std::endl;
+        }
 
         // Main loop
         float time = 0.0f;
-        while (!window.shouldClose()) {
-            window.pollEvents();
+        uint32_t frame = 0;
+        auto runStart = std::chrono::high_resolution_clock::now();
+        while (headless ? frame < frameCount : !window->shouldClose()) {
+            if (window) {
+                window->pollEvents();
+            }
 
             // Simple animation: rotate objects
             time += 0.016f; // ~60 FPS
@@ -102,23 +260,46 @@ int main() {
             if (objects.size() >= 3) {
                 objects[0].rotation.y = time * 20.0f;  // Left cube
                 objects[2].rotation.y = time * -15.0f; // Right cube
+                scene.updateObjectBounds(0);
+                scene.updateObjectBounds(2);
             }
 
             // Render the scene
             renderer.renderScene(scene);
             renderer.drawFrame();
+            frame++;
+        }
+
+        if (headless) {
+            vkDeviceWaitIdle(renderer.getDevice());
+            auto runEnd = std::chrono::high_resolution_clock::now();
+            double totalMs = std::chrono::duration<double, std::milli>(runEnd - runStart).count();
+            std::cout << "Rendered " << frame << " frames in " << totalMs << " ms ("
+                      << (frame > 0 ? totalMs / frame : 0.0) << " ms/frame)" << std::endl;
+
+            const Plaster::RenderStats& stats = renderer.getStats();
+            std::cout << "Fragment invocations: " << stats.fragmentInvocations
+                      << " (overdraw " << stats.overdraw << "x"
+                      << (depthPrepass ? ", depth pre-pass" : "") << ")" << std::endl;
+            std::cout << "Last frame: " << stats.drawCalls << " draws, "
+                      << stats.descriptorSetBinds << " descriptor set binds, "
+                      << stats.recordMs << " ms recording" << std::endl;
+
+            if (!outputPath.empty() && frame > 0) {
+                renderer.saveFrame(outputPath);
+            }
         }
 
         // Cleanup materials
-        medievalMat->destroy(renderer.getAllocator());
-        bloodMat->destroy(renderer.getAllocator());
-        plagueMat->destroy(renderer.getAllocator());
-        forestMat->destroy(renderer.getAllocator());
+        medievalMat->destroy();
+        bloodMat->destroy();
+        plagueMat->destroy();
+        forestMat->destroy();
 
         // Cleanup meshes
-        cubeMesh->destroy(renderer.getAllocator());
-        sphereMesh->destroy(renderer.getAllocator());
-        planeMesh->destroy(renderer.getAllocator());
+        cubeMesh->destroy(renderer.getGeometryPool());
+        sphereMesh->destroy(renderer.getGeometryPool(packed));
+        planeMesh->destroy(renderer.getGeometryPool(packed));
 
         std::cout << "Shutting down gracefully..." << std::endl;
 
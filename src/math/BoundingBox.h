@@ -0,0 +1,65 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <limits>
+
+namespace Plaster {
+
+// Axis-aligned bounding box. Default constructed boxes are empty (min > max)
+// so the first expand() snaps them to a point.
+struct BoundingBox {
+    glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+    glm::vec3 max = glm::vec3(std::numeric_limits<float>::lowest());
+
+    BoundingBox() = default;
+    BoundingBox(const glm::vec3& minPoint, const glm::vec3& maxPoint) : min(minPoint), max(maxPoint) {}
+
+    bool isValid() const { return min.x <= max.x && min.y <= max.y && min.z <= max.z; }
+
+    void expand(const glm::vec3& point) {
+        min = glm::min(min, point);
+        max = glm::max(max, point);
+    }
+
+    void expand(const BoundingBox& other) {
+        min = glm::min(min, other.min);
+        max = glm::max(max, other.max);
+    }
+
+    glm::vec3 getCenter() const { return (min + max) * 0.5f; }
+
+    // Surface area, the cost metric for BVH construction
+    float getSurfaceArea() const {
+        glm::vec3 size = max - min;
+        return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+    }
+
+    bool contains(const BoundingBox& other) const {
+        return glm::all(glm::lessThanEqual(min, other.min)) && glm::all(glm::greaterThanEqual(max, other.max));
+    }
+
+    bool overlaps(const BoundingBox& other) const {
+        return glm::all(glm::lessThanEqual(min, other.max)) && glm::all(glm::greaterThanEqual(max, other.min));
+    }
+
+    static BoundingBox merge(const BoundingBox& a, const BoundingBox& b) {
+        return BoundingBox(glm::min(a.min, b.min), glm::max(a.max, b.max));
+    }
+
+    // Half the size along each axis
+    glm::vec3 getExtents() const { return (max - min) * 0.5f; }
+
+    // Box around this one after an affine transform: the centre is transformed
+    // and the extents are projected through the absolute 3x3 part (Arvo)
+    BoundingBox transformed(const glm::mat4& transform) const {
+        glm::vec3 center = glm::vec3(transform * glm::vec4(getCenter(), 1.0f));
+        glm::vec3 extents = getExtents();
+        glm::vec3 newExtents =
+            glm::abs(glm::vec3(transform[0])) * extents.x +
+            glm::abs(glm::vec3(transform[1])) * extents.y +
+            glm::abs(glm::vec3(transform[2])) * extents.z;
+        return BoundingBox(center - newExtents, center + newExtents);
+    }
+};
+
+}
@@ -0,0 +1,187 @@
+#include "Frustum.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define PLASTER_CULL_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <xmmintrin.h>
+#define PLASTER_CULL_SSE 1
+#endif
+
+namespace Plaster {
+
+void Frustum::update(const glm::mat4& viewProjection) {
+    // Gribb/Hartmann: each plane is the w row plus or minus one of the others.
+    // glm is column major, so row i is (m[0][i], m[1][i], m[2][i], m[3][i]).
+    glm::mat4 m = glm::transpose(viewProjection);
+    m_planes[Left] = m[3] + m[0];
+    m_planes[Right] = m[3] - m[0];
+    m_planes[Bottom] = m[3] + m[1];
+    m_planes[Top] = m[3] - m[1];
+    m_planes[Near] = m[3] + m[2];
+    m_planes[Far] = m[3] - m[2];
+
+    for (glm::vec4& plane : m_planes) {
+        plane /= glm::length(glm::vec3(plane));
+    }
+}
+
+bool Frustum::intersects(const BoundingBox& box) const {
+    glm::vec3 center = box.getCenter();
+    glm::vec3 extents = box.getExtents();
+    for (const glm::vec4& plane : m_planes) {
+        // Distance of the box's most positive corner along the plane normal
+        float reach = glm::dot(glm::abs(glm::vec3(plane)), extents);
+        if (glm::dot(glm::vec3(plane), center) + plane.w + reach < 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Frustum::intersects(const BoundingBox& box, uint32_t& planeMask) const {
+    glm::vec3 center = box.getCenter();
+    glm::vec3 extents = box.getExtents();
+    for (int p = 0; p < PlaneCount; p++) {
+        if (!(planeMask & (1u << p))) continue;
+
+        const glm::vec4& plane = m_planes[p];
+        float distance = glm::dot(glm::vec3(plane), center) + plane.w;
+        float reach = glm::dot(glm::abs(glm::vec3(plane)), extents);
+        if (distance + reach < 0.0f) {
+            return false;
+        }
+        if (distance - reach >= 0.0f) {
+            planeMask &= ~(1u << p);
+        }
+    }
+    return true;
+}
+
+bool Frustum::intersects(const glm::vec3& center, float radius) const {
+    for (const glm::vec4& plane : m_planes) {
+        if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void BoundsSoA::clear() {
+    centerX.clear();
+    centerY.clear();
+    centerZ.clear();
+    extentX.clear();
+    extentY.clear();
+    extentZ.clear();
+}
+
+void BoundsSoA::reserve(size_t count) {
+    centerX.reserve(count);
+    centerY.reserve(count);
+    centerZ.reserve(count);
+    extentX.reserve(count);
+    extentY.reserve(count);
+    extentZ.reserve(count);
+}
+
+void BoundsSoA::push(const BoundingBox& box) {
+    glm::vec3 center = box.getCenter();
+    glm::vec3 extents = box.getExtents();
+    centerX.push_back(center.x);
+    centerY.push_back(center.y);
+    centerZ.push_back(center.z);
+    extentX.push_back(extents.x);
+    extentY.push_back(extents.y);
+    extentZ.push_back(extents.z);
+}
+
+uint32_t cullBoxes(const Frustum& frustum, const BoundsSoA& bounds, std::vector<uint8_t>& visible) {
+    const size_t count = bounds.size();
+    visible.resize(count);
+
+    glm::vec4 planes[Frustum::PlaneCount];
+    glm::vec3 absNormals[Frustum::PlaneCount];
+    for (int p = 0; p < Frustum::PlaneCount; p++) {
+        planes[p] = frustum.getPlane(static_cast<Frustum::Plane>(p));
+        absNormals[p] = glm::abs(glm::vec3(planes[p]));
+    }
+
+    uint32_t visibleCount = 0;
+    size_t i = 0;
+
+#if defined(PLASTER_CULL_AVX)
+    for (; i + 8 <= count; i += 8) {
+        __m256 cx = _mm256_loadu_ps(&bounds.centerX[i]);
+        __m256 cy = _mm256_loadu_ps(&bounds.centerY[i]);
+        __m256 cz = _mm256_loadu_ps(&bounds.centerZ[i]);
+        __m256 ex = _mm256_loadu_ps(&bounds.extentX[i]);
+        __m256 ey = _mm256_loadu_ps(&bounds.extentY[i]);
+        __m256 ez = _mm256_loadu_ps(&bounds.extentZ[i]);
+
+        __m256 outside = _mm256_setzero_ps();
+        for (int p = 0; p < Frustum::PlaneCount; p++) {
+            __m256 d = _mm256_set1_ps(planes[p].w);
+            d = _mm256_add_ps(d, _mm256_mul_ps(cx, _mm256_set1_ps(planes[p].x)));
+            d = _mm256_add_ps(d, _mm256_mul_ps(cy, _mm256_set1_ps(planes[p].y)));
+            d = _mm256_add_ps(d, _mm256_mul_ps(cz, _mm256_set1_ps(planes[p].z)));
+            d = _mm256_add_ps(d, _mm256_mul_ps(ex, _mm256_set1_ps(absNormals[p].x)));
+            d = _mm256_add_ps(d, _mm256_mul_ps(ey, _mm256_set1_ps(absNormals[p].y)));
+            d = _mm256_add_ps(d, _mm256_mul_ps(ez, _mm256_set1_ps(absNormals[p].z)));
+            outside = _mm256_or_ps(outside, _mm256_cmp_ps(d, _mm256_setzero_ps(), _CMP_LT_OQ));
+        }
+
+        int mask = _mm256_movemask_ps(outside);
+        for (int k = 0; k < 8; k++) {
+            uint8_t inside = (mask & (1 << k)) ? 0 : 1;
+            visible[i + k] = inside;
+            visibleCount += inside;
+        }
+    }
+#elif defined(PLASTER_CULL_SSE)
+    for (; i + 4 <= count; i += 4) {
+        __m128 cx = _mm_loadu_ps(&bounds.centerX[i]);
+        __m128 cy = _mm_loadu_ps(&bounds.centerY[i]);
+        __m128 cz = _mm_loadu_ps(&bounds.centerZ[i]);
+        __m128 ex = _mm_loadu_ps(&bounds.extentX[i]);
+        __m128 ey = _mm_loadu_ps(&bounds.extentY[i]);
+        __m128 ez = _mm_loadu_ps(&bounds.extentZ[i]);
+
+        __m128 outside = _mm_setzero_ps();
+        for (int p = 0; p < Frustum::PlaneCount; p++) {
+            __m128 d = _mm_set1_ps(planes[p].w);
+            d = _mm_add_ps(d, _mm_mul_ps(cx, _mm_set1_ps(planes[p].x)));
+            d = _mm_add_ps(d, _mm_mul_ps(cy, _mm_set1_ps(planes[p].y)));
+            d = _mm_add_ps(d, _mm_mul_ps(cz, _mm_set1_ps(planes[p].z)));
+            d = _mm_add_ps(d, _mm_mul_ps(ex, _mm_set1_ps(absNormals[p].x)));
+            d = _mm_add_ps(d, _mm_mul_ps(ey, _mm_set1_ps(absNormals[p].y)));
+            d = _mm_add_ps(d, _mm_mul_ps(ez, _mm_set1_ps(absNormals[p].z)));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(d, _mm_setzero_ps()));
+        }
+
+        int mask = _mm_movemask_ps(outside);
+        for (int k = 0; k < 4; k++) {
+            uint8_t inside = (mask & (1 << k)) ? 0 : 1;
+            visible[i + k] = inside;
+            visibleCount += inside;
+        }
+    }
+#endif
+
+    // Scalar tail, and the whole range on builds without SSE
+    for (; i < count; i++) {
+        bool inside = true;
+        for (int p = 0; p < Frustum::PlaneCount && inside; p++) {
+            float d = planes[p].w +
+                      planes[p].x * bounds.centerX[i] + planes[p].y * bounds.centerY[i] + planes[p].z * bounds.centerZ[i] +
+                      absNormals[p].x * bounds.extentX[i] + absNormals[p].y * bounds.extentY[i] + absNormals[p].z * bounds.extentZ[i];
+            inside = d >= 0.0f;
+        }
+        visible[i] = inside ? 1 : 0;
+        visibleCount += inside ? 1 : 0;
+    }
+
+    return visibleCount;
+}
+
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "BoundingBox.h"
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Plaster {
+
+// Six normalised planes (xyz inward normal, w distance) extracted from a
+// view-projection matrix, e.g. Camera::getProjectionMatrix() * getViewMatrix()
+class Frustum {
+public:
+    enum Plane { Left, Right, Bottom, Top, Near, Far, PlaneCount };
+    static const uint32_t ALL_PLANES = (1u << PlaneCount) - 1;
+
+    Frustum() = default;
+    explicit Frustum(const glm::mat4& viewProjection) { update(viewProjection); }
+
+    void update(const glm::mat4& viewProjection);
+
+    bool intersects(const BoundingBox& box) const;
+
+    // Hierarchical variant: only tests planes whose bit is set in planeMask
+    // and clears the bits of planes the box lies entirely inside, so children
+    // of a box can skip them
+    bool intersects(const BoundingBox& box, uint32_t& planeMask) const;
+    bool intersects(const glm::vec3& center, float radius) const;
+
+    const glm::vec4& getPlane(Plane plane) const { return m_planes[plane]; }
+
+private:
+    glm::vec4 m_planes[PlaneCount];
+};
+
+// Boxes stored as separate centre and half-extent arrays so the batch cull
+// can load several boxes' x (then y, then z) into one SIMD register
+struct BoundsSoA {
+    std::vector<float> centerX, centerY, centerZ;
+    std::vector<float> extentX, extentY, extentZ;
+
+    void clear();
+    void reserve(size_t count);
+    void push(const BoundingBox& box);
+    size_t size() const { return centerX.size(); }
+};
+
+// Test every box against the frustum, 8 at a time with AVX or 4 with SSE when
+// the build enables them. visible[i] is set to 1 for boxes that touch the
+// frustum and 0 otherwise; returns the number visible.
+uint32_t cullBoxes(const Frustum& frustum, const BoundsSoA& bounds, std::vector<uint8_t>& visible);
+
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "BoundingBox.h"
+#include <glm/glm.hpp>
+#include <algorithm>
+
+namespace Plaster {
+
+// Half-line from origin along direction. Distances are in units of the
+// direction's length, so pass a normalised direction to get world distances.
+struct Ray {
+    glm::vec3 origin = glm::vec3(0.0f);
+    glm::vec3 direction = glm::vec3(0.0f, 0.0f, -1.0f);
+
+    Ray() = default;
+    Ray(const glm::vec3& rayOrigin, const glm::vec3& rayDirection) : origin(rayOrigin), direction(rayDirection) {}
+
+    glm::vec3 at(float distance) const { return origin + direction * distance; }
+
+    // Slab test. On a hit within [0, maxDistance], distance is where the ray
+    // enters the box (0 when the origin is inside).
+    bool intersects(const BoundingBox& box, float maxDistance, float& distance) const {
+        glm::vec3 inverse = 1.0f / direction;
+        glm::vec3 t0 = (box.min - origin) * inverse;
+        glm::vec3 t1 = (box.max - origin) * inverse;
+        glm::vec3 tNear = glm::min(t0, t1);
+        glm::vec3 tFar = glm::max(t0, t1);
+
+        float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+        float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, maxDistance));
+        if (enter > exit) {
+            return false;
+        }
+        distance = enter;
+        return true;
+    }
+};
+
+}
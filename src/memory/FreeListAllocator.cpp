@@ -0,0 +1,92 @@
+#include "FreeListAllocator.h"
+#include <algorithm>
+#include <iterator>
+
+namespace Plaster {
+
+FreeListAllocator::FreeListAllocator()
+    : m_capacity(0)
+    , m_used(0)
+{
+}
+
+FreeListAllocator::FreeListAllocator(uint64_t capacity)
+    : FreeListAllocator()
+{
+    reset(capacity);
+}
+
+void FreeListAllocator::reset(uint64_t capacity) {
+    m_freeBlocks.clear();
+    m_capacity = capacity;
+    m_used = 0;
+    if (capacity > 0) {
+        m_freeBlocks[0] = capacity;
+    }
+}
+
+uint64_t FreeListAllocator::allocate(uint64_t size, uint64_t alignment) {
+    if (size == 0) {
+        return INVALID_OFFSET;
+    }
+
+    for (auto it = m_freeBlocks.begin(); it != m_freeBlocks.end(); ++it) {
+        const uint64_t blockOffset = it->first;
+        const uint64_t blockSize = it->second;
+        const uint64_t offset = (blockOffset + alignment - 1) / alignment * alignment;
+        const uint64_t padding = offset - blockOffset;
+        if (padding + size > blockSize) {
+            continue;
+        }
+
+        // Split the block: alignment padding stays free in front, the tail stays free behind
+        m_freeBlocks.erase(it);
+        if (padding > 0) {
+            m_freeBlocks[blockOffset] = padding;
+        }
+        const uint64_t tail = blockSize - padding - size;
+        if (tail > 0) {
+            m_freeBlocks[offset + size] = tail;
+        }
+
+        m_used += size;
+        return offset;
+    }
+
+    return INVALID_OFFSET;
+}
+
+void FreeListAllocator::free(uint64_t offset, uint64_t size) {
+    if (size == 0 || offset == INVALID_OFFSET) {
+        return;
+    }
+
+    m_used -= std::min(size, m_used);
+    auto it = m_freeBlocks.emplace(offset, size).first;
+
+    // Merge with the following block
+    auto next = std::next(it);
+    if (next != m_freeBlocks.end() && it->first + it->second == next->first) {
+        it->second += next->second;
+        m_freeBlocks.erase(next);
+    }
+
+    // Merge with the preceding block
+    if (it != m_freeBlocks.begin()) {
+        auto prev = std::prev(it);
+        if (prev->first + prev->second == it->first) {
+            prev->second += it->second;
+            m_freeBlocks.erase(it);
+        }
+    }
+}
+
+uint64_t FreeListAllocator::getLargestFreeBlock() const {
+    uint64_t largest = 0;
+    for (const auto& block : m_freeBlocks) {
+        largest = std::max(largest, block.second);
+    }
+    return largest;
+}
+
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+
+namespace Plaster {
+
+// Offset allocator over an abstract range [0, capacity). It hands out
+// offsets only and never touches memory, so it can manage GPU buffers.
+// Free blocks are kept ordered by offset; allocation is first fit and
+// freeing coalesces with both neighbours.
+class FreeListAllocator {
+public:
+    static const uint64_t INVALID_OFFSET = UINT64_MAX;
+
+    FreeListAllocator();
+    explicit FreeListAllocator(uint64_t capacity);
+
+    // Drop every allocation and manage [0, capacity)
+    void reset(uint64_t capacity);
+
+    // Returns INVALID_OFFSET when no free block is large enough
+    uint64_t allocate(uint64_t size, uint64_t alignment = 1);
+
+    // size must match the original allocation
+    void free(uint64_t offset, uint64_t size);
+
+    uint64_t getCapacity() const { return m_capacity; }
+    uint64_t getUsed() const { return m_used; }
+    uint64_t getLargestFreeBlock() const;
+    size_t getFreeBlockCount() const { return m_freeBlocks.size(); }
+
+private:
+    std::map<uint64_t, uint64_t> m_freeBlocks;  // offset -> size
+    uint64_t m_capacity;
+    uint64_t m_used;
+};
+
+}
@@ -0,0 +1,275 @@
+#include "DescriptorAllocator.h"
+#include <array>
+#include <cstring>
+#include <iostream>
+
+namespace Plaster {
+
+namespace {
+
+// Descriptors per set each pool is sized for, by type
+constexpr std::array<std::pair<VkDescriptorType, uint32_t>, 4> POOL_RATIOS = {{
+    {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2},
+    {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2},
+    {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4},
+    {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1}
+}};
+
+// Handles are pointers or 64-bit integers depending on the platform
+template<typename Handle>
+uint64_t handleBits(Handle handle) {
+    uint64_t bits = 0;
+    std::memcpy(&bits, &handle, sizeof(handle));
+    return bits;
+}
+
+void hashCombine(size_t& seed, uint64_t value) {
+    seed ^= std::hash<uint64_t>()(value) + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2);
+}
+
+}
+
+DescriptorBinding DescriptorBinding::forBuffer(uint32_t binding, VkDescriptorType type, VkBuffer buffer,
+                                               VkDeviceSize offset, VkDeviceSize range) {
+    DescriptorBinding result;
+    result.binding = binding;
+    result.type = type;
+    result.buffer = buffer;
+    result.offset = offset;
+    result.range = range;
+    return result;
+}
+
+DescriptorBinding DescriptorBinding::forImage(uint32_t binding, VkDescriptorType type, VkImageView imageView,
+                                              VkSampler sampler, VkImageLayout imageLayout) {
+    DescriptorBinding result;
+    result.binding = binding;
+    result.type = type;
+    result.imageView = imageView;
+    result.sampler = sampler;
+    result.imageLayout = imageLayout;
+    return result;
+}
+
+bool DescriptorBinding::operator==(const DescriptorBinding& other) const {
+    return binding == other.binding && type == other.type &&
+           buffer == other.buffer && offset == other.offset && range == other.range &&
+           imageView == other.imageView && sampler == other.sampler && imageLayout == other.imageLayout;
+}
+
+void writeDescriptorSet(VkDevice device, VkDescriptorSet set, const std::vector<DescriptorBinding>& bindings) {
+    std::vector<VkDescriptorBufferInfo> bufferInfos(bindings.size());
+    std::vector<VkDescriptorImageInfo> imageInfos(bindings.size());
+    std::vector<VkWriteDescriptorSet> writes(bindings.size());
+
+    for (size_t i = 0; i < bindings.size(); i++) {
+        const DescriptorBinding& binding = bindings[i];
+
+        writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[i].dstSet = set;
+        writes[i].dstBinding = binding.binding;
+        writes[i].dstArrayElement = 0;
+        writes[i].descriptorType = binding.type;
+        writes[i].descriptorCount = 1;
+
+        if (binding.buffer != VK_NULL_HANDLE) {
+            bufferInfos[i].buffer = binding.buffer;
+            bufferInfos[i].offset = binding.offset;
+            bufferInfos[i].range = binding.range;
+            writes[i].pBufferInfo = &bufferInfos[i];
+        } else {
+            imageInfos[i].imageView = binding.imageView;
+            imageInfos[i].sampler = binding.sampler;
+            imageInfos[i].imageLayout = binding.imageLayout;
+            writes[i].pImageInfo = &imageInfos[i];
+        }
+    }
+
+    vkUpdateDescriptorSets(device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+}
+
+DescriptorPoolChain::DescriptorPoolChain()
+    : m_current(0)
+    , m_setsPerPool(0)
+{
+}
+
+DescriptorPoolChain::~DescriptorPoolChain() {
+}
+
+void DescriptorPoolChain::create(uint32_t setsPerPool) {
+    m_setsPerPool = setsPerPool;
+    m_current = 0;
+}
+
+void DescriptorPoolChain::destroy(VkDevice device) {
+    for (VkDescriptorPool pool : m_pools) {
+        vkDestroyDescriptorPool(device, pool, nullptr);
+    }
+    m_pools.clear();
+    m_current = 0;
+}
+
+VkDescriptorPool DescriptorPoolChain::createPool(VkDevice device) {
+    std::array<VkDescriptorPoolSize, POOL_RATIOS.size()> poolSizes{};
+    for (size_t i = 0; i < POOL_RATIOS.size(); i++) {
+        poolSizes[i].type = POOL_RATIOS[i].first;
+        poolSizes[i].descriptorCount = POOL_RATIOS[i].second * m_setsPerPool;
+    }
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    poolInfo.pPoolSizes = poolSizes.data();
+    poolInfo.maxSets = m_setsPerPool;
+
+    VkDescriptorPool pool = VK_NULL_HANDLE;
+    if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &pool) != VK_SUCCESS) {
+        std::cerr << "Failed to create descriptor pool!" << std::endl;
+        return VK_NULL_HANDLE;
+    }
+    return pool;
+}
+
+VkDescriptorSet DescriptorPoolChain::allocate(VkDevice device, VkDescriptorSetLayout layout) {
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &layout;
+
+    while (true) {
+        bool freshPool = false;
+        if (m_current == m_pools.size()) {
+            VkDescriptorPool pool = createPool(device);
+            if (pool == VK_NULL_HANDLE) {
+                return VK_NULL_HANDLE;
+            }
+            m_pools.push_back(pool);
+            freshPool = true;
+        }
+
+        allocInfo.descriptorPool = m_pools[m_current];
+        VkDescriptorSet set = VK_NULL_HANDLE;
+        if (vkAllocateDescriptorSets(device, &allocInfo, &set) == VK_SUCCESS) {
+            return set;
+        }
+
+        // 1.0 drivers may report exhaustion as any allocation error, so treat
+        // every failure as a full pool unless the pool was empty to begin with
+        if (freshPool) {
+            std::cerr << "Failed to allocate descriptor set from an empty pool!" << std::endl;
+            return VK_NULL_HANDLE;
+        }
+        m_current++;
+    }
+}
+
+void DescriptorPoolChain::reset(VkDevice device) {
+    for (size_t i = 0; i < m_pools.size() && i <= m_current; i++) {
+        vkResetDescriptorPool(device, m_pools[i], 0);
+    }
+    m_current = 0;
+}
+
+DescriptorArena::DescriptorArena()
+    : m_frameIndex(0)
+    , m_allocatedCount(0)
+{
+}
+
+DescriptorArena::~DescriptorArena() {
+}
+
+void DescriptorArena::create(uint32_t frameCount, uint32_t setsPerPool) {
+    m_frames.resize(frameCount);
+    for (DescriptorPoolChain& chain : m_frames) {
+        chain.create(setsPerPool);
+    }
+    m_frameIndex = 0;
+    m_allocatedCount = 0;
+}
+
+void DescriptorArena::destroy(VkDevice device) {
+    for (DescriptorPoolChain& chain : m_frames) {
+        chain.destroy(device);
+    }
+    m_frames.clear();
+}
+
+void DescriptorArena::beginFrame(VkDevice device, uint32_t frameIndex) {
+    m_frameIndex = frameIndex;
+    m_frames[frameIndex].reset(device);
+    m_allocatedCount = 0;
+}
+
+VkDescriptorSet DescriptorArena::allocate(VkDevice device, VkDescriptorSetLayout layout) {
+    VkDescriptorSet set = m_frames[m_frameIndex].allocate(device, layout);
+    if (set != VK_NULL_HANDLE) {
+        m_allocatedCount++;
+    }
+    return set;
+}
+
+VkDescriptorSet DescriptorArena::allocate(VkDevice device, VkDescriptorSetLayout layout,
+                                          const std::vector<DescriptorBinding>& bindings) {
+    VkDescriptorSet set = allocate(device, layout);
+    if (set != VK_NULL_HANDLE) {
+        writeDescriptorSet(device, set, bindings);
+    }
+    return set;
+}
+
+size_t DescriptorSetCache::KeyHash::operator()(const Key& key) const {
+    size_t seed = 0;
+    hashCombine(seed, handleBits(key.layout));
+    for (const DescriptorBinding& binding : key.bindings) {
+        hashCombine(seed, (static_cast<uint64_t>(binding.binding) << 32) | static_cast<uint32_t>(binding.type));
+        hashCombine(seed, handleBits(binding.buffer));
+        hashCombine(seed, binding.offset);
+        hashCombine(seed, binding.range);
+        hashCombine(seed, handleBits(binding.imageView));
+        hashCombine(seed, handleBits(binding.sampler));
+        hashCombine(seed, static_cast<uint64_t>(binding.imageLayout));
+    }
+    return seed;
+}
+
+DescriptorSetCache::DescriptorSetCache() {
+}
+
+DescriptorSetCache::~DescriptorSetCache() {
+}
+
+void DescriptorSetCache::create(uint32_t setsPerPool) {
+    m_pools.create(setsPerPool);
+}
+
+void DescriptorSetCache::destroy(VkDevice device) {
+    m_pools.destroy(device);
+    m_sets.clear();
+}
+
+VkDescriptorSet DescriptorSetCache::get(VkDevice device, VkDescriptorSetLayout layout,
+                                        const std::vector<DescriptorBinding>& bindings) {
+    Key key{layout, bindings};
+    auto it = m_sets.find(key);
+    if (it != m_sets.end()) {
+        return it->second;
+    }
+
+    VkDescriptorSet set = m_pools.allocate(device, layout);
+    if (set == VK_NULL_HANDLE) {
+        return VK_NULL_HANDLE;
+    }
+    writeDescriptorSet(device, set, bindings);
+
+    m_sets.emplace(std::move(key), set);
+    return set;
+}
+
+void DescriptorSetCache::clear(VkDevice device) {
+    m_pools.reset(device);
+    m_sets.clear();
+}
+
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace Plaster {
+
+// One resource bound to a set: enough to write the descriptor and to key the cache
+struct DescriptorBinding {
+    uint32_t binding = 0;
+    VkDescriptorType type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VkDeviceSize offset = 0;
+    VkDeviceSize range = VK_WHOLE_SIZE;
+    VkImageView imageView = VK_NULL_HANDLE;
+    VkSampler sampler = VK_NULL_HANDLE;
+    VkImageLayout imageLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    static DescriptorBinding forBuffer(uint32_t binding, VkDescriptorType type, VkBuffer buffer,
+                                       VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE);
+    static DescriptorBinding forImage(uint32_t binding, VkDescriptorType type, VkImageView imageView,
+                                      VkSampler sampler,
+                                      VkImageLayout imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+    bool operator==(const DescriptorBinding& other) const;
+};
+
+// Write every binding into set in one vkUpdateDescriptorSets call
+void writeDescriptorSet(VkDevice device, VkDescriptorSet set, const std::vector<DescriptorBinding>& bindings);
+
+// Descriptor pools allocated from front to back. When the current pool runs
+// out the next one is used, and a new one is chained on at the end when
+// there is none. Sets are never freed one at a time; reset() empties every
+// pool with one vkResetDescriptorPool each and keeps them for reuse.
+class DescriptorPoolChain {
+public:
+    DescriptorPoolChain();
+    ~DescriptorPoolChain();
+
+    void create(uint32_t setsPerPool);
+    void destroy(VkDevice device);
+
+    // VK_NULL_HANDLE when even a fresh pool cannot hold the layout
+    VkDescriptorSet allocate(VkDevice device, VkDescriptorSetLayout layout);
+
+    void reset(VkDevice device);
+
+    size_t getPoolCount() const { return m_pools.size(); }
+
+private:
+    std::vector<VkDescriptorPool> m_pools;
+    size_t m_current;
+    uint32_t m_setsPerPool;
+
+    VkDescriptorPool createPool(VkDevice device);
+};
+
+// Transient descriptor sets for dynamic content, one pool chain per frame in
+// flight. Sets are handed out linearly from the current frame's chain and
+// stay valid until that frame slot comes round again: beginFrame() resets the
+// slot's pools wholesale once its fence has signalled.
+class DescriptorArena {
+public:
+    static constexpr uint32_t DEFAULT_SETS_PER_POOL = 128;
+
+    DescriptorArena();
+    ~DescriptorArena();
+
+    void create(uint32_t frameCount, uint32_t setsPerPool = DEFAULT_SETS_PER_POOL);
+    void destroy(VkDevice device);
+
+    // The frame's fence must have signalled
+    void beginFrame(VkDevice device, uint32_t frameIndex);
+
+    VkDescriptorSet allocate(VkDevice device, VkDescriptorSetLayout layout);
+
+    // Allocate and write bindings in one go
+    VkDescriptorSet allocate(VkDevice device, VkDescriptorSetLayout layout,
+                             const std::vector<DescriptorBinding>& bindings);
+
+    uint32_t getAllocatedCount() const { return m_allocatedCount; }
+
+private:
+    std::vector<DescriptorPoolChain> m_frames;
+    uint32_t m_frameIndex;
+    uint32_t m_allocatedCount;  // Since the last beginFrame
+};
+
+// Long-lived sets keyed by layout and everything bound to them, so identical
+// requests share one set and nothing is written twice. Keys hold raw handles:
+// clear() the cache when a bound resource is destroyed, or a recycled handle
+// could return a stale set.
+class DescriptorSetCache {
+public:
+    static constexpr uint32_t DEFAULT_SETS_PER_POOL = 64;
+
+    DescriptorSetCache();
+    ~DescriptorSetCache();
+
+    void create(uint32_t setsPerPool = DEFAULT_SETS_PER_POOL);
+    void destroy(VkDevice device);
+
+    // The cached set for layout and bindings, allocated and written on a miss.
+    // VK_NULL_HANDLE if allocation failed.
+    VkDescriptorSet get(VkDevice device, VkDescriptorSetLayout layout,
+                        const std::vector<DescriptorBinding>& bindings);
+
+    void clear(VkDevice device);
+
+    size_t getSize() const { return m_sets.size(); }
+
+private:
+    struct Key {
+        VkDescriptorSetLayout layout;
+        std::vector<DescriptorBinding> bindings;
+
+        bool operator==(const Key& other) const {
+            return layout == other.layout && bindings == other.bindings;
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+
+    DescriptorPoolChain m_pools;
+    std::unordered_map<Key, VkDescriptorSet, KeyHash> m_sets;
+};
+
+}
@@ -9,6 +9,8 @@ DescriptorManager::DescriptorManager()
     , m_cameraLayout(VK_NULL_HANDLE)
     , m_objectLayout(VK_NULL_HANDLE)
     , m_materialLayout(VK_NULL_HANDLE)
+    , m_bindlessPool(VK_NULL_HANDLE)
+    , m_bindlessLayout(VK_NULL_HANDLE)
 {
 }
 
@@ -19,7 +21,7 @@ bool DescriptorManager::create(VkDevice device, uint32_t maxFrames) {
     // Create descriptor pool
     std::array<VkDescriptorPoolSize, 3> poolSizes{};
 
-    // Uniform buffers (camera, light, object, material)
+    // Uniform buffers (camera, light)
     poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
     poolSizes[0].descriptorCount = maxFrames * 10; // Generous allocation
 
@@ -27,7 +29,7 @@ bool DescriptorManager::create(VkDevice device, uint32_t maxFrames) {
     poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
     poolSizes[1].descriptorCount = maxFrames * 10;
 
-    // Storage buffers (if needed later)
+    // Storage buffers (object transforms, material registry)
     poolSizes[2].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
     poolSizes[2].descriptorCount = maxFrames * 4;
 
@@ -64,6 +66,76 @@ void DescriptorManager::destroy(VkDevice device) {
     if (m_descriptorPool != VK_NULL_HANDLE) {
         vkDestroyDescriptorPool(device, m_descriptorPool, nullptr);
     }
+    if (m_bindlessLayout != VK_NULL_HANDLE) {
+        vkDestroyDescriptorSetLayout(device, m_bindlessLayout, nullptr);
+    }
+    if (m_bindlessPool != VK_NULL_HANDLE) {
+        vkDestroyDescriptorPool(device, m_bindlessPool, nullptr);
+    }
+}
+
+bool DescriptorManager::createBindlessResources(VkDevice device, uint32_t maxFrames, uint32_t textureCount) {
+    std::array<VkDescriptorPoolSize, 2> poolSizes{};
+
+    // Material table
+    poolSizes[0].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSizes[0].descriptorCount = maxFrames;
+
+    // Texture table
+    poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    poolSizes[1].descriptorCount = maxFrames * textureCount;
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT;
+    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    poolInfo.pPoolSizes = poolSizes.data();
+    poolInfo.maxSets = maxFrames;
+
+    if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &m_bindlessPool) != VK_SUCCESS) {
+        std::cerr << "Failed to create bindless descriptor pool!" << std::endl;
+        return false;
+    }
+
+    std::array<VkDescriptorSetLayoutBinding, 2> bindings{};
+
+    // Binding 0: Material registry, indexed by the material push constant
+    bindings[0].binding = 0;
+    bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    bindings[0].descriptorCount = 1;
+    bindings[0].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    // Binding 1: Every registered texture
+    bindings[1].binding = 1;
+    bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    bindings[1].descriptorCount = textureCount;
+    bindings[1].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    // Only the texture array is written while frames are in flight; the
+    // material buffer is rewritten after the frame's fence like any other set
+    std::array<VkDescriptorBindingFlagsEXT, 2> bindingFlags = {
+        0,
+        VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT
+    };
+
+    VkDescriptorSetLayoutBindingFlagsCreateInfoEXT bindingFlagsInfo{};
+    bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT;
+    bindingFlagsInfo.bindingCount = static_cast<uint32_t>(bindingFlags.size());
+    bindingFlagsInfo.pBindingFlags = bindingFlags.data();
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.pNext = &bindingFlagsInfo;
+    layoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT;
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
+
+    if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &m_bindlessLayout) != VK_SUCCESS) {
+        std::cerr << "Failed to create bindless descriptor set layout!" << std::endl;
+        return false;
+    }
+
+    return true;
 }
 
 bool DescriptorManager::createDescriptorSetLayouts(VkDevice device) {
@@ -94,11 +166,11 @@ bool DescriptorManager::createDescriptorSetLayouts(VkDevice device) {
         }
     }
 
-    // Set 1: Object transform
+    // Set 1: Object transforms (storage buffer indexed by gl_InstanceIndex)
     {
         VkDescriptorSetLayoutBinding binding{};
         binding.binding = 0;
-        binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        binding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
         binding.descriptorCount = 1;
         binding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
 
@@ -113,13 +185,13 @@ bool DescriptorManager::createDescriptorSetLayouts(VkDevice device) {
         }
     }
 
-    // Set 2: Material + Textures
+    // Set 2: Materials + Textures
     {
         std::array<VkDescriptorSetLayoutBinding, 4> bindings{};
 
-        // Binding 0: Material UBO
+        // Binding 0: Material registry, indexed by the material push constant
         bindings[0].binding = 0;
-        bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
         bindings[0].descriptorCount = 1;
         bindings[0].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
 
@@ -187,6 +259,36 @@ bool DescriptorManager::allocateDescriptorSets(
     return true;
 }
 
+bool DescriptorManager::allocateBindlessSet(VkDevice device, VkDescriptorSet& bindlessSet) {
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = m_bindlessPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &m_bindlessLayout;
+
+    if (vkAllocateDescriptorSets(device, &allocInfo, &bindlessSet) != VK_SUCCESS) {
+        std::cerr << "Failed to allocate bindless descriptor set!" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool DescriptorManager::allocateObjectSet(VkDevice device, VkDescriptorSet& objectSet) {
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = m_descriptorPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &m_objectLayout;
+
+    if (vkAllocateDescriptorSets(device, &allocInfo, &objectSet) != VK_SUCCESS) {
+        std::cerr << "Failed to allocate object descriptor set!" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
 void DescriptorManager::updateCameraDescriptor(
     VkDevice device,
     VkDescriptorSet descriptorSet,
@@ -239,83 +341,81 @@ void DescriptorManager::updateObjectDescriptor(
     write.dstSet = descriptorSet;
     write.dstBinding = 0;
     write.dstArrayElement = 0;
-    write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
     write.descriptorCount = 1;
     write.pBufferInfo = &bufferInfo;
 
     vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
 }
 
-void DescriptorManager::updateMaterialDescriptor(
+void DescriptorManager::updateMaterialBuffer(
     VkDevice device,
     VkDescriptorSet descriptorSet,
-    VkBuffer materialBuffer,
-    VkImageView paletteView,
-    VkSampler paletteSampler,
-    VkImageView blueNoiseView,
-    VkSampler blueNoiseSampler,
-    VkImageView albedoView,
-    VkSampler albedoSampler
+    VkBuffer materialBuffer
 ) {
-    std::array<VkWriteDescriptorSet, 4> writes{};
+    VkDescriptorBufferInfo bufferInfo{};
+    bufferInfo.buffer = materialBuffer;
+    bufferInfo.offset = 0;
+    bufferInfo.range = VK_WHOLE_SIZE;
 
-    // Material buffer
-    VkDescriptorBufferInfo materialInfo{};
-    materialInfo.buffer = materialBuffer;
-    materialInfo.offset = 0;
-    materialInfo.range = VK_WHOLE_SIZE;
+    VkWriteDescriptorSet write{};
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet = descriptorSet;
+    write.dstBinding = 0;
+    write.dstArrayElement = 0;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    write.descriptorCount = 1;
+    write.pBufferInfo = &bufferInfo;
 
-    writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    writes[0].dstSet = descriptorSet;
-    writes[0].dstBinding = 0;
-    writes[0].dstArrayElement = 0;
-    writes[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    writes[0].descriptorCount = 1;
-    writes[0].pBufferInfo = &materialInfo;
+    vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+}
 
-    // Palette texture
-    VkDescriptorImageInfo paletteImageInfo{};
-    paletteImageInfo.imageView = paletteView;
-    paletteImageInfo.sampler = paletteSampler;
-    paletteImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+void DescriptorManager::updateMaterialTexture(
+    VkDevice device,
+    VkDescriptorSet descriptorSet,
+    uint32_t binding,
+    VkImageView view,
+    VkSampler sampler
+) {
+    VkDescriptorImageInfo imageInfo{};
+    imageInfo.imageView = view;
+    imageInfo.sampler = sampler;
+    imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 
-    writes[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    writes[1].dstSet = descriptorSet;
-    writes[1].dstBinding = 1;
-    writes[1].dstArrayElement = 0;
-    writes[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    writes[1].descriptorCount = 1;
-    writes[1].pImageInfo = &paletteImageInfo;
-
-    // Blue noise texture
-    VkDescriptorImageInfo blueNoiseImageInfo{};
-    blueNoiseImageInfo.imageView = blueNoiseView;
-    blueNoiseImageInfo.sampler = blueNoiseSampler;
-    blueNoiseImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-
-    writes[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    writes[2].dstSet = descriptorSet;
-    writes[2].dstBinding = 2;
-    writes[2].dstArrayElement = 0;
-    writes[2].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    writes[2].descriptorCount = 1;
-    writes[2].pImageInfo = &blueNoiseImageInfo;
-
-    // Albedo texture
-    VkDescriptorImageInfo albedoImageInfo{};
-    albedoImageInfo.imageView = albedoView;
-    albedoImageInfo.sampler = albedoSampler;
-    albedoImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-
-    writes[3].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    writes[3].dstSet = descriptorSet;
-    writes[3].dstBinding = 3;
-    writes[3].dstArrayElement = 0;
-    writes[3].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    writes[3].descriptorCount = 1;
-    writes[3].pImageInfo = &albedoImageInfo;
+    VkWriteDescriptorSet write{};
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet = descriptorSet;
+    write.dstBinding = binding;
+    write.dstArrayElement = 0;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    write.descriptorCount = 1;
+    write.pImageInfo = &imageInfo;
 
-    vkUpdateDescriptorSets(device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+    vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+}
+
+void DescriptorManager::updateBindlessTexture(
+    VkDevice device,
+    VkDescriptorSet descriptorSet,
+    uint32_t index,
+    VkImageView view,
+    VkSampler sampler
+) {
+    VkDescriptorImageInfo imageInfo{};
+    imageInfo.imageView = view;
+    imageInfo.sampler = sampler;
+    imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    VkWriteDescriptorSet write{};
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet = descriptorSet;
+    write.dstBinding = 1;
+    write.dstArrayElement = index;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    write.descriptorCount = 1;
+    write.pImageInfo = &imageInfo;
+
+    vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
 }
 
 }
\ No newline at end of file
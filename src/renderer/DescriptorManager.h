@@ -28,6 +28,17 @@ public:
       VkDescriptorSet& materialSet
    );
 
+      // Allocate an extra object set (set 1), e.g. for a GPU-written object buffer
+   bool allocateObjectSet(VkDevice device, VkDescriptorSet& objectSet);
+
+      // Bindless set 2 (VK_EXT_descriptor_indexing): binding 0 is the material
+      // table storage buffer, binding 1 a partially bound array of textureCount
+      // samplers that can be written while in use. Lives in its own
+      // update-after-bind pool with one set per frame.
+   bool createBindlessResources(VkDevice device, uint32_t maxFrames, uint32_t textureCount);
+
+   bool allocateBindlessSet(VkDevice device, VkDescriptorSet& bindlessSet);
+
       // Update descriptor sets with buffers
    void updateCameraDescriptor(
       VkDevice device,
@@ -42,22 +53,35 @@ public:
       VkBuffer objectBuffer
    );
 
-   void updateMaterialDescriptor(
+      // Binding 0 of either set 2 layout: the material registry buffer
+   void updateMaterialBuffer(
+      VkDevice device,
+      VkDescriptorSet descriptorSet,
+      VkBuffer materialBuffer
+   );
+
+      // Palette (1), blue noise (2) or albedo (3) texture of the non-bindless set 2
+   void updateMaterialTexture(
+      VkDevice device,
+      VkDescriptorSet descriptorSet,
+      uint32_t binding,
+      VkImageView view,
+      VkSampler sampler
+   );
+
+   void updateBindlessTexture(
       VkDevice device,
       VkDescriptorSet descriptorSet,
-      VkBuffer materialBuffer,
-      VkImageView paletteView,
-      VkSampler paletteSampler,
-      VkImageView blueNoiseView,
-      VkSampler blueNoiseSampler,
-      VkImageView albedoView,
-      VkSampler albedoSampler
+      uint32_t index,
+      VkImageView view,
+      VkSampler sampler
    );
 
    // Getters
    VkDescriptorSetLayout getCameraLayout() const { return m_cameraLayout; }
    VkDescriptorSetLayout getObjectLayout() const { return m_objectLayout; }
    VkDescriptorSetLayout getMaterialLayout() const { return m_materialLayout; }
+   VkDescriptorSetLayout getBindlessLayout() const { return m_bindlessLayout; }
 
 private:
    VkDescriptorPool m_descriptorPool;
@@ -65,6 +89,9 @@ private:
    VkDescriptorSetLayout m_cameraLayout;    // Set 0
    VkDescriptorSetLayout m_objectLayout;    // Set 1
    VkDescriptorSetLayout m_materialLayout;  // Set 2
+
+   VkDescriptorPool m_bindlessPool;
+   VkDescriptorSetLayout m_bindlessLayout;  // Set 2 when bindless
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,138 @@
+#include "GeometryPool.h"
+#include <iostream>
+
+namespace Plaster {
+
+GeometryPool::GeometryPool()
+    : m_vertexStride(0)
+{
+}
+
+GeometryPool::~GeometryPool() {
+}
+
+bool GeometryPool::create(VmaAllocator allocator, uint32_t vertexStride, uint32_t vertexCapacity, uint32_t indexCapacity) {
+    m_vertexStride = vertexStride;
+
+    if (!m_vertexBuffer.create(
+        allocator,
+        static_cast<VkDeviceSize>(vertexCapacity) * vertexStride,
+        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VMA_MEMORY_USAGE_GPU_ONLY
+    )) {
+        std::cerr << "Failed to create geometry pool vertex buffer" << std::endl;
+        return false;
+    }
+
+    if (!m_indexBuffer.create(
+        allocator,
+        static_cast<VkDeviceSize>(indexCapacity) * sizeof(uint32_t),
+        VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VMA_MEMORY_USAGE_GPU_ONLY
+    )) {
+        std::cerr << "Failed to create geometry pool index buffer" << std::endl;
+        m_vertexBuffer.destroy(allocator);
+        return false;
+    }
+
+    // Meshes with at most 65536 vertices store 16-bit indices here instead
+    if (!m_indexBuffer16.create(
+        allocator,
+        static_cast<VkDeviceSize>(indexCapacity) * sizeof(uint16_t),
+        VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VMA_MEMORY_USAGE_GPU_ONLY
+    )) {
+        std::cerr << "Failed to create geometry pool 16-bit index buffer" << std::endl;
+        m_vertexBuffer.destroy(allocator);
+        m_indexBuffer.destroy(allocator);
+        return false;
+    }
+
+    m_vertexAllocator.reset(vertexCapacity);
+    m_indexAllocator.reset(indexCapacity);
+    m_index16Allocator.reset(indexCapacity);
+
+    std::cout << "Geometry pool: " << vertexCapacity << " vertices, "
+              << indexCapacity << " 32-bit and " << indexCapacity << " 16-bit indices" << std::endl;
+    return true;
+}
+
+void GeometryPool::destroy(VmaAllocator allocator) {
+    m_vertexBuffer.destroy(allocator);
+    m_indexBuffer.destroy(allocator);
+    m_indexBuffer16.destroy(allocator);
+    m_vertexAllocator.reset(0);
+    m_indexAllocator.reset(0);
+    m_index16Allocator.reset(0);
+}
+
+bool GeometryPool::allocate(uint32_t vertexCount, uint32_t indexCount, GeometryRange& range, VkIndexType indexType) {
+    uint64_t vertexOffset = m_vertexAllocator.allocate(vertexCount);
+    if (vertexOffset == FreeListAllocator::INVALID_OFFSET) {
+        std::cerr << "Geometry pool out of vertex space (" << vertexCount << " requested, largest block "
+                  << m_vertexAllocator.getLargestFreeBlock() << " of " << m_vertexAllocator.getCapacity()
+                  << "); raise the pool's vertex capacity" << std::endl;
+        return false;
+    }
+
+    FreeListAllocator& indexAllocator = getIndexAllocator(indexType);
+    uint64_t firstIndex = indexAllocator.allocate(indexCount);
+    if (firstIndex == FreeListAllocator::INVALID_OFFSET) {
+        std::cerr << "Geometry pool out of index space (" << indexCount << " requested, largest block "
+                  << indexAllocator.getLargestFreeBlock() << " of " << indexAllocator.getCapacity()
+                  << "); raise the pool's index capacity" << std::endl;
+        m_vertexAllocator.free(vertexOffset, vertexCount);
+        return false;
+    }
+
+    range.vertexOffset = static_cast<uint32_t>(vertexOffset);
+    range.vertexCount = vertexCount;
+    range.firstIndex = static_cast<uint32_t>(firstIndex);
+    range.indexCount = indexCount;
+    range.indexType = indexType;
+    return true;
+}
+
+void GeometryPool::free(GeometryRange& range) {
+    if (!range.isValid()) return;
+
+    m_vertexAllocator.free(range.vertexOffset, range.vertexCount);
+    getIndexAllocator(range.indexType).free(range.firstIndex, range.indexCount);
+    range = GeometryRange{};
+}
+
+std::optional<UploadHandle> GeometryPool::upload(UploadManager& uploads, const GeometryRange& range,
+                                                 const void* vertices, const void* indices) {
+    std::optional<UploadHandle> handle = uploads.uploadBuffer(
+        vertices,
+        static_cast<VkDeviceSize>(range.vertexCount) * m_vertexStride,
+        m_vertexBuffer.getBuffer(),
+        static_cast<VkDeviceSize>(range.vertexOffset) * m_vertexStride
+    );
+    if (!handle) {
+        return std::nullopt;
+    }
+
+    // Batches complete in submission order, so the later handle covers both
+    // copies; a failed index copy fails the whole upload
+    if (range.indexCount > 0) {
+        const VkDeviceSize indexSize = range.indexType == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t);
+        handle = uploads.uploadBuffer(
+            indices,
+            static_cast<VkDeviceSize>(range.indexCount) * indexSize,
+            getIndexBuffer(range.indexType),
+            static_cast<VkDeviceSize>(range.firstIndex) * indexSize
+        );
+    }
+    return handle;
+}
+
+void GeometryPool::bind(VkCommandBuffer commandBuffer, VkIndexType indexType) const {
+    VkBuffer vertexBuffers[] = { m_vertexBuffer.getBuffer() };
+    VkDeviceSize offsets[] = { 0 };
+
+    vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
+    vkCmdBindIndexBuffer(commandBuffer, getIndexBuffer(indexType), 0, indexType);
+}
+
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "VulkanBuffer.h"
+#include "UploadManager.h"
+#include "../memory/FreeListAllocator.h"
+#include <vulkan/vulkan.h>
+#include <vk_mem_alloc.h>
+#include <cstdint>
+
+namespace Plaster {
+
+// A mesh's slice of the geometry pool, in vertices and indices. Indices are
+// stored relative to the mesh, so draws pass vertexOffset and firstIndex;
+// firstIndex is into the index buffer of the range's index type.
+struct GeometryRange {
+    uint32_t vertexOffset = 0;
+    uint32_t vertexCount = 0;
+    uint32_t firstIndex = 0;
+    uint32_t indexCount = 0;
+    VkIndexType indexType = VK_INDEX_TYPE_UINT32;
+
+    bool isValid() const { return vertexCount > 0; }
+};
+
+// One device-local vertex buffer and two index buffers (16 and 32-bit) shared
+// by every mesh of a vertex layout. Meshes are sub-allocated with a free list,
+// so the renderer binds the pool once per index type and every draw selects
+// its range by offset.
+//
+// Capacity is fixed at create(), so the defaults only fit small scenes; the
+// renderer takes larger sizes through setGeometryPoolCapacity.
+class GeometryPool {
+public:
+    static const uint32_t DEFAULT_VERTEX_CAPACITY = 64 * 1024;
+    static const uint32_t DEFAULT_INDEX_CAPACITY = 256 * 1024;  // Per index type
+
+    GeometryPool();
+    ~GeometryPool();
+
+    GeometryPool(const GeometryPool&) = delete;
+    GeometryPool& operator=(const GeometryPool&) = delete;
+
+    bool create(
+        VmaAllocator allocator,
+        uint32_t vertexStride,
+        uint32_t vertexCapacity = DEFAULT_VERTEX_CAPACITY,
+        uint32_t indexCapacity = DEFAULT_INDEX_CAPACITY
+    );
+    void destroy(VmaAllocator allocator);
+
+    // Reserve space for a mesh; fails when either buffer has no block large
+    // enough. indexType picks the index buffer the range lives in.
+    bool allocate(uint32_t vertexCount, uint32_t indexCount, GeometryRange& range,
+                  VkIndexType indexType = VK_INDEX_TYPE_UINT32);
+
+    // Return a range to the pool. The GPU must no longer be reading it.
+    void free(GeometryRange& range);
+
+    // Queue copies of vertices (vertexStride bytes each) and indices of the
+    // range's index type into a range. Returns nothing if either copy failed.
+    std::optional<UploadHandle> upload(UploadManager& uploads, const GeometryRange& range,
+                                       const void* vertices, const void* indices);
+
+    // Bind the vertex buffer and the index buffer of one type at offset 0
+    void bind(VkCommandBuffer commandBuffer, VkIndexType indexType = VK_INDEX_TYPE_UINT32) const;
+
+    VkBuffer getVertexBuffer() const { return m_vertexBuffer.getBuffer(); }
+    VkBuffer getIndexBuffer(VkIndexType indexType = VK_INDEX_TYPE_UINT32) const {
+        return indexType == VK_INDEX_TYPE_UINT16 ? m_indexBuffer16.getBuffer() : m_indexBuffer.getBuffer();
+    }
+    uint32_t getVertexStride() const { return m_vertexStride; }
+
+    uint64_t getUsedVertices() const { return m_vertexAllocator.getUsed(); }
+    uint64_t getUsedIndices() const { return m_indexAllocator.getUsed() + m_index16Allocator.getUsed(); }
+    uint64_t getUsedIndexBytes() const {
+        return m_indexAllocator.getUsed() * sizeof(uint32_t) + m_index16Allocator.getUsed() * sizeof(uint16_t);
+    }
+
+private:
+    VulkanBuffer m_vertexBuffer;
+    VulkanBuffer m_indexBuffer;
+    VulkanBuffer m_indexBuffer16;
+    FreeListAllocator m_vertexAllocator;
+    FreeListAllocator m_indexAllocator;
+    FreeListAllocator m_index16Allocator;
+    uint32_t m_vertexStride;
+
+    FreeListAllocator& getIndexAllocator(VkIndexType indexType) {
+        return indexType == VK_INDEX_TYPE_UINT16 ? m_index16Allocator : m_indexAllocator;
+    }
+};
+
+}
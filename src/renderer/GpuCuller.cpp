@@ -0,0 +1,533 @@
+#include "GpuCuller.h"
+#include "ShaderCompiler.h"
+#include "../scene/Scene.h"
+#include <algorithm>
+#include <array>
+#include <iostream>
+
+namespace Plaster {
+
+static const uint32_t CULL_WORKGROUP_SIZE = 64;
+static const uint32_t INITIAL_CULL_OBJECTS = 1024;
+static const uint32_t INITIAL_CULL_GROUPS = 64;
+
+GpuCuller::GpuCuller()
+    : m_allocator(nullptr)
+    , m_device(VK_NULL_HANDLE)
+    , m_descriptorPool(VK_NULL_HANDLE)
+    , m_descriptorLayout(VK_NULL_HANDLE)
+    , m_pipelineLayout(VK_NULL_HANDLE)
+    , m_pipeline(VK_NULL_HANDLE)
+    , m_multiDrawIndirect(false)
+    , m_drawIndexedIndirectCount(nullptr)
+    , m_shaderCacheDirectory(ShaderCompiler::DEFAULT_CACHE_DIRECTORY)
+    , m_structureVersion(UINT64_MAX)
+    , m_sceneObjectCount(0)
+    , m_objectCount(0)
+    , m_instanceCount(0)
+{
+}
+
+GpuCuller::~GpuCuller() {
+}
+
+bool GpuCuller::create(
+    VmaAllocator allocator,
+    VkDevice device,
+    VkPipelineCache pipelineCache,
+    const std::vector<VulkanBuffer>& cameraBuffers,
+    bool multiDrawIndirect,
+    PFN_vkCmdDrawIndexedIndirectCountKHR drawCount
+) {
+    m_allocator = allocator;
+    m_device = device;
+    m_multiDrawIndirect = multiDrawIndirect;
+    m_drawIndexedIndirectCount = drawCount;
+
+    const uint32_t frameCount = static_cast<uint32_t>(cameraBuffers.size());
+
+    std::array<VkDescriptorSetLayoutBinding, 7> bindings{};
+    for (uint32_t i = 0; i < bindings.size(); i++) {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = i == 0 ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
+    if (vkCreateDescriptorSetLayout(m_device, &layoutInfo, nullptr, &m_descriptorLayout) != VK_SUCCESS) {
+        std::cerr << "Failed to create cull descriptor set layout" << std::endl;
+        return false;
+    }
+
+    std::array<VkDescriptorPoolSize, 2> poolSizes{};
+    poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    poolSizes[0].descriptorCount = frameCount;
+    poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSizes[1].descriptorCount = frameCount * 6;
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    poolInfo.pPoolSizes = poolSizes.data();
+    poolInfo.maxSets = frameCount;
+    if (vkCreateDescriptorPool(m_device, &poolInfo, nullptr, &m_descriptorPool) != VK_SUCCESS) {
+        std::cerr << "Failed to create cull descriptor pool" << std::endl;
+        return false;
+    }
+
+    if (!createPipeline(pipelineCache)) {
+        return false;
+    }
+
+    m_frames.resize(frameCount);
+    for (uint32_t i = 0; i < frameCount; i++) {
+        Frame& frame = m_frames[i];
+        frame.cameraBuffer = cameraBuffers[i].getBuffer();
+
+        VkDescriptorSetAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.descriptorPool = m_descriptorPool;
+        allocInfo.descriptorSetCount = 1;
+        allocInfo.pSetLayouts = &m_descriptorLayout;
+        if (vkAllocateDescriptorSets(m_device, &allocInfo, &frame.descriptorSet) != VK_SUCCESS) {
+            std::cerr << "Failed to allocate cull descriptor set" << std::endl;
+            return false;
+        }
+
+        bool objectBufferChanged = false;
+        if (!ensureCapacity(frame, INITIAL_CULL_OBJECTS, INITIAL_CULL_OBJECTS, INITIAL_CULL_GROUPS, objectBufferChanged)) {
+            return false;
+        }
+    }
+
+    std::cout << "GPU culling enabled ("
+              << (m_drawIndexedIndirectCount ? "indirect count" : m_multiDrawIndirect ? "multi-draw indirect" : "single-draw indirect")
+              << ")" << std::endl;
+    return true;
+}
+
+void GpuCuller::destroy(VmaAllocator allocator, VkDevice device) {
+    for (Frame& frame : m_frames) {
+        frame.cullObjects.destroy(allocator);
+        frame.groups.destroy(allocator);
+        frame.counters.destroy(allocator);
+        frame.objects.destroy(allocator);
+        frame.commands.destroy(allocator);
+        frame.lodState.destroy(allocator);
+    }
+    m_frames.clear();
+
+    if (m_pipeline != VK_NULL_HANDLE) {
+        vkDestroyPipeline(device, m_pipeline, nullptr);
+        m_pipeline = VK_NULL_HANDLE;
+    }
+    if (m_pipelineLayout != VK_NULL_HANDLE) {
+        vkDestroyPipelineLayout(device, m_pipelineLayout, nullptr);
+        m_pipelineLayout = VK_NULL_HANDLE;
+    }
+    if (m_descriptorPool != VK_NULL_HANDLE) {
+        vkDestroyDescriptorPool(device, m_descriptorPool, nullptr);
+        m_descriptorPool = VK_NULL_HANDLE;
+    }
+    if (m_descriptorLayout != VK_NULL_HANDLE) {
+        vkDestroyDescriptorSetLayout(device, m_descriptorLayout, nullptr);
+        m_descriptorLayout = VK_NULL_HANDLE;
+    }
+}
+
+bool GpuCuller::update(uint32_t frameIndex, const std::vector<RenderObject>& objects, uint64_t structureVersion) {
+    if (structureVersion != m_structureVersion || objects.size() != m_sceneObjectCount) {
+        rebuildGroups(objects);
+        m_structureVersion = structureVersion;
+        m_sceneObjectCount = objects.size();
+    }
+
+    Frame& frame = m_frames[frameIndex];
+    bool objectBufferChanged = false;
+    if (!ensureCapacity(frame, m_objectCount, m_instanceCount, static_cast<uint32_t>(m_groups.size()),
+                        objectBufferChanged)) {
+        m_objectCount = 0;
+        return objectBufferChanged;
+    }
+
+    if (frame.groupVersion != m_structureVersion && !m_groups.empty()) {
+        std::copy(m_groups.begin(), m_groups.end(), static_cast<CullDrawGroup*>(frame.groups.getMappedData()));
+        frame.groups.flush(m_allocator, 0, sizeof(CullDrawGroup) * m_groups.size());
+        frame.groupVersion = m_structureVersion;
+        frame.lodStateValid = false;  // Object indices may have moved
+    }
+
+    // The only per-object CPU work: copy the raw transform
+    auto* cullObjects = static_cast<CullObject*>(frame.cullObjects.getMappedData());
+    uint32_t written = 0;
+    for (size_t i = 0; i < objects.size() && written < m_objectCount; i++) {
+        const RenderObject& obj = objects[i];
+        if (!obj.mesh || !obj.material) {
+            continue;
+        }
+        CullObject& cull = cullObjects[written];
+        cull.position = obj.position;
+        cull.group = m_objectGroups[written];
+        cull.rotation = obj.rotation;
+        cull.scale = obj.scale;
+        written++;
+    }
+    frame.cullObjects.flush(m_allocator, 0, sizeof(CullObject) * written);
+
+    return objectBufferChanged;
+}
+
+void GpuCuller::recordCull(VkCommandBuffer commandBuffer, uint32_t frameIndex, float viewportHeight,
+                           const LodSelection& lodSelection) {
+    if (m_objectCount == 0) return;
+
+    Frame& frame = m_frames[frameIndex];
+
+    vkCmdFillBuffer(commandBuffer, frame.counters.getBuffer(), 0, VK_WHOLE_SIZE, 0);
+    if (!frame.lodStateValid) {
+        vkCmdFillBuffer(commandBuffer, frame.lodState.getBuffer(), 0, VK_WHOLE_SIZE, 0);
+        frame.lodStateValid = true;
+    }
+
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipelineLayout,
+                            0, 1, &frame.descriptorSet, 0, nullptr);
+
+    PushConstants params{};
+    params.objectCount = m_objectCount;
+    params.groupCount = static_cast<uint32_t>(m_groups.size());
+    params.listCount = static_cast<uint32_t>(m_lists.size());
+    params.compact = m_drawIndexedIndirectCount ? 1 : 0;
+    params.viewportHeight = viewportHeight;
+    params.lodThreshold = lodSelection.thresholdPixels;
+    params.lodHysteresis = lodSelection.hysteresis;
+
+    // Phase 0: cull objects and fill the instance ranges
+    params.phase = 0;
+    vkCmdPushConstants(commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(params), &params);
+    vkCmdDispatch(commandBuffer, (params.objectCount + CULL_WORKGROUP_SIZE - 1) / CULL_WORKGROUP_SIZE, 1, 1);
+
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+    // Phase 1: one indirect command per visible group
+    params.phase = 1;
+    vkCmdPushConstants(commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(params), &params);
+    vkCmdDispatch(commandBuffer, (params.groupCount + CULL_WORKGROUP_SIZE - 1) / CULL_WORKGROUP_SIZE, 1, 1);
+
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+                         0, 1, &barrier, 0, nullptr, 0, nullptr);
+}
+
+uint32_t GpuCuller::recordDraws(VkCommandBuffer commandBuffer, uint32_t frameIndex, uint32_t listIndex) const {
+    const Frame& frame = m_frames[frameIndex];
+    const IndirectDrawList& list = m_lists[listIndex];
+    const VkDeviceSize stride = sizeof(VkDrawIndexedIndirectCommand);
+    const VkDeviceSize offset = list.firstDraw * stride;
+
+    if (m_drawIndexedIndirectCount) {
+        m_drawIndexedIndirectCount(commandBuffer, frame.commands.getBuffer(), offset,
+                                   frame.counters.getBuffer(), listIndex * sizeof(uint32_t),
+                                   list.drawCount, static_cast<uint32_t>(stride));
+        return 1;
+    }
+
+    if (m_multiDrawIndirect) {
+        vkCmdDrawIndexedIndirect(commandBuffer, frame.commands.getBuffer(), offset, list.drawCount,
+                                 static_cast<uint32_t>(stride));
+        return 1;
+    }
+
+    for (uint32_t i = 0; i < list.drawCount; i++) {
+        vkCmdDrawIndexedIndirect(commandBuffer, frame.commands.getBuffer(), offset + i * stride, 1,
+                                 static_cast<uint32_t>(stride));
+    }
+    return list.drawCount;
+}
+
+bool GpuCuller::createPipeline(VkPipelineCache pipelineCache) {
+    VkPushConstantRange pushRange{};
+    pushRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushRange.offset = 0;
+    pushRange.size = sizeof(PushConstants);
+
+    VkPipelineLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    layoutInfo.setLayoutCount = 1;
+    layoutInfo.pSetLayouts = &m_descriptorLayout;
+    layoutInfo.pushConstantRangeCount = 1;
+    layoutInfo.pPushConstantRanges = &pushRange;
+    if (vkCreatePipelineLayout(m_device, &layoutInfo, nullptr, &m_pipelineLayout) != VK_SUCCESS) {
+        std::cerr << "Failed to create cull pipeline layout" << std::endl;
+        return false;
+    }
+
+    ShaderCompiler compiler;
+    compiler.setCacheDirectory(m_shaderCacheDirectory);
+    std::vector<uint32_t> spirv;
+    if (!compiler.compileFromFile("src/shaders/cull.comp", ShaderStage::COMPUTE, "main", spirv)) {
+        std::cerr << "Failed to compile cull shader: " << compiler.getLastError() << std::endl;
+        return false;
+    }
+
+    VkShaderModule module = compiler.createShaderModule(m_device, spirv);
+    if (module == VK_NULL_HANDLE) {
+        return false;
+    }
+
+    VkComputePipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineInfo.stage.module = module;
+    pipelineInfo.stage.pName = "main";
+    pipelineInfo.layout = m_pipelineLayout;
+
+    VkResult result = vkCreateComputePipelines(m_device, pipelineCache, 1, &pipelineInfo, nullptr, &m_pipeline);
+    vkDestroyShaderModule(m_device, module, nullptr);
+    if (result != VK_SUCCESS) {
+        std::cerr << "Failed to create cull pipeline" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void GpuCuller::rebuildGroups(const std::vector<RenderObject>& objects) {
+    struct Entry {
+        uint32_t pipelineId;
+        VkIndexType indexType;
+        PlastibooMaterial* material;
+        Mesh* mesh;
+        uint32_t object;
+    };
+
+    std::vector<Entry> entries;
+    entries.reserve(objects.size());
+    for (uint32_t i = 0; i < static_cast<uint32_t>(objects.size()); i++) {
+        const RenderObject& obj = objects[i];
+        if (obj.mesh && obj.material) {
+            entries.push_back({static_cast<uint32_t>(obj.mesh->getVertexFormat()), obj.mesh->getIndexType(),
+                               obj.material.get(), obj.mesh.get(), i});
+        }
+    }
+
+    // Format then index type order keeps each list's commands contiguous;
+    // material and mesh order within a list only help locality
+    std::stable_sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        if (a.pipelineId != b.pipelineId) {
+            return a.pipelineId < b.pipelineId;
+        }
+        if (a.indexType != b.indexType) {
+            return a.indexType < b.indexType;
+        }
+        if (a.material != b.material) {
+            return a.material->getSortId() != b.material->getSortId()
+                ? a.material->getSortId() < b.material->getSortId()
+                : a.material < b.material;
+        }
+        if (a.mesh != b.mesh) {
+            return a.mesh->getSortId() != b.mesh->getSortId()
+                ? a.mesh->getSortId() < b.mesh->getSortId()
+                : a.mesh < b.mesh;
+        }
+        return false;
+    });
+
+    m_groups.clear();
+    m_lists.clear();
+    std::vector<uint32_t> groupOfObject(objects.size(), 0);
+
+    const Mesh* currentMesh = nullptr;
+    const PlastibooMaterial* currentMaterial = nullptr;
+    uint32_t currentPipeline = UINT32_MAX;
+    VkIndexType currentIndexType = VK_INDEX_TYPE_MAX_ENUM;
+    uint32_t baseGroup = 0;
+    for (const Entry& entry : entries) {
+        if (entry.pipelineId != currentPipeline || entry.indexType != currentIndexType) {
+            m_lists.push_back({entry.pipelineId, entry.indexType, static_cast<uint32_t>(m_groups.size()), 0});
+            currentPipeline = entry.pipelineId;
+            currentIndexType = entry.indexType;
+            currentMesh = nullptr;
+        }
+        // The same mesh under another material needs its own groups
+        if (entry.material != currentMaterial) {
+            currentMaterial = entry.material;
+            currentMesh = nullptr;
+        }
+        if (entry.mesh != currentMesh) {
+            const GeometryRange& geometry = entry.mesh->getRange();
+            const uint32_t lodCount = std::max(entry.mesh->getLodCount(), 1u);
+            baseGroup = static_cast<uint32_t>(m_groups.size());
+            for (uint32_t lod = 0; lod < lodCount; lod++) {
+                const MeshLod& level = entry.mesh->getLod(lod);
+                CullDrawGroup group{};
+                group.indexCount = level.indexCount;
+                group.firstIndex = level.firstIndex;
+                group.vertexOffset = static_cast<int32_t>(geometry.vertexOffset);
+                group.firstInstance = 0;
+                group.bounds = glm::vec4(entry.mesh->getBoundsCenter(), entry.mesh->getBoundsRadius());
+                group.material = entry.material->getIndex();
+                group.drawList = static_cast<uint32_t>(m_lists.size() - 1);
+                group.drawBase = m_lists.back().firstDraw;
+                group.lodCount = lodCount - lod;
+                group.lodError = level.error;
+                group.dequantizeOffset = glm::vec4(entry.mesh->getDequantizeOffset(), 0.0f);
+                group.dequantizeScale = glm::vec4(entry.mesh->getDequantizeScale(), 0.0f);
+                m_groups.push_back(group);
+                m_lists.back().drawCount++;
+            }
+            currentMesh = entry.mesh;
+        }
+        // Holds the object count until the prefix sum below; every LOD of the
+        // mesh can receive all of its objects
+        for (uint32_t group = baseGroup; group < m_groups.size(); group++) {
+            m_groups[group].firstInstance++;
+        }
+        groupOfObject[entry.object] = baseGroup;
+    }
+
+    // Every group reserves a slot for each of its objects, so culling never overflows
+    uint32_t firstInstance = 0;
+    for (CullDrawGroup& group : m_groups) {
+        uint32_t count = group.firstInstance;
+        group.firstInstance = firstInstance;
+        firstInstance += count;
+    }
+    m_instanceCount = firstInstance;
+
+    // Group per uploaded object, in scene order (objects without a mesh or material are skipped)
+    m_objectGroups.clear();
+    m_objectGroups.reserve(entries.size());
+    for (uint32_t i = 0; i < static_cast<uint32_t>(objects.size()); i++) {
+        if (objects[i].mesh && objects[i].material) {
+            m_objectGroups.push_back(groupOfObject[i]);
+        }
+    }
+    m_objectCount = static_cast<uint32_t>(m_objectGroups.size());
+}
+
+bool GpuCuller::ensureCapacity(Frame& frame, uint32_t objectCount, uint32_t instanceCount, uint32_t groupCount,
+                               bool& objectBufferChanged) {
+    const uint32_t listCount = static_cast<uint32_t>(m_lists.size());
+    bool changed = false;
+
+    // Grow by doubling; the frame's fence has signalled, so nothing is in use
+    if (objectCount > frame.objectCapacity) {
+        uint32_t capacity = std::max(frame.objectCapacity, INITIAL_CULL_OBJECTS);
+        while (capacity < objectCount) {
+            capacity *= 2;
+        }
+
+        frame.cullObjects.destroy(m_allocator);
+        frame.lodState.destroy(m_allocator);
+        if (!frame.cullObjects.create(m_allocator, sizeof(CullObject) * capacity,
+                                      VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                      VMA_MEMORY_USAGE_CPU_TO_GPU,
+                                      VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT |
+                                      VMA_ALLOCATION_CREATE_MAPPED_BIT) ||
+            !frame.lodState.create(m_allocator, sizeof(uint32_t) * capacity,
+                                   VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                   VMA_MEMORY_USAGE_GPU_ONLY)) {
+            std::cerr << "Failed to create cull object buffers" << std::endl;
+            return false;
+        }
+        frame.objectCapacity = capacity;
+        frame.lodStateValid = false;
+        changed = true;
+    }
+
+    // Slots cover every LOD group, so the output outgrows the input
+    if (instanceCount > frame.instanceCapacity) {
+        uint32_t capacity = std::max(frame.instanceCapacity, INITIAL_CULL_OBJECTS);
+        while (capacity < instanceCount) {
+            capacity *= 2;
+        }
+
+        frame.objects.destroy(m_allocator);
+        if (!frame.objects.create(m_allocator, sizeof(ObjectData) * capacity,
+                                  VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                  VMA_MEMORY_USAGE_GPU_ONLY)) {
+            std::cerr << "Failed to create culled object buffer" << std::endl;
+            return false;
+        }
+        frame.instanceCapacity = capacity;
+        objectBufferChanged = true;
+        changed = true;
+    }
+
+    // Counters cover the list counts as well, so they track both sizes
+    if (groupCount > frame.groupCapacity ||
+        frame.counters.getSize() < sizeof(uint32_t) * (listCount + groupCount)) {
+        uint32_t capacity = std::max(frame.groupCapacity, INITIAL_CULL_GROUPS);
+        while (capacity < groupCount) {
+            capacity *= 2;
+        }
+
+        frame.groups.destroy(m_allocator);
+        frame.counters.destroy(m_allocator);
+        frame.commands.destroy(m_allocator);
+        if (!frame.groups.create(m_allocator, sizeof(CullDrawGroup) * capacity,
+                                 VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                 VMA_MEMORY_USAGE_CPU_TO_GPU,
+                                 VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT |
+                                 VMA_ALLOCATION_CREATE_MAPPED_BIT) ||
+            !frame.counters.create(m_allocator, sizeof(uint32_t) * capacity * 2,
+                                   VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+                                   VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                   VMA_MEMORY_USAGE_GPU_ONLY) ||
+            !frame.commands.create(m_allocator, sizeof(VkDrawIndexedIndirectCommand) * capacity,
+                                   VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                                   VMA_MEMORY_USAGE_GPU_ONLY)) {
+            std::cerr << "Failed to create cull group buffers" << std::endl;
+            return false;
+        }
+        frame.groupCapacity = capacity;
+        frame.groupVersion = UINT64_MAX;
+        changed = true;
+    }
+
+    if (changed) {
+        writeDescriptors(frame);
+    }
+    return true;
+}
+
+void GpuCuller::writeDescriptors(Frame& frame) {
+    std::array<VkDescriptorBufferInfo, 7> bufferInfos{};
+    bufferInfos[0] = {frame.cameraBuffer, 0, sizeof(CameraUBO)};
+    bufferInfos[1] = {frame.cullObjects.getBuffer(), 0, VK_WHOLE_SIZE};
+    bufferInfos[2] = {frame.groups.getBuffer(), 0, VK_WHOLE_SIZE};
+    bufferInfos[3] = {frame.counters.getBuffer(), 0, VK_WHOLE_SIZE};
+    bufferInfos[4] = {frame.objects.getBuffer(), 0, VK_WHOLE_SIZE};
+    bufferInfos[5] = {frame.commands.getBuffer(), 0, VK_WHOLE_SIZE};
+    bufferInfos[6] = {frame.lodState.getBuffer(), 0, VK_WHOLE_SIZE};
+
+    std::array<VkWriteDescriptorSet, 7> writes{};
+    for (uint32_t i = 0; i < writes.size(); i++) {
+        writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[i].dstSet = frame.descriptorSet;
+        writes[i].dstBinding = i;
+        writes[i].descriptorCount = 1;
+        writes[i].descriptorType = i == 0 ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        writes[i].pBufferInfo = &bufferInfos[i];
+    }
+    vkUpdateDescriptorSets(m_device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+}
+
+}
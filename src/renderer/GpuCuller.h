@@ -0,0 +1,160 @@
+#pragma once
+
+#include "VulkanBuffer.h"
+#include "Mesh.h"
+#include <vulkan/vulkan.h>
+#include <vk_mem_alloc.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Plaster {
+
+struct RenderObject;
+
+// Per-object culling input (matches cull.comp). Only the raw transform is
+// uploaded; the compute pass builds the matrices for visible objects.
+struct CullObject {
+    glm::vec3 position;
+    uint32_t group;
+    glm::vec3 rotation;
+    float pad0;
+    glm::vec3 scale;
+    float pad1;
+};
+
+// One (mesh, material, LOD) with a slot range in the object buffer (matches
+// cull.comp). A mesh's LODs are consecutive groups and objects point at LOD 0.
+struct CullDrawGroup {
+    uint32_t indexCount;
+    uint32_t firstIndex;
+    int32_t vertexOffset;
+    uint32_t firstInstance;
+    glm::vec4 bounds;
+    uint32_t material;    // MaterialRegistry slot
+    uint32_t drawList;
+    uint32_t drawBase;
+    uint32_t lodCount;    // Levels following this one, including itself, on LOD 0
+    float lodError;       // This level's error in mesh units
+    float pad0;
+    float pad1;
+    float pad2;
+    glm::vec4 dequantizeOffset;  // xyz: stored position to mesh units (PACKED meshes)
+    glm::vec4 dequantizeScale;
+};
+
+// Consecutive indirect commands that share a pipeline and index buffer. Each
+// object's material travels in its ObjectData, so one list spans every material.
+struct IndirectDrawList {
+    uint32_t pipelineId;  // VertexFormat of the list's meshes
+    VkIndexType indexType;
+    uint32_t firstDraw;
+    uint32_t drawCount;
+};
+
+// Frustum culling and draw generation on the GPU. Objects are grouped by
+// (mesh, material, LOD) only when the scene structure changes; every frame
+// the CPU copies raw transforms, a compute pass culls them, picks a LOD from
+// the projected error and writes the object buffer plus
+// VkDrawIndexedIndirectCommands, and the scene is drawn with one indirect
+// call per vertex format and index type.
+class GpuCuller {
+public:
+    GpuCuller();
+    ~GpuCuller();
+
+    GpuCuller(const GpuCuller&) = delete;
+    GpuCuller& operator=(const GpuCuller&) = delete;
+
+    // cameraBuffers holds one CameraUBO buffer per frame in flight. drawCount
+    // may be null when VK_KHR_draw_indirect_count is unavailable.
+    bool create(
+        VmaAllocator allocator,
+        VkDevice device,
+        VkPipelineCache pipelineCache,
+        const std::vector<VulkanBuffer>& cameraBuffers,
+        bool multiDrawIndirect,
+        PFN_vkCmdDrawIndexedIndirectCountKHR drawCount
+    );
+    void destroy(VmaAllocator allocator, VkDevice device);
+
+    // Where the cull shader's SPIR-V is cached. Must be set before create().
+    void setShaderCacheDirectory(const std::string& directory) { m_shaderCacheDirectory = directory; }
+
+    // Copy this frame's transforms, regrouping first if structureVersion
+    // changed. Returns true when the frame's object buffer was reallocated
+    // and descriptor sets pointing at it must be updated.
+    bool update(uint32_t frame, const std::vector<RenderObject>& objects, uint64_t structureVersion);
+
+    // Cull and build draws; record outside any render pass. viewportHeight is
+    // the internal render height; a threshold of zero always draws LOD 0.
+    void recordCull(VkCommandBuffer commandBuffer, uint32_t frame, float viewportHeight,
+                    const LodSelection& lodSelection);
+
+    // Draw one list's groups, for the main pass and the depth pre-pass alike;
+    // returns the number of draw calls recorded
+    uint32_t recordDraws(VkCommandBuffer commandBuffer, uint32_t frame, uint32_t listIndex) const;
+
+    const std::vector<IndirectDrawList>& getDrawLists() const { return m_lists; }
+    VkBuffer getObjectBuffer(uint32_t frame) const { return m_frames[frame].objects.getBuffer(); }
+    uint32_t getObjectCount() const { return m_objectCount; }
+    uint32_t getGroupCount() const { return static_cast<uint32_t>(m_groups.size()); }
+    bool usesDrawCount() const { return m_drawIndexedIndirectCount != nullptr; }
+    bool isCreated() const { return m_pipeline != VK_NULL_HANDLE; }
+
+private:
+    struct Frame {
+        VulkanBuffer cullObjects;   // CPU_TO_GPU, persistently mapped
+        VulkanBuffer groups;        // CPU_TO_GPU, persistently mapped
+        VulkanBuffer counters;      // Draw counts per list then group instance counts
+        VulkanBuffer objects;       // Culled transforms, read by the vertex shader
+        VulkanBuffer commands;      // VkDrawIndexedIndirectCommand per group
+        VulkanBuffer lodState;      // LOD each object used last time this frame ran
+        VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+        uint32_t objectCapacity = 0;
+        uint32_t instanceCapacity = 0;
+        uint32_t groupCapacity = 0;
+        uint64_t groupVersion = UINT64_MAX;
+        bool lodStateValid = false;
+        VkBuffer cameraBuffer = VK_NULL_HANDLE;
+    };
+
+    struct PushConstants {
+        uint32_t objectCount;
+        uint32_t groupCount;
+        uint32_t listCount;
+        uint32_t phase;
+        uint32_t compact;
+        float viewportHeight;
+        float lodThreshold;
+        float lodHysteresis;
+    };
+
+    VmaAllocator m_allocator;
+    VkDevice m_device;
+    VkDescriptorPool m_descriptorPool;
+    VkDescriptorSetLayout m_descriptorLayout;
+    VkPipelineLayout m_pipelineLayout;
+    VkPipeline m_pipeline;
+    bool m_multiDrawIndirect;
+    PFN_vkCmdDrawIndexedIndirectCountKHR m_drawIndexedIndirectCount;
+    std::string m_shaderCacheDirectory;
+
+    std::vector<Frame> m_frames;
+    std::vector<CullDrawGroup> m_groups;
+    std::vector<IndirectDrawList> m_lists;
+    std::vector<uint32_t> m_objectGroups;   // Group index per uploaded object
+    uint64_t m_structureVersion;
+    size_t m_sceneObjectCount;
+    uint32_t m_objectCount;
+    uint32_t m_instanceCount;               // Object buffer slots over every group
+
+    bool createPipeline(VkPipelineCache pipelineCache);
+    void rebuildGroups(const std::vector<RenderObject>& objects);
+    bool ensureCapacity(Frame& frame, uint32_t objectCount, uint32_t instanceCount, uint32_t groupCount,
+                        bool& objectBufferChanged);
+    void writeDescriptors(Frame& frame);
+};
+
+}
@@ -0,0 +1,142 @@
+#include "MaterialRegistry.h"
+#include <algorithm>
+#include <iostream>
+
+namespace Plaster {
+
+MaterialRegistry::MaterialRegistry() {
+}
+
+MaterialRegistry::~MaterialRegistry() {
+}
+
+bool MaterialRegistry::create(VmaAllocator allocator, uint32_t frameCount, uint32_t capacity) {
+    if (frameCount > MAX_FRAMES) {
+        std::cerr << "Material registry supports at most " << MAX_FRAMES << " frames in flight!" << std::endl;
+        return false;
+    }
+
+    m_buffers.resize(frameCount);
+    m_dirtySlots.resize(frameCount);
+    for (uint32_t i = 0; i < frameCount; i++) {
+        if (!createBuffer(allocator, i, std::max(capacity, 1u))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void MaterialRegistry::destroy(VmaAllocator allocator) {
+    for (VulkanBuffer& buffer : m_buffers) {
+        buffer.destroy(allocator);
+    }
+    m_buffers.clear();
+    m_dirtySlots.clear();
+    m_dirtyFrames.clear();
+    m_data.clear();
+    m_freeSlots.clear();
+}
+
+bool MaterialRegistry::createBuffer(VmaAllocator allocator, uint32_t frameIndex, uint32_t capacity) {
+    if (!m_buffers[frameIndex].create(allocator, sizeof(PlastibooMaterialData) * capacity,
+                                      VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                      VMA_MEMORY_USAGE_CPU_TO_GPU,
+                                      VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT |
+                                      VMA_ALLOCATION_CREATE_MAPPED_BIT)) {
+        std::cerr << "Failed to create material registry buffer!" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+uint32_t MaterialRegistry::allocate(const PlastibooMaterialData& data) {
+    uint32_t index;
+    if (!m_freeSlots.empty()) {
+        index = m_freeSlots.back();
+        m_freeSlots.pop_back();
+        m_data[index] = data;
+    } else {
+        index = static_cast<uint32_t>(m_data.size());
+        m_data.push_back(data);
+        m_dirtyFrames.push_back(0);
+    }
+
+    markDirty(index);
+    return index;
+}
+
+void MaterialRegistry::release(uint32_t index) {
+    m_freeSlots.push_back(index);
+}
+
+void MaterialRegistry::update(uint32_t index, const PlastibooMaterialData& data) {
+    m_data[index] = data;
+    markDirty(index);
+}
+
+void MaterialRegistry::markDirty(uint32_t index) {
+    // Queue the slot once per frame buffer, however often it changes
+    for (uint32_t frame = 0; frame < m_dirtySlots.size(); frame++) {
+        const uint32_t bit = 1u << frame;
+        if ((m_dirtyFrames[index] & bit) == 0) {
+            m_dirtyFrames[index] |= bit;
+            m_dirtySlots[frame].push_back(index);
+        }
+    }
+}
+
+bool MaterialRegistry::flush(VmaAllocator allocator, uint32_t frameIndex, bool& recreated) {
+    recreated = false;
+
+    VulkanBuffer& buffer = m_buffers[frameIndex];
+    std::vector<uint32_t>& dirty = m_dirtySlots[frameIndex];
+    const uint32_t bit = 1u << frameIndex;
+
+    // A new buffer starts empty, so every slot is copied and the queue dropped
+    if (sizeof(PlastibooMaterialData) * m_data.size() > buffer.getSize()) {
+        uint32_t capacity = static_cast<uint32_t>(buffer.getSize() / sizeof(PlastibooMaterialData));
+        while (capacity < m_data.size()) {
+            capacity *= 2;
+        }
+
+        buffer.destroy(allocator);
+        if (!createBuffer(allocator, frameIndex, capacity)) {
+            return false;
+        }
+        recreated = true;
+
+        auto* data = static_cast<PlastibooMaterialData*>(buffer.getMappedData());
+        std::copy(m_data.begin(), m_data.end(), data);
+        buffer.flush(allocator, 0, sizeof(PlastibooMaterialData) * m_data.size());
+
+        for (uint32_t index : dirty) {
+            m_dirtyFrames[index] &= ~bit;
+        }
+        dirty.clear();
+        return true;
+    }
+
+    if (dirty.empty()) {
+        return true;
+    }
+
+    // Copy and flush each run of consecutive slots as one range
+    std::sort(dirty.begin(), dirty.end());
+    auto* data = static_cast<PlastibooMaterialData*>(buffer.getMappedData());
+    size_t runStart = 0;
+    for (size_t i = 0; i < dirty.size(); i++) {
+        m_dirtyFrames[dirty[i]] &= ~bit;
+        data[dirty[i]] = m_data[dirty[i]];
+
+        if (i + 1 == dirty.size() || dirty[i + 1] != dirty[i] + 1) {
+            buffer.flush(allocator, sizeof(PlastibooMaterialData) * dirty[runStart],
+                         sizeof(PlastibooMaterialData) * (i + 1 - runStart));
+            runStart = i + 1;
+        }
+    }
+
+    dirty.clear();
+    return true;
+}
+
+}
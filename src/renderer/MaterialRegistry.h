@@ -0,0 +1,65 @@
+#pragma once
+
+#include "PlastibooMaterial.h"
+#include "VulkanBuffer.h"
+#include <vulkan/vulkan.h>
+#include <vk_mem_alloc.h>
+#include <cstdint>
+#include <vector>
+
+namespace Plaster {
+
+// Every material's PlastibooMaterialData packed into one storage buffer per
+// frame in flight. Materials own a slot for their lifetime, handed out from a
+// free-list, and the fragment shader reads materials[index] with the index
+// stored in each object's data, so changing material never binds a descriptor
+// set or pushes a constant and a new material costs no allocation of its own.
+//
+// Edits land in a CPU copy and are remembered per frame buffer; flush()
+// copies only the changed slots into that frame's buffer, in contiguous runs,
+// once its fence has signalled.
+class MaterialRegistry {
+public:
+    static constexpr uint32_t INITIAL_CAPACITY = 256;
+    static constexpr uint32_t MAX_FRAMES = 32;  // One dirty bit per frame buffer
+
+    MaterialRegistry();
+    ~MaterialRegistry();
+
+    bool create(VmaAllocator allocator, uint32_t frameCount, uint32_t capacity = INITIAL_CAPACITY);
+    void destroy(VmaAllocator allocator);
+
+    bool isCreated() const { return !m_buffers.empty(); }
+
+    // Take a slot, reusing a released one when available, and fill it with data
+    uint32_t allocate(const PlastibooMaterialData& data);
+
+    // Give the slot back. Frames in flight read their own buffer, which only
+    // sees a reused slot's new data at its next flush(), so reuse is immediate.
+    void release(uint32_t index);
+
+    void update(uint32_t index, const PlastibooMaterialData& data);
+
+    const PlastibooMaterialData& get(uint32_t index) const { return m_data[index]; }
+
+    // Bring the frame's buffer up to date, growing it when the slots outgrew
+    // it. The frame's fence must have signalled. recreated is set when the
+    // buffer changed and its descriptors need rewriting.
+    bool flush(VmaAllocator allocator, uint32_t frameIndex, bool& recreated);
+
+    VkBuffer getBuffer(uint32_t frameIndex) const { return m_buffers[frameIndex].getBuffer(); }
+    uint32_t getSlotCount() const { return static_cast<uint32_t>(m_data.size()); }
+    uint32_t getLiveCount() const { return static_cast<uint32_t>(m_data.size() - m_freeSlots.size()); }
+
+private:
+    std::vector<VulkanBuffer> m_buffers;
+    std::vector<std::vector<uint32_t>> m_dirtySlots;  // Per frame buffer, unordered
+    std::vector<uint32_t> m_dirtyFrames;              // Per slot, bit per frame buffer already queued
+    std::vector<PlastibooMaterialData> m_data;
+    std::vector<uint32_t> m_freeSlots;
+
+    bool createBuffer(VmaAllocator allocator, uint32_t frameIndex, uint32_t capacity);
+    void markDirty(uint32_t index);
+};
+
+}
@@ -1,11 +1,73 @@
 #include "Mesh.h"
-#include <winuser.h>
-#include <iostream
+#include "MeshSimplifier.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/packing.hpp>
+#include <cmath>
+#include <iostream>
+#include <atomic>
+#include <algorithm>
+#include <iterator>
 
 namespace Plaster {
+static std::atomic<uint32_t> s_nextMeshSortId{0};
+
+// Octahedral normal encoding: project onto the octahedron |x|+|y|+|z| = 1 and
+// fold the lower half over the upper, giving two components in [-1, 1]
+static glm::vec2 encodeOctahedral(const glm::vec3& normal) {
+  glm::vec3 n = normal / std::max(std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z), 1e-8f);
+  glm::vec2 encoded(n.x, n.y);
+  if (n.z < 0.0f) {
+    encoded.x = (1.0f - std::abs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f);
+    encoded.y = (1.0f - std::abs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f);
+  }
+  return encoded;
+}
+
+static uint16_t quantizeUnorm16(float value) {
+  return static_cast<uint16_t>(std::lround(glm::clamp(value, 0.0f, 1.0f) * 65535.0f));
+}
+
+static int16_t quantizeSnorm16(float value) {
+  return static_cast<int16_t>(std::lround(glm::clamp(value, -1.0f, 1.0f) * 32767.0f));
+}
+
+static uint8_t quantizeUnorm8(float value) {
+  return static_cast<uint8_t>(std::lround(glm::clamp(value, 0.0f, 1.0f) * 255.0f));
+}
+
+PackedPlastibooVertex PackedPlastibooVertex::pack(const PlastibooVertex& vertex, const glm::vec3& offset,
+                                                  const glm::vec3& invScale) {
+  PackedPlastibooVertex packed{};
+  glm::vec3 position = (vertex.position - offset) * invScale;
+  packed.position[0] = quantizeUnorm16(position.x);
+  packed.position[1] = quantizeUnorm16(position.y);
+  packed.position[2] = quantizeUnorm16(position.z);
+  packed.position[3] = 0;
+
+  glm::vec2 normal = encodeOctahedral(vertex.normal);
+  packed.normal[0] = quantizeSnorm16(normal.x);
+  packed.normal[1] = quantizeSnorm16(normal.y);
+
+  packed.texCoord[0] = glm::packHalf1x16(vertex.texCoord.x);
+  packed.texCoord[1] = glm::packHalf1x16(vertex.texCoord.y);
+
+  packed.color[0] = quantizeUnorm8(vertex.color.r);
+  packed.color[1] = quantizeUnorm8(vertex.color.g);
+  packed.color[2] = quantizeUnorm8(vertex.color.b);
+  packed.color[3] = 255;
+  return packed;
+}
+
 Mesh::Mesh()
-  : m_vertexCount(0)
-  , m_indexCount(0)
+  : m_sortId(s_nextMeshSortId++)
+  , m_lods{}
+  , m_lodCount(0)
+  , m_vertexFormat(VertexFormat::FULL)
+  , m_dequantizeOffset(0.0f)
+  , m_dequantizeScale(1.0f)
+  , m_bounds(glm::vec3(0.0f), glm::vec3(0.0f))
+  , m_boundsCenter(0.0f)
+  , m_boundsRadius(0.0f)
 {
 }
 
@@ -13,146 +75,201 @@ Mesh::~Mesh(){
 }
 
 bool Mesh::create(
-  VmaAllocator allocator,
-  VkDevice device, 
-  VkCommandPool commandPool,
-  VkQueue graphicsQueue,
+  GeometryPool& pool,
+  UploadManager& uploads,
   const std::vector<PlastibooVertex>& vertices,
-  const std::vector<uint32_t>& indices
+  const std::vector<uint32_t>& indices,
+  const MeshLodSettings& lodSettings,
+  const MeshOptimizeSettings& optimizeSettings,
+  VertexFormat format
 ) {
-  m_vertexCount = vertices.size();
-  m_indexCount = indices.size();
+  if (pool.getVertexStride() != getVertexStride(format)) {
+    std::cerr << "Geometry pool does not hold the mesh's vertex format" << std::endl;
+    return false;
+  }
+  m_vertexFormat = format;
 
-  VkDeviceSize vertexBufferSize = sizeof(PlastibooVertex) * vertices.size();
+  // Sphere around the AABB centre; loose, but cheap and stable under rotation
+  if (!vertices.empty()) {
+    m_bounds = BoundingBox();
+    for (const auto& vertex : vertices) {
+      m_bounds.expand(vertex.position);
+    }
+    m_boundsCenter = m_bounds.getCenter();
+    m_boundsRadius = 0.0f;
+    for (const auto& vertex : vertices) {
+      m_boundsRadius = std::max(m_boundsRadius, glm::length(vertex.position - m_boundsCenter));
+    }
+  }
 
-  if (!createBufferWithStaging(
-    allocator, device, commandPool, graphicsQueue,
-    VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-    vertices.data(), vertexBufferSize, m_vertexBuffer
-  )) {
-    std::cerr << "Failed to create vertex buffer" << std::endl;
-    return false;
+  std::vector<glm::vec3> positions(vertices.size());
+  for (size_t i = 0; i < vertices.size(); i++) {
+    positions[i] = vertices[i].position;
   }
 
-  VkDeviceSize indexBufferSize = sizeof(uint32_t) * indices.size();
-  if (!createBufferWithStaging(
-    allocator, device, commandPool, graphicsQueue,
-    VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
-    indices.data(), indexBufferSize, m_indexBuffer 
-  )) {
-    std::cerr << "Failed to create index buffer" << std::endl;
-    return false;
+  // LOD chain: each level is simplified from the one before
+  std::vector<uint32_t> lodIndices[MAX_LODS];
+  float lodErrors[MAX_LODS] = {0.0f};
+  lodIndices[0] = indices;
+  m_lodCount = 1;
+
+  if (lodSettings.maxLods > 1 && indices.size() >= 3) {
+    const uint32_t maxLods = std::min(lodSettings.maxLods, MAX_LODS);
+    const float maxError = lodSettings.maxError * m_boundsRadius;
+    while (m_lodCount < maxLods) {
+      const std::vector<uint32_t>& source = lodIndices[m_lodCount - 1];
+      size_t target = static_cast<size_t>(source.size() / 3 * lodSettings.reduction) * 3;
+      std::vector<uint32_t> simplified;
+      float error = MeshSimplifier::simplify(positions, source, target, maxError, simplified);
+
+      // Not worth a level when it barely removes anything
+      if (simplified.empty() || simplified.size() > source.size() * 9 / 10) {
+        break;
+      }
+
+      lodErrors[m_lodCount] = std::max(error, lodErrors[m_lodCount - 1]);
+      lodIndices[m_lodCount].swap(simplified);
+      m_lodCount++;
+    }
   }
 
-  std::cout << "Mesh created: " << m_vertexCount << " vertices, "
-    << m_indexCount << "indices" << std::endl;
+  // Every level is ordered for the post-transform cache and then for
+  // overdraw on its own, since each is drawn on its own
+  m_cacheStatsBefore = MeshOptimizer::analyzeVertexCache(indices, vertices.size());
+  for (uint32_t lod = 0; lod < m_lodCount; lod++) {
+    if (optimizeSettings.vertexCache) {
+      MeshOptimizer::optimizeVertexCache(lodIndices[lod], vertices.size());
+    }
+    if (optimizeSettings.overdraw && optimizeSettings.vertexCache) {
+      MeshOptimizer::optimizeOverdraw(lodIndices[lod], positions, optimizeSettings.overdrawThreshold);
+    }
+  }
 
-  return true;
-}
+  // All levels are appended to a single index list, so they share one pool
+  // range and one upload
+  std::vector<uint32_t> allIndices;
+  uint32_t lodOffsets[MAX_LODS] = {0};
+  for (uint32_t lod = 0; lod < m_lodCount; lod++) {
+    lodOffsets[lod] = static_cast<uint32_t>(allIndices.size());
+    allIndices.insert(allIndices.end(), lodIndices[lod].begin(), lodIndices[lod].end());
+  }
 
-void Mesh::destroy(VmaAllocator allocator) {
-  m_vertexBuffer.destroy(allocator);
-  m_indexBuffer.destroy(allocator);
-  m_vertexCount = 0;
-  m_indexCount = 0;
-}
+  // Renumber vertices in first-use order, LOD 0 first, so fetches stream
+  // forwards through the vertex buffer
+  const std::vector<PlastibooVertex>* uploadVertices = &vertices;
+  std::vector<PlastibooVertex> remappedVertices;
+  if (optimizeSettings.vertexFetch && !allIndices.empty()) {
+    std::vector<uint32_t> remap;
+    size_t vertexCount = MeshOptimizer::buildVertexFetchRemap(allIndices, vertices.size(), remap);
+    MeshOptimizer::remapIndices(allIndices, remap);
+    remappedVertices = vertices;
+    MeshOptimizer::remapVertices(remappedVertices, remap, vertexCount);
+    uploadVertices = &remappedVertices;
+  }
 
-void Mesh::bind(VkCommandBuffer commandBuffer) {
-  VkBuffer vertexBuffer[] = { m_vertexBuffer.getBuffer() };
-  VkDeviceSize offsets[] = { 0 };
+  m_cacheStatsAfter = MeshOptimizer::analyzeVertexCache(
+    std::vector<uint32_t>(allIndices.begin(), allIndices.begin() + lodIndices[0].size()), uploadVertices->size());
 
-  vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
-  
-  vkCmdBindIndexBuffer(commandBuffer, m_indexBuffer.getBuffer(), 0, VK_INDEX_TYPE_UINT32);
-}
+  // Packed positions span the bounding box; flat axes keep a unit scale so
+  // the inverse stays finite
+  m_dequantizeOffset = glm::vec3(0.0f);
+  m_dequantizeScale = glm::vec3(1.0f);
+  std::vector<PackedPlastibooVertex> packedVertices;
+  const void* vertexData = uploadVertices->data();
+  if (format == VertexFormat::PACKED) {
+    m_dequantizeOffset = m_bounds.min;
+    glm::vec3 size = m_bounds.max - m_bounds.min;
+    for (int axis = 0; axis < 3; axis++) {
+      m_dequantizeScale[axis] = size[axis] > 0.0f ? size[axis] : 1.0f;
+    }
 
-void Mesh::draw(VkCommandBuffer commandBuffer) {
-  vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(m_indexCount), 1, 0, 0, 0);
-}
+    glm::vec3 invScale = 1.0f / m_dequantizeScale;
+    packedVertices.reserve(uploadVertices->size());
+    for (const PlastibooVertex& vertex : *uploadVertices) {
+      packedVertices.push_back(PackedPlastibooVertex::pack(vertex, m_dequantizeOffset, invScale));
+    }
+    vertexData = packedVertices.data();
+  }
 
-bool Mesh::createBufferWithStaging(
-  VmaAllocator allocator,
-  VkDevice device,
-  VkCommandPool commandPool,
-  VkQueue graphicsQueue,
-  VkBufferUsageFlags usage,
-  const void* data,
-  VkDeviceSize size,
-  VulkanBuffer& buffer 
-) {
-  VulkanBuffer stagingBuffer;
-  if (!stagingBuffer.create(
-    allocator,
-    size,
-    VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-    VMA_MEMORY_USAGE_CPU_ONLY,
-    VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT
-  )) {
+  // Every index fits in 16 bits when there are at most 65536 vertices, which
+  // halves index memory and fetch bandwidth for nearly every prop
+  const VkIndexType indexType = uploadVertices->size() <= 65536 ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+  std::vector<uint16_t> indices16;
+  const void* indexData = allIndices.data();
+  if (indexType == VK_INDEX_TYPE_UINT16) {
+    indices16.assign(allIndices.begin(), allIndices.end());
+    indexData = indices16.data();
+  }
+
+  if (!pool.allocate(static_cast<uint32_t>(uploadVertices->size()), static_cast<uint32_t>(allIndices.size()), m_range, indexType)) {
+    std::cerr << "Failed to allocate mesh geometry" << std::endl;
+    m_lodCount = 0;
     return false;
   }
 
-  stagingBuffer.copyData(allocator, data, size);
-  
+  for (uint32_t lod = 0; lod < m_lodCount; lod++) {
+    m_lods[lod] = {m_range.firstIndex + lodOffsets[lod], static_cast<uint32_t>(lodIndices[lod].size()), lodErrors[lod]};
+  }
 
-  if (!buffer.create(
-    allocator,
-    size, 
-    usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-    VMA_MEMORY_USAGE_GPU_ONLY,
-    0
-  )) {
-    stagingBuffer.destroy(allocator);
+  std::optional<UploadHandle> upload = pool.upload(uploads, m_range, vertexData, indexData);
+  if (!upload) {
+    std::cerr << "Failed to queue mesh upload" << std::endl;
+    pool.free(m_range);
     return false;
   }
+  m_upload = *upload;
 
-  copyBuffer(device, commandPool, graphicsQueue, stagingBuffer.getBuffer(), buffer.getBuffer(), size);
-
-  stagingBuffer.destroy(allocator);
+  std::cout << "Mesh created: " << m_range.vertexCount
+    << (format == VertexFormat::PACKED ? " packed" : "") << " vertices, "
+    << indices.size() << (indexType == VK_INDEX_TYPE_UINT16 ? " 16-bit" : " 32-bit") << " indices, "
+    << m_lodCount << " LODs, ACMR "
+    << m_cacheStatsBefore.acmr << " -> " << m_cacheStatsAfter.acmr << ", ATVR "
+    << m_cacheStatsBefore.atvr << " -> " << m_cacheStatsAfter.atvr << std::endl;
 
   return true;
 }
 
-void Mesh::copyBuffer(
-  VkDevice device,
-  VkCommandPool commandPool,
-  VkQueue graphicsQueue,
-  VkBuffer srcBuffer,
-  VkBuffer dstBuffer,
-  VkDeviceSize size 
-) {
-  VkCommandBufferAllocateInfo allocInfo{};
-  allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-  allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-  allocInfo.commandPool = commandPool;
-  allocInfo.commandBufferCount= 1;
-
-  VkCommandBuffer commandBuffer;
-  vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer);
-
-  VkCommandBufferBeginInfo beginInfo{};
-  beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-  beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-  
-  vkBeginCommandBuffer(commandBuffer, &beginInfo);
-  
-  VkBufferCopy copyRegion{};
-  copyRegion.srcOffset = 0;
-  copyRegion.dstOffset = 0;
-  copyRegion.size = size;
-
-  vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
-  vkEndCommandBuffer(commandBuffer);
-
-  VkSubmitInfo submitInfo{};
-  submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-  submitInfo.commandBufferCount = 1;
-  submitInfo.pCommandBuffers = &commandBuffer;
-
-  vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
-  vkQueueWaitIdle(graphicsQueue);
-  
-  vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
+void Mesh::destroy(GeometryPool& pool) {
+  pool.free(m_range);
+  m_upload = UploadHandle{};
+  m_lodCount = 0;
 
+  // Empty levels, so anything still reading LOD 0 draws nothing from freed space
+  std::fill(std::begin(m_lods), std::end(m_lods), MeshLod{});
+}
+
+void Mesh::draw(VkCommandBuffer commandBuffer, uint32_t instanceCount, uint32_t firstInstance, uint32_t lod) {
+  // Destroyed, or create() failed
+  if (m_lodCount == 0) {
+    return;
+  }
+
+  const MeshLod& level = m_lods[std::min(lod, m_lodCount - 1)];
+  vkCmdDrawIndexed(commandBuffer, level.indexCount, instanceCount, level.firstIndex,
+                   static_cast<int32_t>(m_range.vertexOffset), firstInstance);
+}
+
+glm::mat4 Mesh::getDequantizeMatrix() const {
+  glm::mat4 dequantize = glm::translate(glm::mat4(1.0f), m_dequantizeOffset);
+  return glm::scale(dequantize, m_dequantizeScale);
+}
+
+uint32_t Mesh::selectLod(float pixelsPerUnit, uint32_t currentLod, const LodSelection& selection) const {
+  if (m_lodCount <= 1) {
+    return 0;
+  }
+
+  const float refine = selection.thresholdPixels * (1.0f + selection.hysteresis);
+  const float coarsen = selection.thresholdPixels * (1.0f - selection.hysteresis);
+
+  uint32_t lod = std::min(currentLod, m_lodCount - 1);
+  while (lod > 0 && m_lods[lod].error * pixelsPerUnit > refine) {
+    lod--;
+  }
+  while (lod + 1 < m_lodCount && m_lods[lod + 1].error * pixelsPerUnit < coarsen) {
+    lod++;
+  }
+  return lod;
 }
 
 }
@@ -1,7 +1,11 @@
 #pragma once
-#include "VulkanBuffer.h"
+#include "GeometryPool.h"
+#include "UploadManager.h"
+#include "MeshOptimizer.h"
+#include "../math/BoundingBox.h"
 #include <glm/glm.hpp>
-#include <ppltasks.h>
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 #include <vulkan/vulkan.h>
 #include <vk_mem_alloc.h>
@@ -22,8 +26,8 @@ struct PlastibooVertex {
     return bindingDescription;
   }
 
-  static std::vector<VkVertexInputBindingDescription> getAttributeDescriptions() {
-    std::vector<VkVertexInputBindingDescription> attributeDescriptions(4);
+  static std::vector<VkVertexInputAttributeDescription> getAttributeDescriptions() {
+    std::vector<VkVertexInputAttributeDescription> attributeDescriptions(4);
 
     attributeDescriptions[0].binding = 0;
     attributeDescriptions[0].location = 0;
@@ -37,11 +41,11 @@ struct PlastibooVertex {
 
     attributeDescriptions[2].binding = 0;
     attributeDescriptions[2].location = 2;
-    attributeDescriptions[2].format = VK_FORMAT_R32G32B32_SFLOAT;
+    attributeDescriptions[2].format = VK_FORMAT_R32G32_SFLOAT;
     attributeDescriptions[2].offset = offsetof(PlastibooVertex, texCoord);
 
     attributeDescriptions[3].binding = 0;
-    attributeDescription[3].location = 3;
+    attributeDescriptions[3].location = 3;
     attributeDescriptions[3].format = VK_FORMAT_R32G32B32_SFLOAT;
     attributeDescriptions[3].offset = offsetof(PlastibooVertex, color);
     
@@ -49,54 +53,177 @@ struct PlastibooVertex {
   }
 };
 
+// Compact layout, 20 bytes against PlastibooVertex's 44. Positions are 16-bit
+// unorm within the mesh's bounding box and dequantised by folding the box into
+// the model matrix; normals are octahedral snorm16, UVs half floats and the
+// colour RGBA8. Selected per mesh at create().
+struct PackedPlastibooVertex {
+  uint16_t position[4];   // xyz unorm16, w unused
+  int16_t normal[2];      // Octahedral, snorm16
+  uint16_t texCoord[2];   // Half float
+  uint8_t color[4];       // RGBA8 unorm, alpha unused
+
+  static PackedPlastibooVertex pack(const PlastibooVertex& vertex, const glm::vec3& offset, const glm::vec3& invScale);
+
+  static VkVertexInputBindingDescription getBindingDescription() {
+    VkVertexInputBindingDescription bindingDescription{};
+    bindingDescription.binding = 0;
+    bindingDescription.stride = sizeof(PackedPlastibooVertex);
+    bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+    return bindingDescription;
+  }
+
+  static std::vector<VkVertexInputAttributeDescription> getAttributeDescriptions() {
+    std::vector<VkVertexInputAttributeDescription> attributeDescriptions(4);
+
+    attributeDescriptions[0].binding = 0;
+    attributeDescriptions[0].location = 0;
+    attributeDescriptions[0].format = VK_FORMAT_R16G16B16A16_UNORM;
+    attributeDescriptions[0].offset = offsetof(PackedPlastibooVertex, position);
+
+    attributeDescriptions[1].binding = 0;
+    attributeDescriptions[1].location = 1;
+    attributeDescriptions[1].format = VK_FORMAT_R16G16_SNORM;
+    attributeDescriptions[1].offset = offsetof(PackedPlastibooVertex, normal);
+
+    attributeDescriptions[2].binding = 0;
+    attributeDescriptions[2].location = 2;
+    attributeDescriptions[2].format = VK_FORMAT_R16G16_SFLOAT;
+    attributeDescriptions[2].offset = offsetof(PackedPlastibooVertex, texCoord);
+
+    attributeDescriptions[3].binding = 0;
+    attributeDescriptions[3].location = 3;
+    attributeDescriptions[3].format = VK_FORMAT_R8G8B8A8_UNORM;
+    attributeDescriptions[3].offset = offsetof(PackedPlastibooVertex, color);
+
+    return attributeDescriptions;
+  }
+};
+
+// Vertex layout of a mesh; each has its own geometry pool and pipeline, and
+// the value doubles as the render queue's pipeline id
+enum class VertexFormat : uint32_t {
+  FULL = 0,
+  PACKED = 1
+};
+
+static constexpr uint32_t VERTEX_FORMAT_COUNT = 2;
+
+inline uint32_t getVertexStride(VertexFormat format) {
+  return format == VertexFormat::PACKED ? sizeof(PackedPlastibooVertex) : sizeof(PlastibooVertex);
+}
+
+// One level of detail: an index range into the mesh's vertices and the
+// geometric error of the simplification, in mesh units
+struct MeshLod {
+  uint32_t firstIndex;  // Absolute, in the geometry pool's index buffer
+  uint32_t indexCount;
+  float error;
+};
+
+// How LOD chains are generated when a mesh is created. Each level targets
+// reduction times the previous level's triangles; generation stops early once
+// the simplifier cannot make meaningful progress or would exceed maxError
+// (a fraction of the bounding radius). maxLods = 1 disables LOD.
+struct MeshLodSettings {
+  uint32_t maxLods = 4;
+  float reduction = 0.5f;
+  float maxError = 0.25f;
+};
+
+// Runtime LOD choice: the coarsest level whose error projects to at most
+// thresholdPixels at the internal resolution. A level is only dropped below
+// (1 - hysteresis) and only kept up to (1 + hysteresis) times the threshold,
+// so objects near a switch distance do not flicker between levels.
+struct LodSelection {
+  float thresholdPixels = 1.0f;
+  float hysteresis = 0.25f;
+};
+
 class Mesh {
 public:
+  static constexpr uint32_t MAX_LODS = 4;
+
   Mesh();
   ~Mesh();
 
+  // Reserves a range in the geometry pool and queues the vertex and index
+  // copies on the upload manager; the mesh can be drawn by any frame
+  // submitted after the next flush
+  // LOD chains are simplified from the indices here, at import time, and
+  // share the pool range with LOD 0. Every level is then reordered for the
+  // vertex cache and overdraw, and vertices are renumbered for fetch locality.
+  // The pool must hold vertices of the given format.
   bool create(
-    VmaAllocator allocator,
-    VkDevice device,
-    VkCommandPool commandPool,
-    VkQueue graphicsQueue,
+    GeometryPool& pool,
+    UploadManager& uploads,
     const std::vector<PlastibooVertex>& vertices,
-    const std::vector<uint32_t>& indices
+    const std::vector<uint32_t>& indices,
+    const MeshLodSettings& lodSettings = MeshLodSettings(),
+    const MeshOptimizeSettings& optimizeSettings = MeshOptimizeSettings(),
+    VertexFormat format = VertexFormat::FULL
   );
 
-  void destroy(VmaAllocator allocator);
+  void destroy(GeometryPool& pool);
 
-  void bind(VkCommandBuffer commandBuffer);
-  
-  void draw(VkCommandBuffer commandBuffer);
+  // The pool must already be bound with getIndexType(); firstInstance selects
+  // the object's slot in the per-frame transform buffer
+  void draw(VkCommandBuffer commandBuffer, uint32_t instanceCount = 1, uint32_t firstInstance = 0, uint32_t lod = 0);
 
-  size_t getVertexCount() const { return m_vertexCount; }
-  size_t getIndexCount() const { return m_indexCount; }
+  size_t getVertexCount() const { return m_range.vertexCount; }
+  size_t getIndexCount() const { return m_lodCount > 0 ? m_lods[0].indexCount : 0; }
+  const GeometryRange& getRange() const { return m_range; }
 
-private:
-  VulkanBuffer m_vertexBuffer;
-  VulkanBuffer m_indexBuffer;
-  size_t m_vertexCount;
-  size_t m_indexCount;
-
-  bool createBufferWithStaging(
-    VmaAllocator allocator,
-    VkDevice device,
-    VkCommandPool commandPool,
-    VkQueue graphicsQueue,
-    VkBufferUsageFlags usage,
-    const void* data,
-    VkDeviceSize size,
-    VulkanBuffer& buffer 
-  );
+  // 16-bit when every vertex is addressable with one, chosen at create();
+  // the geometry pool must be bound with this type before draw()
+  VkIndexType getIndexType() const { return m_range.indexType; }
 
-  void copyBuffer(
-    VkDevice device,
-    VkCommandPool commandPool,
-    VkQueue graphicsQueue,
-    VkBuffer srcBuffer,
-    VkBuffer dstBuffer,
-    VkDeviceSize size 
-  );
+  VertexFormat getVertexFormat() const { return m_vertexFormat; }
+
+  // Maps stored positions to mesh units: identity for FULL, the quantisation
+  // box for PACKED. Applied on the right of the model matrix.
+  const glm::vec3& getDequantizeOffset() const { return m_dequantizeOffset; }
+  const glm::vec3& getDequantizeScale() const { return m_dequantizeScale; }
+  glm::mat4 getDequantizeMatrix() const;
+
+  uint32_t getLodCount() const { return m_lodCount; }
+  const MeshLod& getLod(uint32_t lod) const { return m_lods[lod]; }
+
+  // Pick a level for an object covering pixelsPerUnit screen pixels per mesh
+  // unit, starting from the level it used last frame
+  uint32_t selectLod(float pixelsPerUnit, uint32_t currentLod, const LodSelection& selection) const;
+
+  // Local-space bounds computed at create(): the AABB for CPU culling and a
+  // sphere around its centre for the GPU cull pass
+  const BoundingBox& getBounds() const { return m_bounds; }
+  const glm::vec3& getBoundsCenter() const { return m_boundsCenter; }
+  float getBoundsRadius() const { return m_boundsRadius; }
+
+  // True once both buffers have finished uploading
+  bool isResident(const UploadManager& uploads) const { return uploads.isComplete(m_upload); }
+  UploadHandle getUploadHandle() const { return m_upload; }
+
+  // LOD 0's simulated vertex cache efficiency as passed in and as uploaded
+  const VertexCacheStats& getCacheStatsBefore() const { return m_cacheStatsBefore; }
+  const VertexCacheStats& getCacheStatsAfter() const { return m_cacheStatsAfter; }
+
+  // Small per-process id used to order draws in the render queue
+  uint32_t getSortId() const { return m_sortId; }
+
+private:
+  uint32_t m_sortId;
+  GeometryRange m_range;
+  MeshLod m_lods[MAX_LODS];
+  uint32_t m_lodCount;
+  VertexFormat m_vertexFormat;
+  glm::vec3 m_dequantizeOffset;
+  glm::vec3 m_dequantizeScale;
+  UploadHandle m_upload;
+  BoundingBox m_bounds;
+  glm::vec3 m_boundsCenter;
+  float m_boundsRadius;
+  VertexCacheStats m_cacheStatsBefore;
+  VertexCacheStats m_cacheStatsAfter;
 };
 
 }
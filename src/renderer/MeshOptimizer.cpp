@@ -0,0 +1,304 @@
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Plaster {
+namespace MeshOptimizer {
+
+namespace {
+
+// Forsyth's scoring constants, from "Linear-Speed Vertex Cache Optimisation"
+const int FORSYTH_CACHE_SIZE = 32;
+const float CACHE_DECAY_POWER = 1.5f;
+const float LAST_TRIANGLE_SCORE = 0.75f;
+const float VALENCE_BOOST_SCALE = 2.0f;
+const float VALENCE_BOOST_POWER = 0.5f;
+
+float vertexScore(int cachePosition, uint32_t remainingTriangles) {
+    if (remainingTriangles == 0) {
+        return -1.0f;
+    }
+
+    float score = 0.0f;
+    if (cachePosition >= 0) {
+        if (cachePosition < 3) {
+            // The last triangle's vertices get a fixed score so the next
+            // triangle does not simply reuse the same edge
+            score = LAST_TRIANGLE_SCORE;
+        } else {
+            float scaler = 1.0f / (FORSYTH_CACHE_SIZE - 3);
+            score = std::pow(1.0f - (cachePosition - 3) * scaler, CACHE_DECAY_POWER);
+        }
+    }
+
+    // Favour vertices with few triangles left so they finish and leave the cache
+    score += VALENCE_BOOST_SCALE * std::pow(static_cast<float>(remainingTriangles), -VALENCE_BOOST_POWER);
+    return score;
+}
+
+// Number of cache misses for one triangle on a FIFO cache
+uint32_t simulateTriangle(const uint32_t* triangle, std::vector<uint32_t>& timestamps,
+                          uint32_t& time, uint32_t cacheSize) {
+    uint32_t misses = 0;
+    for (int c = 0; c < 3; c++) {
+        uint32_t v = triangle[c];
+        if (time - timestamps[v] > cacheSize) {
+            timestamps[v] = time++;
+            misses++;
+        }
+    }
+    return misses;
+}
+
+}
+
+void optimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount) {
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0 || vertexCount == 0) {
+        return;
+    }
+
+    // Triangles around each vertex, in CSR form; the first remaining[v]
+    // entries of a vertex's range are its triangles not yet emitted
+    std::vector<uint32_t> remaining(vertexCount, 0);
+    for (size_t i = 0; i < triangleCount * 3; i++) {
+        remaining[indices[i]]++;
+    }
+    std::vector<uint32_t> offsets(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; v++) {
+        offsets[v + 1] = offsets[v] + remaining[v];
+    }
+    std::vector<uint32_t> adjacency(triangleCount * 3);
+    {
+        std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < triangleCount * 3; i++) {
+            adjacency[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+    }
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> scores(vertexCount);
+    for (size_t v = 0; v < vertexCount; v++) {
+        scores[v] = vertexScore(-1, remaining[v]);
+    }
+
+    std::vector<uint8_t> emitted(triangleCount, 0);
+    std::vector<uint32_t> result;
+    result.reserve(triangleCount * 3);
+
+    std::vector<uint32_t> cache;
+    std::vector<uint32_t> nextCache;
+    cache.reserve(FORSYTH_CACHE_SIZE + 3);
+    nextCache.reserve(FORSYTH_CACHE_SIZE + 3);
+
+    size_t fallbackCursor = 0;
+    int64_t best = -1;
+    for (size_t emittedCount = 0; emittedCount < triangleCount; emittedCount++) {
+        // Nothing in the cache has triangles left: restart at the next
+        // triangle in input order, which keeps the original locality
+        if (best < 0) {
+            while (emitted[fallbackCursor]) {
+                fallbackCursor++;
+            }
+            best = static_cast<int64_t>(fallbackCursor);
+        }
+
+        const uint32_t* triangle = &indices[static_cast<size_t>(best) * 3];
+        result.insert(result.end(), triangle, triangle + 3);
+        emitted[best] = 1;
+
+        // Drop the triangle from its vertices' remaining lists
+        for (int c = 0; c < 3; c++) {
+            uint32_t v = triangle[c];
+            uint32_t* begin = &adjacency[offsets[v]];
+            uint32_t* end = begin + remaining[v];
+            uint32_t* found = std::find(begin, end, static_cast<uint32_t>(best));
+            std::swap(*found, *(end - 1));
+            remaining[v]--;
+        }
+
+        // New LRU order: this triangle's vertices, then the rest of the cache
+        nextCache.assign(triangle, triangle + 3);
+        for (uint32_t v : cache) {
+            if (v != triangle[0] && v != triangle[1] && v != triangle[2]) {
+                nextCache.push_back(v);
+            }
+        }
+
+        // Rescore every vertex whose position changed, including the ones
+        // that just fell out, then their triangles
+        for (size_t i = 0; i < nextCache.size(); i++) {
+            uint32_t v = nextCache[i];
+            cachePosition[v] = i < static_cast<size_t>(FORSYTH_CACHE_SIZE) ? static_cast<int>(i) : -1;
+            scores[v] = vertexScore(cachePosition[v], remaining[v]);
+        }
+
+        best = -1;
+        float bestScore = -1.0f;
+        for (uint32_t v : nextCache) {
+            for (uint32_t a = offsets[v]; a < offsets[v] + remaining[v]; a++) {
+                uint32_t t = adjacency[a];
+                float score = scores[indices[t * 3]] + scores[indices[t * 3 + 1]] + scores[indices[t * 3 + 2]];
+                if (score > bestScore) {
+                    bestScore = score;
+                    best = t;
+                }
+            }
+        }
+
+        if (nextCache.size() > static_cast<size_t>(FORSYTH_CACHE_SIZE)) {
+            nextCache.resize(FORSYTH_CACHE_SIZE);
+        }
+        cache.swap(nextCache);
+    }
+
+    std::copy(result.begin(), result.end(), indices.begin());
+}
+
+void optimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<glm::vec3>& positions, float threshold) {
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0 || positions.empty()) {
+        return;
+    }
+
+    const uint32_t cacheSize = ANALYZE_CACHE_SIZE;
+    std::vector<uint32_t> timestamps(positions.size(), 0);
+    uint32_t time = cacheSize + 1;
+
+    // Hard boundaries: triangles where the cache-optimised order restarted
+    // with three misses, so moving the cluster costs nothing
+    std::vector<uint32_t> hardClusters;
+    std::vector<uint32_t> triangleMisses(triangleCount);
+    for (size_t t = 0; t < triangleCount; t++) {
+        triangleMisses[t] = simulateTriangle(&indices[t * 3], timestamps, time, cacheSize);
+        if (t == 0 || triangleMisses[t] == 3) {
+            hardClusters.push_back(static_cast<uint32_t>(t));
+        }
+    }
+    hardClusters.push_back(static_cast<uint32_t>(triangleCount));
+
+    // Soft boundaries: split a hard cluster wherever its running ACMR, with
+    // the cache flushed at the previous split, stays within threshold
+    std::vector<uint32_t> clusters;
+    for (size_t h = 0; h + 1 < hardClusters.size(); h++) {
+        const uint32_t begin = hardClusters[h];
+        const uint32_t end = hardClusters[h + 1];
+
+        uint32_t clusterMisses = 0;
+        for (uint32_t t = begin; t < end; t++) {
+            clusterMisses += triangleMisses[t];
+        }
+        const float limit = threshold * static_cast<float>(clusterMisses) / static_cast<float>(end - begin);
+
+        clusters.push_back(begin);
+        time += cacheSize + 1;
+        uint32_t start = begin;
+        uint32_t misses = 0;
+        for (uint32_t t = begin; t < end; t++) {
+            misses += simulateTriangle(&indices[t * 3], timestamps, time, cacheSize);
+            float acmr = static_cast<float>(misses) / static_cast<float>(t + 1 - start);
+            if (t + 1 < end && acmr <= limit) {
+                clusters.push_back(t + 1);
+                time += cacheSize + 1;
+                start = t + 1;
+                misses = 0;
+            }
+        }
+    }
+    clusters.push_back(static_cast<uint32_t>(triangleCount));
+
+    // Sort key: how far the cluster faces out from the mesh centre. Clusters
+    // on the outside facing away from the middle tend to occlude the rest.
+    glm::vec3 meshCentroid(0.0f);
+    for (uint32_t index : indices) {
+        meshCentroid += positions[index];
+    }
+    meshCentroid /= static_cast<float>(indices.size());
+
+    struct Cluster {
+        uint32_t begin;
+        uint32_t end;
+        float sortKey;
+    };
+    std::vector<Cluster> sorted;
+    sorted.reserve(clusters.size() - 1);
+    for (size_t c = 0; c + 1 < clusters.size(); c++) {
+        glm::vec3 centroid(0.0f);
+        glm::vec3 normal(0.0f);
+        float area = 0.0f;
+        for (uint32_t t = clusters[c]; t < clusters[c + 1]; t++) {
+            const glm::vec3& p0 = positions[indices[t * 3]];
+            const glm::vec3& p1 = positions[indices[t * 3 + 1]];
+            const glm::vec3& p2 = positions[indices[t * 3 + 2]];
+            glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+            float triangleArea = glm::length(n);
+            centroid += (p0 + p1 + p2) * (triangleArea / 3.0f);
+            normal += n;
+            area += triangleArea;
+        }
+
+        float sortKey = 0.0f;
+        float normalLength = glm::length(normal);
+        if (area > 0.0f && normalLength > 0.0f) {
+            sortKey = glm::dot(centroid / area - meshCentroid, normal / normalLength);
+        }
+        sorted.push_back({clusters[c], clusters[c + 1], sortKey});
+    }
+
+    std::stable_sort(sorted.begin(), sorted.end(), [](const Cluster& a, const Cluster& b) {
+        return a.sortKey > b.sortKey;
+    });
+
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+    for (const Cluster& cluster : sorted) {
+        result.insert(result.end(), indices.begin() + cluster.begin * 3, indices.begin() + cluster.end * 3);
+    }
+    std::copy(result.begin(), result.end(), indices.begin());
+}
+
+size_t buildVertexFetchRemap(const std::vector<uint32_t>& indices, size_t vertexCount, std::vector<uint32_t>& remap) {
+    remap.assign(vertexCount, UINT32_MAX);
+    uint32_t next = 0;
+    for (uint32_t index : indices) {
+        if (remap[index] == UINT32_MAX) {
+            remap[index] = next++;
+        }
+    }
+    return next;
+}
+
+void remapIndices(std::vector<uint32_t>& indices, const std::vector<uint32_t>& remap) {
+    for (uint32_t& index : indices) {
+        index = remap[index];
+    }
+}
+
+VertexCacheStats analyzeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize) {
+    VertexCacheStats stats;
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0 || vertexCount == 0) {
+        return stats;
+    }
+
+    std::vector<uint32_t> timestamps(vertexCount, 0);
+    std::vector<uint8_t> used(vertexCount, 0);
+    uint32_t time = cacheSize + 1;
+    uint32_t misses = 0;
+    size_t uniqueVertices = 0;
+    for (size_t t = 0; t < triangleCount; t++) {
+        misses += simulateTriangle(&indices[t * 3], timestamps, time, cacheSize);
+        for (int c = 0; c < 3; c++) {
+            uint32_t v = indices[t * 3 + c];
+            uniqueVertices += used[v] ? 0 : 1;
+            used[v] = 1;
+        }
+    }
+
+    stats.acmr = static_cast<float>(misses) / static_cast<float>(triangleCount);
+    stats.atvr = static_cast<float>(misses) / static_cast<float>(uniqueVertices);
+    return stats;
+}
+
+}
+}
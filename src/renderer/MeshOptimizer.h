@@ -0,0 +1,68 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Plaster {
+
+// Which optimisation steps Mesh::create runs, in this order, on every LOD
+struct MeshOptimizeSettings {
+    bool vertexCache = true;
+    bool overdraw = true;
+    bool vertexFetch = true;
+
+    // How much worse than the cache-optimised order the overdraw pass may
+    // make ACMR, e.g. 1.05 allows 5%
+    float overdrawThreshold = 1.05f;
+};
+
+// Post-transform cache efficiency of an index list, simulated on a FIFO
+// cache. ACMR is vertex shader runs per triangle (0.5 is ideal for large
+// grids, 3 is no reuse at all); ATVR is runs per unique vertex (1 is ideal).
+struct VertexCacheStats {
+    float acmr = 0.0f;
+    float atvr = 0.0f;
+};
+
+namespace MeshOptimizer {
+
+// FIFO size used for analysis and the overdraw pass; small enough to be
+// conservative on current GPUs
+static constexpr uint32_t ANALYZE_CACHE_SIZE = 16;
+
+// Reorder triangles for post-transform cache hits using Forsyth's linear-speed
+// algorithm: triangles are scored by how recently their vertices were used
+// and how few triangles those vertices have left, and the best one in the
+// cache is emitted next.
+void optimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount);
+
+// Reorder clusters of a cache-optimised index list so triangles facing away
+// from the mesh centre draw first and occlude the rest (Sander et al. 2007).
+// Clusters are split at points that keep ACMR within threshold of the input.
+void optimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<glm::vec3>& positions, float threshold);
+
+// Build a remap that renumbers vertices in order of first use across indices,
+// so vertex fetches walk memory forwards. Unreferenced vertices map to
+// UINT32_MAX and are dropped. Returns the new vertex count.
+size_t buildVertexFetchRemap(const std::vector<uint32_t>& indices, size_t vertexCount, std::vector<uint32_t>& remap);
+
+void remapIndices(std::vector<uint32_t>& indices, const std::vector<uint32_t>& remap);
+
+template<typename Vertex>
+void remapVertices(std::vector<Vertex>& vertices, const std::vector<uint32_t>& remap, size_t newVertexCount) {
+    std::vector<Vertex> remapped(newVertexCount);
+    for (size_t v = 0; v < vertices.size(); v++) {
+        if (remap[v] != UINT32_MAX) {
+            remapped[remap[v]] = vertices[v];
+        }
+    }
+    vertices.swap(remapped);
+}
+
+VertexCacheStats analyzeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount,
+                                    uint32_t cacheSize = ANALYZE_CACHE_SIZE);
+
+}
+}
@@ -10,7 +10,7 @@ void createCube(
   float size,
   const glm::vec3& color
 ) {
-  float half = size * 0.5f,
+  float half = size * 0.5f;
 
   vertices = {
 
@@ -77,10 +77,10 @@ void createSphere(
     float y = radius * cos(phi);
     float ringRadius = radius * sin(phi);
 
-    for (int seg = 0; seg <= segmentsl; ++seg) {
+    for (int seg = 0; seg <= segments; ++seg) {
       float theta = 2.0f * pi * float(seg) / float(segments);
       float x = ringRadius * cos(theta);
-      float y = ringRadius * sin(theta);
+      float z = ringRadius * sin(theta);
 
       glm::vec3 position(x, y, z);
       glm::vec3 normal = glm::normalize(position);
@@ -116,13 +116,13 @@ void createPlane(
   const glm::vec3& color 
 ) {
   vertices.clear();
-  vertices.clear();
+  indices.clear();
 
   float halfWidth = width * 0.5f;
   float halfDepth = depth * 0.5f;
 
   for (int z = 0; z <= subdivisionsZ; ++z) {
-    for (int x = 0; x < subdivisionsX; ++x) {
+    for (int x = 0; x <= subdivisionsX; ++x) {
       float xPos = -halfWidth + (width * float(x) / float(subdivisionsX));
       float zPos = -halfDepth + (depth * float(z) / float(subdivisionsZ));
 
@@ -0,0 +1,250 @@
+#include "MeshSimplifier.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+namespace Plaster {
+namespace MeshSimplifier {
+
+namespace {
+
+// Symmetric 4x4 plane quadric plus the total area that went into it, so the
+// error can be reported as a distance rather than area-weighted squared distance
+struct Quadric {
+    double a2 = 0, ab = 0, ac = 0, ad = 0;
+    double b2 = 0, bc = 0, bd = 0;
+    double c2 = 0, cd = 0;
+    double d2 = 0;
+    double weight = 0;
+
+    void addPlane(const glm::dvec3& n, double d, double w) {
+        a2 += w * n.x * n.x; ab += w * n.x * n.y; ac += w * n.x * n.z; ad += w * n.x * d;
+        b2 += w * n.y * n.y; bc += w * n.y * n.z; bd += w * n.y * d;
+        c2 += w * n.z * n.z; cd += w * n.z * d;
+        d2 += w * d * d;
+        weight += w;
+    }
+
+    void add(const Quadric& q) {
+        a2 += q.a2; ab += q.ab; ac += q.ac; ad += q.ad;
+        b2 += q.b2; bc += q.bc; bd += q.bd;
+        c2 += q.c2; cd += q.cd;
+        d2 += q.d2;
+        weight += q.weight;
+    }
+
+    // Weighted mean squared distance from p to the accumulated planes
+    double evaluate(const glm::dvec3& p) const {
+        double error = a2 * p.x * p.x + 2 * ab * p.x * p.y + 2 * ac * p.x * p.z + 2 * ad * p.x
+                     + b2 * p.y * p.y + 2 * bc * p.y * p.z + 2 * bd * p.y
+                     + c2 * p.z * p.z + 2 * cd * p.z
+                     + d2;
+        return weight > 0 ? std::max(error, 0.0) / weight : 0.0;
+    }
+};
+
+struct Collapse {
+    uint32_t from;
+    uint32_t to;
+    double cost;
+};
+
+struct PositionHash {
+    size_t operator()(const glm::vec3& p) const {
+        uint32_t bits[3];
+        std::memcpy(bits, &p, sizeof(bits));
+        return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+    }
+};
+
+uint64_t edgeKey(uint32_t a, uint32_t b) {
+    return a < b ? (static_cast<uint64_t>(a) << 32) | b : (static_cast<uint64_t>(b) << 32) | a;
+}
+
+}
+
+float simplify(
+    const std::vector<glm::vec3>& positions,
+    const std::vector<uint32_t>& indices,
+    size_t targetIndexCount,
+    float maxError,
+    std::vector<uint32_t>& result
+) {
+    result = indices;
+    const size_t vertexCount = positions.size();
+    if (indices.size() <= targetIndexCount || vertexCount == 0) {
+        return 0.0f;
+    }
+
+    std::vector<uint8_t> locked(vertexCount, 0);
+
+    // Attribute seams: several vertices sharing one position
+    std::unordered_map<glm::vec3, uint32_t, PositionHash> firstAtPosition;
+    for (uint32_t v = 0; v < vertexCount; v++) {
+        auto inserted = firstAtPosition.emplace(positions[v], v);
+        if (!inserted.second) {
+            locked[v] = 1;
+            locked[inserted.first->second] = 1;
+        }
+    }
+
+    // Open borders: edges used by a single triangle
+    std::unordered_map<uint64_t, uint32_t> edgeUse;
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        for (int e = 0; e < 3; e++) {
+            edgeUse[edgeKey(indices[i + e], indices[i + (e + 1) % 3])]++;
+        }
+    }
+    for (const auto& edge : edgeUse) {
+        if (edge.second == 1) {
+            locked[edge.first >> 32] = 1;
+            locked[edge.first & 0xFFFFFFFFu] = 1;
+        }
+    }
+
+    // Each vertex starts with the area-weighted planes of its triangles
+    std::vector<Quadric> quadrics(vertexCount);
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        glm::dvec3 p0 = positions[indices[i]];
+        glm::dvec3 p1 = positions[indices[i + 1]];
+        glm::dvec3 p2 = positions[indices[i + 2]];
+        glm::dvec3 normal = glm::cross(p1 - p0, p2 - p0);
+        double area = glm::length(normal);
+        if (area <= 0.0) continue;
+
+        normal /= area;
+        double d = -glm::dot(normal, p0);
+        for (int c = 0; c < 3; c++) {
+            quadrics[indices[i + c]].addPlane(normal, d, area * 0.5);
+        }
+    }
+
+    const double maxCost = static_cast<double>(maxError) * maxError;
+    double resultCost = 0.0;
+
+    std::vector<Collapse> collapses;
+    std::vector<uint32_t> triangleOffsets(vertexCount + 1);
+    std::vector<uint32_t> vertexTriangles;
+    std::vector<uint32_t> remap(vertexCount);
+    std::vector<uint8_t> touched(vertexCount);
+
+    // Each pass collapses a batch of the cheapest independent edges, then
+    // rewrites the index list and starts again from the simplified mesh
+    while (result.size() > targetIndexCount) {
+        const size_t triangleCount = result.size() / 3;
+
+        // Triangles around each vertex, in CSR form
+        std::fill(triangleOffsets.begin(), triangleOffsets.end(), 0);
+        for (uint32_t index : result) {
+            triangleOffsets[index + 1]++;
+        }
+        for (size_t v = 0; v < vertexCount; v++) {
+            triangleOffsets[v + 1] += triangleOffsets[v];
+        }
+        vertexTriangles.resize(result.size());
+        {
+            std::vector<uint32_t> cursor(triangleOffsets.begin(), triangleOffsets.end() - 1);
+            for (size_t i = 0; i < result.size(); i++) {
+                vertexTriangles[cursor[result[i]]++] = static_cast<uint32_t>(i / 3);
+            }
+        }
+
+        // Cheapest legal direction for every edge
+        collapses.clear();
+        edgeUse.clear();
+        for (size_t i = 0; i < result.size(); i += 3) {
+            for (int e = 0; e < 3; e++) {
+                uint32_t a = result[i + e];
+                uint32_t b = result[i + (e + 1) % 3];
+                if (!edgeUse.emplace(edgeKey(a, b), 0).second) continue;
+
+                Quadric combined = quadrics[a];
+                combined.add(quadrics[b]);
+                double costAB = locked[a] ? -1.0 : combined.evaluate(positions[b]);
+                double costBA = locked[b] ? -1.0 : combined.evaluate(positions[a]);
+                if (costAB < 0.0 && costBA < 0.0) continue;
+
+                if (costBA < 0.0 || (costAB >= 0.0 && costAB <= costBA)) {
+                    collapses.push_back({a, b, costAB});
+                } else {
+                    collapses.push_back({b, a, costBA});
+                }
+            }
+        }
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& x, const Collapse& y) {
+            return x.cost < y.cost;
+        });
+
+        for (uint32_t v = 0; v < vertexCount; v++) {
+            remap[v] = v;
+        }
+        std::fill(touched.begin(), touched.end(), 0);
+
+        const size_t targetTriangles = targetIndexCount / 3;
+        size_t removedTriangles = 0;
+        size_t applied = 0;
+        for (const Collapse& collapse : collapses) {
+            if (collapse.cost > maxCost) break;
+            if (triangleCount - removedTriangles <= targetTriangles) break;
+            if (touched[collapse.from] || touched[collapse.to]) continue;
+
+            // Reject collapses that would flip a surviving triangle
+            const glm::vec3& target = positions[collapse.to];
+            bool flips = false;
+            size_t shared = 0;
+            for (uint32_t t = triangleOffsets[collapse.from]; t < triangleOffsets[collapse.from + 1] && !flips; t++) {
+                const uint32_t* tri = &result[vertexTriangles[t] * 3];
+                if (tri[0] == collapse.to || tri[1] == collapse.to || tri[2] == collapse.to) {
+                    shared++;
+                    continue;
+                }
+
+                glm::vec3 p[3] = {positions[tri[0]], positions[tri[1]], positions[tri[2]]};
+                glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+                for (int c = 0; c < 3; c++) {
+                    if (tri[c] == collapse.from) p[c] = target;
+                }
+                glm::vec3 after = glm::cross(p[1] - p[0], p[2] - p[0]);
+                flips = glm::dot(before, after) <= 0.0f;
+            }
+            if (flips) continue;
+
+            // Freeze the whole neighbourhood for the rest of the pass so the
+            // flip test above never sees a vertex that has already moved
+            for (uint32_t t = triangleOffsets[collapse.from]; t < triangleOffsets[collapse.from + 1]; t++) {
+                const uint32_t* tri = &result[vertexTriangles[t] * 3];
+                touched[tri[0]] = touched[tri[1]] = touched[tri[2]] = 1;
+            }
+            touched[collapse.to] = 1;
+
+            remap[collapse.from] = collapse.to;
+            quadrics[collapse.to].add(quadrics[collapse.from]);
+            resultCost = std::max(resultCost, collapse.cost);
+            removedTriangles += shared;
+            applied++;
+        }
+
+        if (applied == 0) {
+            break;
+        }
+
+        // Rewrite and drop the triangles that collapsed to a line
+        size_t write = 0;
+        for (size_t i = 0; i < result.size(); i += 3) {
+            uint32_t a = remap[result[i]];
+            uint32_t b = remap[result[i + 1]];
+            uint32_t c = remap[result[i + 2]];
+            if (a == b || b == c || c == a) continue;
+            result[write++] = a;
+            result[write++] = b;
+            result[write++] = c;
+        }
+        result.resize(write);
+    }
+
+    return static_cast<float>(std::sqrt(resultCost));
+}
+
+}
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Plaster {
+namespace MeshSimplifier {
+
+// Quadric error metric simplification (Garland & Heckbert). Edges are
+// collapsed onto one of their existing endpoints, so the result indexes the
+// same vertex buffer and an LOD is just another index range. Vertices on
+// open borders or attribute seams (several vertices at one position) are
+// never moved, which keeps UV seams and mesh outlines intact.
+//
+// Collapses stop at targetIndexCount or when the next one would exceed
+// maxError. Returns the error of the result, in the positions' units.
+float simplify(
+    const std::vector<glm::vec3>& positions,
+    const std::vector<uint32_t>& indices,
+    size_t targetIndexCount,
+    float maxError,
+    std::vector<uint32_t>& result
+);
+
+}
+}
@@ -0,0 +1,149 @@
+#include "PipelineCache.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace Plaster {
+
+PipelineCache::PipelineCache()
+    : m_cache(VK_NULL_HANDLE)
+    , m_properties{}
+    , m_warm(false)
+{
+}
+
+PipelineCache::~PipelineCache() {
+}
+
+bool PipelineCache::create(VkDevice device, VkPhysicalDevice physicalDevice, const std::string& directory) {
+    vkGetPhysicalDeviceProperties(physicalDevice, &m_properties);
+
+    std::ostringstream name;
+    name << std::hex << std::setfill('0')
+         << "pipeline_" << std::setw(4) << m_properties.vendorID
+         << "_" << std::setw(4) << m_properties.deviceID
+         << "_" << std::setw(8) << m_properties.driverVersion << "_";
+    for (uint32_t i = 0; i < VK_UUID_SIZE; i++) {
+        name << std::setw(2) << static_cast<uint32_t>(m_properties.pipelineCacheUUID[i]);
+    }
+    name << ".bin";
+
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+    m_filePath = (std::filesystem::path(directory) / name.str()).string();
+
+    std::vector<char> data;
+    m_warm = readFile(data) && validateHeader(data);
+    if (!m_warm && !data.empty()) {
+        std::cout << "Discarding stale pipeline cache: " << m_filePath << std::endl;
+        data.clear();
+    }
+
+    VkPipelineCacheCreateInfo cacheInfo{};
+    cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    cacheInfo.initialDataSize = data.size();
+    cacheInfo.pInitialData = data.empty() ? nullptr : data.data();
+
+    if (vkCreatePipelineCache(device, &cacheInfo, nullptr, &m_cache) != VK_SUCCESS) {
+        std::cerr << "Failed to create pipeline cache" << std::endl;
+        return false;
+    }
+
+    if (m_warm) {
+        std::cout << "Loaded pipeline cache (" << data.size() << " bytes) from " << m_filePath << std::endl;
+    } else {
+        std::cout << "No usable pipeline cache, starting cold" << std::endl;
+    }
+
+    return true;
+}
+
+void PipelineCache::destroy(VkDevice device) {
+    if (m_cache == VK_NULL_HANDLE) return;
+
+    save(device);
+    vkDestroyPipelineCache(device, m_cache, nullptr);
+    m_cache = VK_NULL_HANDLE;
+}
+
+bool PipelineCache::save(VkDevice device) const {
+    if (m_cache == VK_NULL_HANDLE) return false;
+
+    size_t size = 0;
+    if (vkGetPipelineCacheData(device, m_cache, &size, nullptr) != VK_SUCCESS || size == 0) {
+        std::cerr << "Failed to query pipeline cache size" << std::endl;
+        return false;
+    }
+
+    std::vector<char> data(size);
+    if (vkGetPipelineCacheData(device, m_cache, &size, data.data()) != VK_SUCCESS) {
+        std::cerr << "Failed to read pipeline cache data" << std::endl;
+        return false;
+    }
+
+    // Write to a temporary file and rename so a crash never leaves a torn cache
+    std::string tempPath = m_filePath + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            std::cerr << "Failed to open pipeline cache for writing: " << tempPath << std::endl;
+            return false;
+        }
+        file.write(data.data(), static_cast<std::streamsize>(size));
+        if (!file) {
+            std::cerr << "Failed to write pipeline cache: " << tempPath << std::endl;
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, m_filePath, ec);
+    if (ec) {
+        std::cerr << "Failed to replace pipeline cache: " << ec.message() << std::endl;
+        return false;
+    }
+
+    std::cout << "Saved pipeline cache (" << size << " bytes) to " << m_filePath << std::endl;
+    return true;
+}
+
+bool PipelineCache::readFile(std::vector<char>& data) const {
+    std::ifstream file(m_filePath, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    std::streamsize size = file.tellg();
+    if (size <= 0) {
+        return false;
+    }
+
+    data.resize(static_cast<size_t>(size));
+    file.seekg(0);
+    file.read(data.data(), size);
+    return static_cast<bool>(file);
+}
+
+bool PipelineCache::validateHeader(const std::vector<char>& data) const {
+    VkPipelineCacheHeaderVersionOne header{};
+    if (data.size() < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+
+    if (header.headerSize < sizeof(header) || header.headerSize > data.size()) {
+        return false;
+    }
+    if (header.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE) {
+        return false;
+    }
+    if (header.vendorID != m_properties.vendorID || header.deviceID != m_properties.deviceID) {
+        return false;
+    }
+    return std::memcmp(header.pipelineCacheUUID, m_properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+}
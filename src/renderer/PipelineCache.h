@@ -0,0 +1,41 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <string>
+#include <vector>
+
+namespace Plaster {
+
+// VkPipelineCache persisted to disk between runs. The file name is keyed by
+// vendor, device, driver version and pipeline cache UUID, and the blob header
+// is validated before use so caches from another driver are discarded.
+class PipelineCache {
+public:
+    PipelineCache();
+    ~PipelineCache();
+
+    // Create the cache, seeding it from disk when a valid file exists
+    bool create(VkDevice device, VkPhysicalDevice physicalDevice, const std::string& directory = "cache");
+
+    // Write the cache back to disk and destroy it
+    void destroy(VkDevice device);
+
+    // Write the current cache contents to disk
+    bool save(VkDevice device) const;
+
+    VkPipelineCache getHandle() const { return m_cache; }
+
+    // True when the cache was seeded from a file written by an earlier run
+    bool isWarm() const { return m_warm; }
+
+private:
+    VkPipelineCache m_cache;
+    VkPhysicalDeviceProperties m_properties;
+    std::string m_filePath;
+    bool m_warm;
+
+    bool readFile(std::vector<char>& data) const;
+    bool validateHeader(const std::vector<char>& data) const;
+};
+
+}
@@ -1,9 +1,16 @@
  #include "PlastibooMaterial.h"
+  #include "MaterialRegistry.h"
   #include <iostream>
+  #include <atomic>
 
   namespace Plaster {
 
-  PlastibooMaterial::PlastibooMaterial() {
+  static std::atomic<uint32_t> s_nextMaterialSortId{0};
+
+  PlastibooMaterial::PlastibooMaterial()
+      : m_sortId(s_nextMaterialSortId++)
+      , m_registry(nullptr)
+      , m_index(0) {
       // Default material settings
       m_data.baseColor = glm::vec4(0.8f, 0.7f, 0.6f, 1.0f); // Clay tan
       m_data.clayRoughness = 0.75f;
@@ -17,33 +24,36 @@
   PlastibooMaterial::~PlastibooMaterial() {
   }
 
-  bool PlastibooMaterial::create(VmaAllocator allocator) {
-      // Create uniform buffer
-      if (!m_uniformBuffer.create(
-          allocator,
-          sizeof(PlastibooMaterialData),
-          VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-          VMA_MEMORY_USAGE_CPU_TO_GPU,
-          VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT
-      )) {
-          std::cerr << "Failed to create material uniform buffer!" << std::endl;
+  bool PlastibooMaterial::create(MaterialRegistry& registry) {
+      if (!registry.isCreated()) {
+          std::cerr << "Failed to create material: registry not created!" << std::endl;
           return false;
       }
 
-      // Upload initial data
-      updateData(allocator, m_data);
+      // Take a registry slot holding the initial data
+      m_registry = &registry;
+      m_index = registry.allocate(m_data);
 
       std::cout << "PlastibooMaterial created" << std::endl;
       return true;
   }
 
-  void PlastibooMaterial::destroy(VmaAllocator allocator) {
-      m_uniformBuffer.destroy(allocator);
+  void PlastibooMaterial::destroy() {
+      if (m_registry) {
+          m_registry->release(m_index);
+          m_registry = nullptr;
+      }
   }
 
-  void PlastibooMaterial::updateData(VmaAllocator allocator, const PlastibooMaterialData& data) {
+  void PlastibooMaterial::updateData(const PlastibooMaterialData& data) {
       m_data = data;
-      m_uniformBuffer.copyData(allocator, &m_data, sizeof(PlastibooMaterialData));
+      commit();
+  }
+
+  void PlastibooMaterial::commit() {
+      if (m_registry) {
+          m_registry->update(m_index, m_data);
+      }
   }
 
   PlastibooMaterialData PlastibooMaterial::createMedievalDungeonPreset() {
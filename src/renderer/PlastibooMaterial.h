@@ -1,11 +1,12 @@
 #pragma once 
-#include "VulkanBuffer.h"
 #include <glm/glm.hpp>
 #include <ppltasks.h>
 #include <vulkan/vulkan.h>
 #include <vk_mem_alloc.h>
 
 namespace Plaster {
+class MaterialRegistry;
+
 struct PlastibooMaterialData {
   glm::vec4 baseColor;
   float clayRoughness;
@@ -14,31 +15,40 @@ struct PlastibooMaterialData {
   int paletteIndex;
   int useDithering;
   int useAffineMapping;
-  float padding[2];
+  int albedoTexture = 0;   // Slot in the bindless texture table; 0 is the white placeholder
+  float padding = 0.0f;
 };
 
+// A material's data lives in a slot of the renderer's MaterialRegistry from
+// create() to destroy(). Setters write through to the slot, which reaches the
+// GPU at the next frame's flush.
 class PlastibooMaterial {
 public:
   PlastibooMaterial();
   ~PlastibooMaterial();
   
-  bool create(VmaAllocator allocator);
+  bool create(MaterialRegistry& registry);
 
-  void destroy(VmaAllocator allocator);
+  void destroy();
   
-  void updateData(VmaAllocator allocator, const PlastibooMaterialData& data);
+  void updateData(const PlastibooMaterialData& data);
 
-  VkBuffer getUniformBuffer() const { return m_uniformBuffer.getBuffer(); }
+  // Slot in the registry, stored in each object's data to select this material
+  uint32_t getIndex() const { return m_index; }
 
   const PlastibooMaterialData& getData() const { return m_data; }
 
-  void setBaseColor( const glm::vec3& color) { m_data.baseColor = glm::vec4(color, 1.0f); }
-  void setClayRoughness(float roughness) { m_data.clayRoughness = roughness; }
-  void setDitherStrength(float strength) { m_data.ditherStrength = strength; }
-  void setWarmthBias(float bias) { m_data.warmthBias = bias; }
-  void setPaletteIndex(int index) { m_data.paletteIndex = index; }
-  void setUseDithering(bool use) { m_data.useDithering = use ? 1 : 0; }
-  void setUseAffineMapping(bool use) { m_data.useAffineMapping = use ? 1 : 0; }
+  // Small per-process id used to order draws in the render queue
+  uint32_t getSortId() const { return m_sortId; }
+
+  void setBaseColor( const glm::vec3& color) { m_data.baseColor = glm::vec4(color, 1.0f); commit(); }
+  void setClayRoughness(float roughness) { m_data.clayRoughness = roughness; commit(); }
+  void setDitherStrength(float strength) { m_data.ditherStrength = strength; commit(); }
+  void setWarmthBias(float bias) { m_data.warmthBias = bias; commit(); }
+  void setPaletteIndex(int index) { m_data.paletteIndex = index; commit(); }
+  void setUseDithering(bool use) { m_data.useDithering = use ? 1 : 0; commit(); }
+  void setUseAffineMapping(bool use) { m_data.useAffineMapping = use ? 1 : 0; commit(); }
+  void setAlbedoTexture(uint32_t index) { m_data.albedoTexture = static_cast<int>(index); commit(); }
 
 
   static PlastibooMaterialData createMedievalDungeonPreset();
@@ -47,8 +57,13 @@ public:
   static PlastibooMaterialData createAncientForestPreset();
 
 private:
-  VulkanBuffer m_uniformBuffer;
+  uint32_t m_sortId;
+  MaterialRegistry* m_registry;
+  uint32_t m_index;
   PlastibooMaterialData m_data;
+
+  // Copy m_data into the registry slot, if there is one yet
+  void commit();
 };
 }
 
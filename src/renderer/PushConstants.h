@@ -0,0 +1,46 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+
+namespace Plaster {
+
+// Per-draw data pushed with vkCmdPushConstants (matches DrawConstants in
+// plastiboo.vert). Kept far below the 128 bytes every device guarantees so it
+// never competes with future per-pass constants. The material index lives in
+// ObjectData, so draws of different materials need no push between them.
+struct DrawPushConstants {
+    uint32_t objectOffset = 0;   // Added to gl_InstanceIndex to find the object's slot
+};
+
+// Only the vertex stage reads the block, so the layout range and every push use these
+static constexpr VkShaderStageFlags DRAW_PUSH_CONSTANT_STAGES = VK_SHADER_STAGE_VERTEX_BIT;
+
+inline VkPushConstantRange getDrawPushConstantRange() {
+    VkPushConstantRange range{};
+    range.stageFlags = DRAW_PUSH_CONSTANT_STAGES;
+    range.offset = 0;
+    range.size = sizeof(DrawPushConstants);
+    return range;
+}
+
+// Write a whole push constant block at offset 0
+template<typename T>
+void pushConstants(VkCommandBuffer commandBuffer, VkPipelineLayout layout, VkShaderStageFlags stages, const T& data) {
+    static_assert(sizeof(T) % 4 == 0, "Push constant blocks must be a multiple of 4 bytes");
+    static_assert(sizeof(T) <= 128, "Only 128 bytes of push constants are guaranteed");
+    vkCmdPushConstants(commandBuffer, layout, stages, 0, sizeof(T), &data);
+}
+
+inline void pushDrawConstants(VkCommandBuffer commandBuffer, VkPipelineLayout layout, const DrawPushConstants& data) {
+    pushConstants(commandBuffer, layout, DRAW_PUSH_CONSTANT_STAGES, data);
+}
+
+// How per-object data reaches the shaders on the CPU batch path
+enum class DrawDataMode {
+    INSTANCED = 0,            // One draw per batch; objects found through gl_InstanceIndex
+    PER_DRAW_PUSH_CONSTANTS,  // One draw per object, its slot pushed as objectOffset
+    PER_DRAW_DESCRIPTOR_SETS  // One draw per object, set 1 bound before each like a set-per-object renderer
+};
+
+}
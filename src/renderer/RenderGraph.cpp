@@ -0,0 +1,682 @@
+#include "RenderGraph.h"
+#include <algorithm>
+#include <iostream>
+
+namespace Plaster {
+
+namespace {
+
+// What one access implies for barriers and image creation
+struct AccessInfo {
+    VkImageLayout layout;
+    VkPipelineStageFlags stage;
+    VkAccessFlags access;
+    VkImageUsageFlags usage;
+};
+
+AccessInfo getAccessInfo(RenderGraphAccess access) {
+    switch (access) {
+    case RenderGraphAccess::COLOR_ATTACHMENT:
+        return {VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT};
+    case RenderGraphAccess::DEPTH_ATTACHMENT:
+        return {VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+                VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT};
+    case RenderGraphAccess::SAMPLED_FRAGMENT:
+        return {VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_USAGE_SAMPLED_BIT};
+    case RenderGraphAccess::SAMPLED_COMPUTE:
+        return {VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_USAGE_SAMPLED_BIT};
+    case RenderGraphAccess::STORAGE_READ:
+        return {VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_USAGE_STORAGE_BIT};
+    case RenderGraphAccess::STORAGE_WRITE:
+        return {VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_USAGE_STORAGE_BIT};
+    case RenderGraphAccess::TRANSFER_SRC:
+        return {VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                VK_ACCESS_TRANSFER_READ_BIT, VK_IMAGE_USAGE_TRANSFER_SRC_BIT};
+    case RenderGraphAccess::TRANSFER_DST:
+        return {VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_USAGE_TRANSFER_DST_BIT};
+    }
+    return {VK_IMAGE_LAYOUT_UNDEFINED, 0, 0, 0};
+}
+
+bool isAttachment(RenderGraphAccess access) {
+    return access == RenderGraphAccess::COLOR_ATTACHMENT || access == RenderGraphAccess::DEPTH_ATTACHMENT;
+}
+
+VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+VkImageMemoryBarrier makeBarrier(VkImage image, VkImageAspectFlags aspect, VkImageLayout oldLayout,
+                                 VkImageLayout newLayout, VkAccessFlags srcAccess, VkAccessFlags dstAccess) {
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = srcAccess;
+    barrier.dstAccessMask = dstAccess;
+    barrier.oldLayout = oldLayout;
+    barrier.newLayout = newLayout;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    barrier.subresourceRange = {aspect, 0, 1, 0, 1};
+    return barrier;
+}
+
+}
+
+RenderGraph::RenderGraph()
+    : m_aliasedMemory(VK_NULL_HANDLE)
+    , m_aliasedMemorySize(0)
+    , m_unaliasedMemorySize(0)
+    , m_compiled(false)
+{
+}
+
+RenderGraph::~RenderGraph() {
+}
+
+RenderGraphResource RenderGraph::createImage(const std::string& name, const RenderGraphImageDesc& desc) {
+    Resource resource;
+    resource.name = name;
+    resource.desc = desc;
+    m_resources.push_back(resource);
+    return static_cast<RenderGraphResource>(m_resources.size() - 1);
+}
+
+RenderGraphResource RenderGraph::importImage(const std::string& name, const RenderGraphImageDesc& desc,
+                                             const RenderGraphImageState& initialState,
+                                             const RenderGraphImageState& finalState) {
+    Resource resource;
+    resource.name = name;
+    resource.desc = desc;
+    resource.imported = true;
+    resource.initialState = initialState;
+    resource.finalState = finalState;
+    m_resources.push_back(resource);
+    return static_cast<RenderGraphResource>(m_resources.size() - 1);
+}
+
+RenderGraphPassId RenderGraph::addPass(const std::string& name, RenderGraphPassType type, RenderGraphRecordFunc record) {
+    Pass pass;
+    pass.name = name;
+    pass.type = type;
+    pass.record = std::move(record);
+    m_passes.push_back(std::move(pass));
+    return static_cast<RenderGraphPassId>(m_passes.size() - 1);
+}
+
+void RenderGraph::read(RenderGraphPassId pass, RenderGraphResource resource, RenderGraphAccess access) {
+    m_passes[pass].accesses.push_back({resource, access, false, VK_ATTACHMENT_LOAD_OP_DONT_CARE, {}});
+}
+
+void RenderGraph::write(RenderGraphPassId pass, RenderGraphResource resource, RenderGraphAccess access,
+                        VkAttachmentLoadOp loadOp, VkClearValue clearValue) {
+    m_passes[pass].accesses.push_back({resource, access, true, loadOp, clearValue});
+}
+
+void RenderGraph::setSideEffect(RenderGraphPassId pass) {
+    m_passes[pass].sideEffect = true;
+}
+
+void RenderGraph::cullPasses() {
+    // Walk backwards from the imported images and side effects, keeping a pass
+    // only while something later still needs what it writes
+    std::vector<bool> needed(m_resources.size(), false);
+    for (size_t i = m_passes.size(); i-- > 0;) {
+        Pass& pass = m_passes[i];
+
+        pass.live = pass.sideEffect;
+        for (const Access& access : pass.accesses) {
+            if (access.write && (m_resources[access.resource].imported || needed[access.resource])) {
+                pass.live = true;
+            }
+        }
+        if (!pass.live) {
+            continue;
+        }
+
+        // A full overwrite hides every earlier write; loads and reads need them
+        for (const Access& access : pass.accesses) {
+            if (access.write && access.loadOp != VK_ATTACHMENT_LOAD_OP_LOAD) {
+                needed[access.resource] = false;
+            }
+        }
+        for (const Access& access : pass.accesses) {
+            if (!access.write || access.loadOp == VK_ATTACHMENT_LOAD_OP_LOAD) {
+                needed[access.resource] = true;
+            }
+        }
+    }
+}
+
+void RenderGraph::computeLifetimes() {
+    for (uint32_t i = 0; i < m_passes.size(); i++) {
+        if (!m_passes[i].live) continue;
+
+        for (const Access& access : m_passes[i].accesses) {
+            Resource& resource = m_resources[access.resource];
+            resource.usage |= getAccessInfo(access.access).usage;
+            resource.firstPass = std::min(resource.firstPass, i);
+            resource.lastPass = std::max(resource.lastPass, i);
+        }
+    }
+}
+
+bool RenderGraph::isReadLater(RenderGraphResource resource, uint32_t afterPass) const {
+    for (uint32_t i = afterPass + 1; i < m_passes.size(); i++) {
+        if (!m_passes[i].live) continue;
+
+        for (const Access& access : m_passes[i].accesses) {
+            if (access.resource == resource && (!access.write || access.loadOp == VK_ATTACHMENT_LOAD_OP_LOAD)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool RenderGraph::compile(VkDevice device, VmaAllocator allocator) {
+    for (const Pass& pass : m_passes) {
+        for (const Access& access : pass.accesses) {
+            if (isAttachment(access.access) && pass.type != RenderGraphPassType::GRAPHICS) {
+                std::cerr << "Render graph pass " << pass.name << " uses an attachment outside a graphics pass!" << std::endl;
+                return false;
+            }
+        }
+    }
+
+    cullPasses();
+    computeLifetimes();
+
+    if (!createImages(device, allocator)) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < m_passes.size(); i++) {
+        if (m_passes[i].live && m_passes[i].type == RenderGraphPassType::GRAPHICS && !createRenderPass(device, i)) {
+            return false;
+        }
+    }
+
+    m_compiled = true;
+    return true;
+}
+
+bool RenderGraph::createImages(VkDevice device, VmaAllocator allocator) {
+    const VkImageUsageFlags attachmentUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+                                              VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT |
+                                              VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT;
+
+    std::vector<RenderGraphResource> aliasCandidates;
+    for (RenderGraphResource i = 0; i < m_resources.size(); i++) {
+        Resource& resource = m_resources[i];
+        if (resource.imported || resource.firstPass == UINT32_MAX) {
+            continue;
+        }
+
+        // Attachments that live and die inside one pass are never stored, so
+        // their memory may stay on chip and need never be backed
+        resource.transientAttachment = (resource.usage & ~attachmentUsage) == 0 &&
+                                       resource.firstPass == resource.lastPass;
+        if (resource.transientAttachment) {
+            resource.usage |= VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+        }
+
+        VkImageCreateInfo imageInfo{};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.format = resource.desc.format;
+        imageInfo.extent = {resource.desc.extent.width, resource.desc.extent.height, 1};
+        imageInfo.mipLevels = 1;
+        imageInfo.arrayLayers = 1;
+        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.usage = resource.usage;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+        if (resource.transientAttachment) {
+            // Lazily allocated memory is optional; any device memory will do otherwise
+            VmaAllocationCreateInfo allocInfo{};
+            allocInfo.usage = VMA_MEMORY_USAGE_GPU_LAZILY_ALLOCATED;
+            if (vmaCreateImage(allocator, &imageInfo, &allocInfo, &resource.image, &resource.allocation, nullptr) != VK_SUCCESS) {
+                allocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+                if (vmaCreateImage(allocator, &imageInfo, &allocInfo, &resource.image, &resource.allocation, nullptr) != VK_SUCCESS) {
+                    std::cerr << "Failed to create render graph image " << resource.name << "!" << std::endl;
+                    return false;
+                }
+            }
+        } else {
+            if (vkCreateImage(device, &imageInfo, nullptr, &resource.image) != VK_SUCCESS) {
+                std::cerr << "Failed to create render graph image " << resource.name << "!" << std::endl;
+                return false;
+            }
+            vkGetImageMemoryRequirements(device, resource.image, &resource.memoryRequirements);
+            aliasCandidates.push_back(i);
+        }
+    }
+
+    if (!placeAliasedImages(allocator, aliasCandidates)) {
+        return false;
+    }
+
+    for (Resource& resource : m_resources) {
+        if (resource.image != VK_NULL_HANDLE && !resource.imported && !createImageView(device, resource)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool RenderGraph::placeAliasedImages(VmaAllocator allocator, const std::vector<RenderGraphResource>& candidates) {
+    m_aliasedMemorySize = 0;
+    m_unaliasedMemorySize = 0;
+    if (candidates.empty()) {
+        return true;
+    }
+
+    // Largest first, each at the lowest offset clear of every image placed so
+    // far that is alive at the same time
+    std::vector<RenderGraphResource> order = candidates;
+    std::sort(order.begin(), order.end(), [this](RenderGraphResource a, RenderGraphResource b) {
+        return m_resources[a].memoryRequirements.size > m_resources[b].memoryRequirements.size;
+    });
+
+    auto lifetimesOverlap = [](const Resource& a, const Resource& b) {
+        return a.firstPass <= b.lastPass && b.firstPass <= a.lastPass;
+    };
+
+    VkMemoryRequirements heapRequirements{};
+    heapRequirements.alignment = 1;
+    heapRequirements.memoryTypeBits = ~0u;
+
+    std::vector<RenderGraphResource> placed;
+    for (RenderGraphResource index : order) {
+        Resource& resource = m_resources[index];
+        const VkMemoryRequirements& requirements = resource.memoryRequirements;
+
+        VkDeviceSize offset = 0;
+        bool moved = true;
+        while (moved) {
+            moved = false;
+            for (RenderGraphResource other : placed) {
+                const Resource& block = m_resources[other];
+                VkDeviceSize blockEnd = block.memoryOffset + block.memoryRequirements.size;
+                if (lifetimesOverlap(resource, block) &&
+                    offset < blockEnd && block.memoryOffset < offset + requirements.size) {
+                    offset = alignUp(blockEnd, requirements.alignment);
+                    moved = true;
+                }
+            }
+        }
+
+        resource.memoryOffset = offset;
+        resource.aliased = true;
+        placed.push_back(index);
+
+        heapRequirements.size = std::max(heapRequirements.size, offset + requirements.size);
+        heapRequirements.alignment = std::max(heapRequirements.alignment, requirements.alignment);
+        heapRequirements.memoryTypeBits &= requirements.memoryTypeBits;
+        m_unaliasedMemorySize += requirements.size;
+    }
+
+    VmaAllocationCreateInfo allocInfo{};
+    allocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+
+    if (heapRequirements.memoryTypeBits == 0) {
+        // No memory type suits every image; give each its own allocation
+        for (RenderGraphResource index : placed) {
+            Resource& resource = m_resources[index];
+            resource.aliased = false;
+            resource.memoryOffset = 0;
+            if (vmaAllocateMemoryForImage(allocator, resource.image, &allocInfo, &resource.allocation, nullptr) != VK_SUCCESS ||
+                vmaBindImageMemory(allocator, resource.allocation, resource.image) != VK_SUCCESS) {
+                std::cerr << "Failed to allocate render graph image " << resource.name << "!" << std::endl;
+                return false;
+            }
+        }
+        m_aliasedMemorySize = m_unaliasedMemorySize;
+        return true;
+    }
+
+    if (vmaAllocateMemory(allocator, &heapRequirements, &allocInfo, &m_aliasedMemory, nullptr) != VK_SUCCESS) {
+        std::cerr << "Failed to allocate render graph memory!" << std::endl;
+        return false;
+    }
+    m_aliasedMemorySize = heapRequirements.size;
+
+    for (RenderGraphResource index : placed) {
+        Resource& resource = m_resources[index];
+        if (vmaBindImageMemory2(allocator, m_aliasedMemory, resource.memoryOffset, resource.image, nullptr) != VK_SUCCESS) {
+            std::cerr << "Failed to bind render graph image " << resource.name << "!" << std::endl;
+            return false;
+        }
+
+        // Whoever used overlapping memory before this image must finish first
+        for (RenderGraphResource other : placed) {
+            const Resource& block = m_resources[other];
+            bool memoryOverlaps = resource.memoryOffset < block.memoryOffset + block.memoryRequirements.size &&
+                                  block.memoryOffset < resource.memoryOffset + resource.memoryRequirements.size;
+            if (other != index && memoryOverlaps && block.lastPass < resource.firstPass) {
+                resource.aliasPredecessors.push_back(other);
+            }
+        }
+    }
+    return true;
+}
+
+bool RenderGraph::createImageView(VkDevice device, Resource& resource) {
+    VkImageViewCreateInfo viewInfo{};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = resource.image;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format = resource.desc.format;
+    viewInfo.subresourceRange = {resource.desc.aspect, 0, 1, 0, 1};
+
+    if (vkCreateImageView(device, &viewInfo, nullptr, &resource.view) != VK_SUCCESS) {
+        std::cerr << "Failed to create render graph image view " << resource.name << "!" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool RenderGraph::createRenderPass(VkDevice device, RenderGraphPassId passId) {
+    Pass& pass = m_passes[passId];
+
+    // Color attachments in declaration order, then depth
+    pass.attachments.clear();
+    int32_t depthAccess = -1;
+    for (uint32_t i = 0; i < pass.accesses.size(); i++) {
+        if (pass.accesses[i].access == RenderGraphAccess::COLOR_ATTACHMENT) {
+            pass.attachments.push_back(i);
+        } else if (pass.accesses[i].access == RenderGraphAccess::DEPTH_ATTACHMENT) {
+            depthAccess = static_cast<int32_t>(i);
+        }
+    }
+    const uint32_t colorCount = static_cast<uint32_t>(pass.attachments.size());
+    if (depthAccess >= 0) {
+        pass.attachments.push_back(static_cast<uint32_t>(depthAccess));
+    }
+    if (pass.attachments.empty()) {
+        std::cerr << "Render graph pass " << pass.name << " has no attachments!" << std::endl;
+        return false;
+    }
+
+    std::vector<VkAttachmentDescription> descriptions;
+    std::vector<VkAttachmentReference> colorReferences;
+    VkAttachmentReference depthReference{};
+    pass.extent = m_resources[pass.accesses[pass.attachments[0]].resource].desc.extent;
+
+    for (uint32_t i = 0; i < pass.attachments.size(); i++) {
+        const Access& access = pass.accesses[pass.attachments[i]];
+        const Resource& resource = m_resources[access.resource];
+        const AccessInfo info = getAccessInfo(access.access);
+
+        if (resource.desc.extent.width != pass.extent.width || resource.desc.extent.height != pass.extent.height) {
+            std::cerr << "Render graph pass " << pass.name << " has attachments of different sizes!" << std::endl;
+            return false;
+        }
+
+        // The graph transitions layouts itself, so the render pass never does
+        VkAttachmentDescription description{};
+        description.format = resource.desc.format;
+        description.samples = VK_SAMPLE_COUNT_1_BIT;
+        description.loadOp = access.loadOp;
+        description.storeOp = resource.imported || isReadLater(access.resource, passId) ? VK_ATTACHMENT_STORE_OP_STORE
+                                                                                        : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        description.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        description.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        description.initialLayout = info.layout;
+        description.finalLayout = info.layout;
+        descriptions.push_back(description);
+
+        if (i < colorCount) {
+            colorReferences.push_back({i, info.layout});
+        } else {
+            depthReference = {i, info.layout};
+        }
+    }
+
+    VkSubpassDescription subpass{};
+    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpass.colorAttachmentCount = colorCount;
+    subpass.pColorAttachments = colorReferences.data();
+    subpass.pDepthStencilAttachment = depthAccess >= 0 ? &depthReference : nullptr;
+
+    VkRenderPassCreateInfo renderPassInfo{};
+    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    renderPassInfo.attachmentCount = static_cast<uint32_t>(descriptions.size());
+    renderPassInfo.pAttachments = descriptions.data();
+    renderPassInfo.subpassCount = 1;
+    renderPassInfo.pSubpasses = &subpass;
+
+    if (vkCreateRenderPass(device, &renderPassInfo, nullptr, &pass.renderPass) != VK_SUCCESS) {
+        std::cerr << "Failed to create render pass for " << pass.name << "!" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+VkFramebuffer RenderGraph::getFramebuffer(VkDevice device, Pass& pass) {
+    std::vector<VkImageView> views;
+    for (uint32_t attachment : pass.attachments) {
+        views.push_back(m_resources[pass.accesses[attachment].resource].view);
+    }
+
+    for (const auto& entry : pass.framebuffers) {
+        if (entry.first == views) {
+            return entry.second;
+        }
+    }
+
+    VkFramebufferCreateInfo framebufferInfo{};
+    framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+    framebufferInfo.renderPass = pass.renderPass;
+    framebufferInfo.attachmentCount = static_cast<uint32_t>(views.size());
+    framebufferInfo.pAttachments = views.data();
+    framebufferInfo.width = pass.extent.width;
+    framebufferInfo.height = pass.extent.height;
+    framebufferInfo.layers = 1;
+
+    VkFramebuffer framebuffer = VK_NULL_HANDLE;
+    if (vkCreateFramebuffer(device, &framebufferInfo, nullptr, &framebuffer) != VK_SUCCESS) {
+        std::cerr << "Failed to create framebuffer for " << pass.name << "!" << std::endl;
+        return VK_NULL_HANDLE;
+    }
+    pass.framebuffers.emplace_back(std::move(views), framebuffer);
+    return framebuffer;
+}
+
+void RenderGraph::setImportedImage(RenderGraphResource resource, VkImage image, VkImageView view) {
+    m_resources[resource].image = image;
+    m_resources[resource].view = view;
+}
+
+void RenderGraph::addBarrier(Resource& resource, RenderGraphAccess access, bool write,
+                             std::vector<VkImageMemoryBarrier>& barriers,
+                             VkPipelineStageFlags& srcStages, VkPipelineStageFlags& dstStages) {
+    const AccessInfo info = getAccessInfo(access);
+    TrackedState& state = resource.state;
+
+    if (write || state.layout != info.layout) {
+        // Wait for the last write and every read since; reads only need an
+        // execution dependency before they are overwritten
+        srcStages |= state.writeStage | state.readStages;
+        dstStages |= info.stage;
+        barriers.push_back(makeBarrier(resource.image, resource.desc.aspect, state.layout, info.layout,
+                                       state.writeAccess, info.access));
+
+        state.layout = info.layout;
+        if (write) {
+            state.writeStage = info.stage;
+            state.writeAccess = info.access;
+            state.readStages = 0;
+            state.readAccess = 0;
+        } else {
+            // The transition itself is the last write, already visible to this read
+            state.writeStage = info.stage;
+            state.writeAccess = 0;
+            state.readStages = info.stage;
+            state.readAccess = info.access;
+        }
+        return;
+    }
+
+    // Another read in the same layout: only the last write must be visible
+    if ((state.readStages & info.stage) == info.stage && (state.readAccess & info.access) == info.access) {
+        return;
+    }
+    if (state.writeStage != 0) {
+        srcStages |= state.writeStage;
+        dstStages |= info.stage;
+        barriers.push_back(makeBarrier(resource.image, resource.desc.aspect, state.layout, state.layout,
+                                       state.writeAccess, info.access));
+    }
+    state.readStages |= info.stage;
+    state.readAccess |= info.access;
+}
+
+void RenderGraph::execute(VkCommandBuffer commandBuffer, VkDevice device) {
+    if (!m_compiled) return;
+
+    // Transient contents never survive an execution; imported images start
+    // where the caller said they are
+    for (Resource& resource : m_resources) {
+        resource.state = TrackedState{};
+        if (resource.imported) {
+            resource.state.layout = resource.initialState.layout;
+            resource.state.writeStage = resource.initialState.stage;
+            resource.state.writeAccess = resource.initialState.access;
+        }
+    }
+
+    RenderGraphContext context;
+    context.commandBuffer = commandBuffer;
+    context.device = device;
+    context.graph = this;
+
+    std::vector<VkImageMemoryBarrier> barriers;
+    for (uint32_t passIndex = 0; passIndex < m_passes.size(); passIndex++) {
+        Pass& pass = m_passes[passIndex];
+        if (!pass.live) continue;
+
+        barriers.clear();
+        VkPipelineStageFlags srcStages = 0;
+        VkPipelineStageFlags dstStages = 0;
+        for (const Access& access : pass.accesses) {
+            Resource& resource = m_resources[access.resource];
+
+            // First use of aliased memory waits for its previous occupants
+            if (resource.firstPass == passIndex) {
+                for (RenderGraphResource predecessor : resource.aliasPredecessors) {
+                    const TrackedState& previous = m_resources[predecessor].state;
+                    resource.state.writeStage |= previous.writeStage | previous.readStages;
+                    resource.state.writeAccess |= previous.writeAccess;
+                }
+            }
+
+            addBarrier(resource, access.access, access.write, barriers, srcStages, dstStages);
+        }
+
+        if (!barriers.empty()) {
+            vkCmdPipelineBarrier(commandBuffer,
+                                 srcStages != 0 ? srcStages : static_cast<VkPipelineStageFlags>(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT), dstStages,
+                                 0, 0, nullptr, 0, nullptr, static_cast<uint32_t>(barriers.size()), barriers.data());
+        }
+
+        if (pass.type != RenderGraphPassType::GRAPHICS) {
+            context.renderPass = VK_NULL_HANDLE;
+            context.extent = {0, 0};
+            pass.record(context);
+            continue;
+        }
+
+        VkFramebuffer framebuffer = getFramebuffer(device, pass);
+        if (framebuffer == VK_NULL_HANDLE) continue;
+
+        std::vector<VkClearValue> clearValues;
+        for (uint32_t attachment : pass.attachments) {
+            clearValues.push_back(pass.accesses[attachment].clearValue);
+        }
+
+        VkRenderPassBeginInfo renderPassInfo{};
+        renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        renderPassInfo.renderPass = pass.renderPass;
+        renderPassInfo.framebuffer = framebuffer;
+        renderPassInfo.renderArea.extent = pass.extent;
+        renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
+        renderPassInfo.pClearValues = clearValues.data();
+
+        vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+        context.renderPass = pass.renderPass;
+        context.extent = pass.extent;
+        pass.record(context);
+        vkCmdEndRenderPass(commandBuffer);
+    }
+
+    // Hand imported images back in the state the caller asked for
+    barriers.clear();
+    VkPipelineStageFlags srcStages = 0;
+    VkPipelineStageFlags dstStages = 0;
+    for (Resource& resource : m_resources) {
+        const RenderGraphImageState& target = resource.finalState;
+        if (!resource.imported || target.layout == VK_IMAGE_LAYOUT_UNDEFINED) continue;
+        if (resource.state.layout == target.layout && resource.state.writeAccess == 0) continue;
+
+        srcStages |= resource.state.writeStage | resource.state.readStages;
+        dstStages |= target.stage;
+        barriers.push_back(makeBarrier(resource.image, resource.desc.aspect, resource.state.layout, target.layout,
+                                       resource.state.writeAccess, target.access));
+    }
+    if (!barriers.empty()) {
+        vkCmdPipelineBarrier(commandBuffer,
+                             srcStages != 0 ? srcStages : static_cast<VkPipelineStageFlags>(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT),
+                             dstStages != 0 ? dstStages : static_cast<VkPipelineStageFlags>(VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT),
+                             0, 0, nullptr, 0, nullptr, static_cast<uint32_t>(barriers.size()), barriers.data());
+    }
+}
+
+void RenderGraph::destroy(VkDevice device, VmaAllocator allocator) {
+    for (Pass& pass : m_passes) {
+        for (const auto& entry : pass.framebuffers) {
+            vkDestroyFramebuffer(device, entry.second, nullptr);
+        }
+        if (pass.renderPass != VK_NULL_HANDLE) {
+            vkDestroyRenderPass(device, pass.renderPass, nullptr);
+        }
+    }
+
+    for (Resource& resource : m_resources) {
+        if (resource.imported) continue;
+
+        if (resource.view != VK_NULL_HANDLE) {
+            vkDestroyImageView(device, resource.view, nullptr);
+        }
+        if (resource.allocation != VK_NULL_HANDLE) {
+            vmaDestroyImage(allocator, resource.image, resource.allocation);
+        } else if (resource.image != VK_NULL_HANDLE) {
+            vkDestroyImage(device, resource.image, nullptr);
+        }
+    }
+
+    if (m_aliasedMemory != VK_NULL_HANDLE) {
+        vmaFreeMemory(allocator, m_aliasedMemory);
+        m_aliasedMemory = VK_NULL_HANDLE;
+    }
+
+    m_passes.clear();
+    m_resources.clear();
+    m_aliasedMemorySize = 0;
+    m_unaliasedMemorySize = 0;
+    m_compiled = false;
+}
+
+}
@@ -0,0 +1,201 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <vk_mem_alloc.h>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace Plaster {
+
+class RenderGraph;
+
+// How a pass uses an image. Each access implies the layout, pipeline stages,
+// memory access and image usage, so passes never spell out barriers.
+enum class RenderGraphAccess {
+    COLOR_ATTACHMENT,     // Written as a color attachment of a graphics pass
+    DEPTH_ATTACHMENT,     // Depth tested and written in a graphics pass
+    SAMPLED_FRAGMENT,     // Sampled in a fragment shader
+    SAMPLED_COMPUTE,      // Sampled in a compute shader
+    STORAGE_READ,         // Read as a storage image in a compute shader
+    STORAGE_WRITE,        // Written as a storage image in a compute shader
+    TRANSFER_SRC,         // Copy or blit source
+    TRANSFER_DST          // Copy or blit destination
+};
+
+enum class RenderGraphPassType {
+    GRAPHICS,  // Its attachment writes become a render pass the graph begins and ends
+    COMPUTE,
+    TRANSFER
+};
+
+using RenderGraphResource = uint32_t;
+using RenderGraphPassId = uint32_t;
+
+struct RenderGraphImageDesc {
+    VkExtent2D extent = {0, 0};
+    VkFormat format = VK_FORMAT_UNDEFINED;
+    VkImageAspectFlags aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+};
+
+// Where an imported image is before the graph runs, or must be left after it.
+// An UNDEFINED final layout leaves the image in whatever state the last pass
+// used it.
+struct RenderGraphImageState {
+    VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+    VkPipelineStageFlags stage = 0;
+    VkAccessFlags access = 0;
+};
+
+// Handed to each pass while recording
+struct RenderGraphContext {
+    VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+    VkDevice device = VK_NULL_HANDLE;
+    const RenderGraph* graph = nullptr;        // For resolving image views
+    VkRenderPass renderPass = VK_NULL_HANDLE;  // The pass's render pass, graphics passes only
+    VkExtent2D extent = {0, 0};                // Attachment size, graphics passes only
+};
+
+using RenderGraphRecordFunc = std::function<void(const RenderGraphContext&)>;
+
+// A frame's passes and the images flowing between them, declared up front
+// and compiled once, then executed every frame.
+//
+// compile() drops passes whose results nothing consumes, derives every
+// transient image's usage from how it is accessed, and places transient
+// images whose lifetimes do not overlap in the same VMA memory. Images only
+// ever used as attachments inside a single pass are created with
+// TRANSIENT_ATTACHMENT usage in lazily allocated memory where the device
+// offers it, so tilers can keep them on chip. Graphics passes get a render
+// pass built from their attachment writes, storing only what a later pass
+// reads.
+//
+// execute() records the live passes in declaration order with the image
+// barriers and layout transitions between them worked out from the declared
+// accesses, including the dependency on whichever image last used aliased
+// memory. Transient images start each execution undefined, so a graph must
+// not be executed again until its previous execution has completed; keep one
+// graph per frame in flight.
+class RenderGraph {
+public:
+    RenderGraph();
+    ~RenderGraph();
+
+    // Declaration. Resources and passes are addressed by the returned index.
+    RenderGraphResource createImage(const std::string& name, const RenderGraphImageDesc& desc);
+    RenderGraphResource importImage(const std::string& name, const RenderGraphImageDesc& desc,
+                                    const RenderGraphImageState& initialState,
+                                    const RenderGraphImageState& finalState);
+
+    RenderGraphPassId addPass(const std::string& name, RenderGraphPassType type, RenderGraphRecordFunc record);
+    void read(RenderGraphPassId pass, RenderGraphResource resource, RenderGraphAccess access);
+    void write(RenderGraphPassId pass, RenderGraphResource resource, RenderGraphAccess access,
+               VkAttachmentLoadOp loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE, VkClearValue clearValue = {});
+
+    // Keep a pass even when nothing reads what it writes
+    void setSideEffect(RenderGraphPassId pass);
+
+    // Cull, allocate and build render passes. Declaration is closed afterwards.
+    bool compile(VkDevice device, VmaAllocator allocator);
+    void destroy(VkDevice device, VmaAllocator allocator);
+
+    bool isCompiled() const { return m_compiled; }
+
+    // Point an imported resource at this execution's image
+    void setImportedImage(RenderGraphResource resource, VkImage image, VkImageView view);
+
+    void execute(VkCommandBuffer commandBuffer, VkDevice device);
+
+    VkImage getImage(RenderGraphResource resource) const { return m_resources[resource].image; }
+    VkImageView getImageView(RenderGraphResource resource) const { return m_resources[resource].view; }
+    const RenderGraphImageDesc& getDesc(RenderGraphResource resource) const { return m_resources[resource].desc; }
+
+    // Null for culled and non-graphics passes
+    VkRenderPass getRenderPass(RenderGraphPassId pass) const { return m_passes[pass].renderPass; }
+    bool isPassCulled(RenderGraphPassId pass) const { return !m_passes[pass].live; }
+
+    // Memory behind aliased transient images, and what they would take unaliased
+    VkDeviceSize getAliasedMemorySize() const { return m_aliasedMemorySize; }
+    VkDeviceSize getUnaliasedMemorySize() const { return m_unaliasedMemorySize; }
+
+private:
+    struct Access {
+        RenderGraphResource resource;
+        RenderGraphAccess access;
+        bool write;
+        VkAttachmentLoadOp loadOp;
+        VkClearValue clearValue;
+    };
+
+    struct Pass {
+        std::string name;
+        RenderGraphPassType type;
+        RenderGraphRecordFunc record;
+        std::vector<Access> accesses;
+        bool sideEffect = false;
+        bool live = false;
+
+        // Graphics passes: render pass, attachments in framebuffer order, and
+        // framebuffers by attachment views (imported views change per frame)
+        VkRenderPass renderPass = VK_NULL_HANDLE;
+        std::vector<uint32_t> attachments;  // Indices into accesses
+        VkExtent2D extent = {0, 0};
+        std::vector<std::pair<std::vector<VkImageView>, VkFramebuffer>> framebuffers;
+    };
+
+    // Barrier bookkeeping: the last write, and the stages that have read since
+    struct TrackedState {
+        VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkPipelineStageFlags writeStage = 0;
+        VkAccessFlags writeAccess = 0;
+        VkPipelineStageFlags readStages = 0;
+        VkAccessFlags readAccess = 0;
+    };
+
+    struct Resource {
+        std::string name;
+        RenderGraphImageDesc desc;
+        bool imported = false;
+        RenderGraphImageState initialState;
+        RenderGraphImageState finalState;
+
+        // Filled in by compile()
+        VkImageUsageFlags usage = 0;
+        uint32_t firstPass = UINT32_MAX;
+        uint32_t lastPass = 0;
+        bool transientAttachment = false;
+        bool aliased = false;
+        VkDeviceSize memoryOffset = 0;
+        VkMemoryRequirements memoryRequirements = {};
+        std::vector<RenderGraphResource> aliasPredecessors;  // Earlier occupants of overlapping memory
+
+        VkImage image = VK_NULL_HANDLE;
+        VkImageView view = VK_NULL_HANDLE;
+        VmaAllocation allocation = VK_NULL_HANDLE;  // Own allocation, when not aliased
+
+        TrackedState state;
+    };
+
+    std::vector<Resource> m_resources;
+    std::vector<Pass> m_passes;
+    VmaAllocation m_aliasedMemory;
+    VkDeviceSize m_aliasedMemorySize;
+    VkDeviceSize m_unaliasedMemorySize;
+    bool m_compiled;
+
+    void cullPasses();
+    void computeLifetimes();
+    bool createImages(VkDevice device, VmaAllocator allocator);
+    bool placeAliasedImages(VmaAllocator allocator, const std::vector<RenderGraphResource>& candidates);
+    bool createImageView(VkDevice device, Resource& resource);
+    bool createRenderPass(VkDevice device, RenderGraphPassId passId);
+    VkFramebuffer getFramebuffer(VkDevice device, Pass& pass);
+
+    bool isReadLater(RenderGraphResource resource, uint32_t afterPass) const;
+    void addBarrier(Resource& resource, RenderGraphAccess access, bool write,
+                    std::vector<VkImageMemoryBarrier>& barriers,
+                    VkPipelineStageFlags& srcStages, VkPipelineStageFlags& dstStages);
+};
+
+}
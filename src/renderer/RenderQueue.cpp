@@ -0,0 +1,173 @@
+#include "RenderQueue.h"
+#include "../scene/Scene.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace Plaster {
+
+uint64_t RenderQueue::makeSortKey(uint32_t pipelineId, VkIndexType indexType, uint32_t materialId, uint32_t meshId,
+                                  uint32_t lod, float depth) {
+    const uint64_t depthMax = (1ull << DEPTH_BITS) - 1;
+    uint64_t depthBits = static_cast<uint64_t>(std::clamp(depth, 0.0f, 1.0f) * static_cast<float>(depthMax));
+
+    uint64_t key = 0;
+    key |= (static_cast<uint64_t>(pipelineId) & ((1ull << PIPELINE_BITS) - 1)) << (INDEX_TYPE_BITS + MATERIAL_BITS + MESH_BITS + LOD_BITS + DEPTH_BITS);
+    key |= static_cast<uint64_t>(indexType == VK_INDEX_TYPE_UINT16 ? 1 : 0) << (MATERIAL_BITS + MESH_BITS + LOD_BITS + DEPTH_BITS);
+    key |= (static_cast<uint64_t>(materialId) & ((1ull << MATERIAL_BITS) - 1)) << (MESH_BITS + LOD_BITS + DEPTH_BITS);
+    key |= (static_cast<uint64_t>(meshId) & ((1ull << MESH_BITS) - 1)) << (LOD_BITS + DEPTH_BITS);
+    key |= (static_cast<uint64_t>(lod) & ((1ull << LOD_BITS) - 1)) << DEPTH_BITS;
+    key |= std::min(depthBits, depthMax);
+    return key;
+}
+
+void RenderQueue::build(const Scene& scene, float viewportHeight, const LodSelection& lodSelection) {
+    const auto& objects = scene.getObjects();
+    const Camera& camera = scene.getCamera();
+
+    m_items.clear();
+    m_batches.clear();
+    m_instanceOrder.clear();
+    m_candidates.clear();
+    m_bounds.clear();
+
+    m_frustum.update(camera.getProjectionMatrix() * camera.getViewMatrix());
+
+    uint32_t drawableCount = 0;
+    for (const RenderObject& obj : objects) {
+        drawableCount += (obj.mesh && obj.material) ? 1 : 0;
+    }
+
+    // Below the threshold every drawable's tight bounds go straight to the SIMD
+    // test; above it the BVH first rejects whole subtrees outside the frustum
+    if (objects.size() < TREE_CULL_THRESHOLD) {
+        m_bounds.reserve(drawableCount);
+        for (uint32_t i = 0; i < static_cast<uint32_t>(objects.size()); i++) {
+            if (!objects[i].mesh || !objects[i].material) {
+                continue;
+            }
+            m_candidates.push_back(i);
+            m_bounds.push(scene.getObjectBounds(i));
+        }
+    } else {
+        scene.queryFrustum(m_frustum, m_queryResults);
+        m_bounds.reserve(m_queryResults.size());
+        for (uint32_t i : m_queryResults) {
+            const RenderObject& obj = objects[i];
+            if (!obj.mesh || !obj.material) {
+                continue;
+            }
+            m_candidates.push_back(i);
+            m_bounds.push(scene.getObjectBounds(i));
+        }
+    }
+
+    uint32_t visibleCount = cullBoxes(m_frustum, m_bounds, m_visible);
+    m_culledCount = drawableCount - visibleCount;
+
+    const glm::vec3 cameraPos = camera.getPosition();
+    const glm::vec3 forward = camera.getForward();
+    const float nearPlane = camera.getNearPlane();
+    const float depthRange = camera.getFarPlane() - nearPlane;
+
+    if (m_structureVersion != scene.getStructureVersion() || m_objectLods.size() != objects.size()) {
+        m_objectLods.assign(objects.size(), 0);
+        m_structureVersion = scene.getStructureVersion();
+    }
+
+    // Screen pixels per world unit at distance 1, at the internal resolution
+    const float pixelScale = std::abs(camera.getProjectionMatrix()[1][1]) * 0.5f * viewportHeight;
+
+    m_items.reserve(visibleCount);
+    for (size_t c = 0; c < m_candidates.size(); c++) {
+        if (!m_visible[c]) {
+            continue;
+        }
+        const uint32_t i = m_candidates[c];
+        const RenderObject& obj = objects[i];
+
+        float viewDepth = glm::dot(obj.position - cameraPos, forward);
+        float depth = (viewDepth - nearPlane) / depthRange;
+
+        // Mesh units project to more pixels the larger the object's scale
+        float distance = std::max(glm::length(scene.getObjectBounds(i).getCenter() - cameraPos), nearPlane);
+        float maxScale = std::max(std::abs(obj.scale.x), std::max(std::abs(obj.scale.y), std::abs(obj.scale.z)));
+        uint32_t lod = obj.mesh->selectLod(pixelScale * maxScale / distance, m_objectLods[i], lodSelection);
+        m_objectLods[i] = static_cast<uint8_t>(lod);
+
+        // One opaque pipeline per vertex format
+        const uint32_t pipelineId = static_cast<uint32_t>(obj.mesh->getVertexFormat());
+        m_items.push_back({makeSortKey(pipelineId, obj.mesh->getIndexType(), obj.material->getSortId(),
+                                       obj.mesh->getSortId(), lod, depth), i});
+    }
+
+    radixSort(m_items, m_scratch);
+
+    // Coalesce runs of identical state into instanced batches. Compare the real
+    // pointers rather than key bits so id wrap-around can never merge two meshes.
+    m_instanceOrder.reserve(m_items.size());
+    for (const SortItem& item : m_items) {
+        const RenderObject& obj = objects[item.objectIndex];
+        const uint32_t pipelineId = static_cast<uint32_t>(item.key >> (INDEX_TYPE_BITS + MATERIAL_BITS + MESH_BITS + LOD_BITS + DEPTH_BITS));
+        const uint32_t lod = m_objectLods[item.objectIndex];
+
+        if (m_batches.empty() ||
+            m_batches.back().mesh != obj.mesh.get() ||
+            m_batches.back().material != obj.material.get() ||
+            m_batches.back().pipelineId != pipelineId ||
+            m_batches.back().lod != lod) {
+            m_batches.push_back({obj.mesh.get(), obj.material.get(), pipelineId, lod,
+                                 static_cast<uint32_t>(m_instanceOrder.size()), 0});
+        }
+
+        m_batches.back().instanceCount++;
+        m_instanceOrder.push_back(item.objectIndex);
+    }
+}
+
+void RenderQueue::radixSort(std::vector<SortItem>& items, std::vector<SortItem>& scratch) {
+    const size_t count = items.size();
+    if (count < 2) {
+        return;
+    }
+
+    // Build all eight byte histograms in a single pass
+    std::array<std::array<uint32_t, 256>, 8> histograms{};
+    for (const SortItem& item : items) {
+        for (uint32_t pass = 0; pass < 8; pass++) {
+            histograms[pass][(item.key >> (pass * 8)) & 0xFF]++;
+        }
+    }
+
+    scratch.resize(count);
+    std::vector<SortItem>* src = &items;
+    std::vector<SortItem>* dst = &scratch;
+
+    for (uint32_t pass = 0; pass < 8; pass++) {
+        auto& histogram = histograms[pass];
+
+        // Every key has the same byte here; this pass would not reorder anything
+        if (histogram[((*src)[0].key >> (pass * 8)) & 0xFF] == count) {
+            continue;
+        }
+
+        uint32_t offset = 0;
+        for (uint32_t& bucket : histogram) {
+            uint32_t bucketCount = bucket;
+            bucket = offset;
+            offset += bucketCount;
+        }
+
+        for (const SortItem& item : *src) {
+            (*dst)[histogram[(item.key >> (pass * 8)) & 0xFF]++] = item;
+        }
+
+        std::swap(src, dst);
+    }
+
+    if (src != &items) {
+        items.swap(scratch);
+    }
+}
+
+}
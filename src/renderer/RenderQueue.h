@@ -0,0 +1,92 @@
+#pragma once
+
+#include "Mesh.h"
+#include "../math/Frustum.h"
+#include <cstdint>
+#include <vector>
+
+namespace Plaster {
+
+class PlastibooMaterial;
+class Scene;
+
+// One instanced draw: consecutive queue entries sharing pipeline, material, mesh and LOD
+struct DrawBatch {
+   Mesh* mesh;
+   PlastibooMaterial* material;
+   uint32_t pipelineId;
+   uint32_t lod;
+   uint32_t firstInstance;  // First slot in the per-frame object buffer
+   uint32_t instanceCount;
+};
+
+// Sits between VulkanRenderer::renderScene and recordCommandBuffer. Drawables
+// are frustum tested on their tight world AABBs, after a query on the scene's
+// BVH once the scene is large enough for that to pay off. Every remaining
+// object picks an LOD from its projected size and gets a 64-bit key (pipeline
+// | index type | material | mesh | LOD | depth, most significant first), keys
+// are radix sorted, and runs of equal state become instanced batches so the
+// recorder only rebinds state when it actually changes.
+class RenderQueue {
+public:
+   static const uint32_t PIPELINE_BITS = 7;
+   static const uint32_t INDEX_TYPE_BITS = 1;
+   static const uint32_t MATERIAL_BITS = 16;
+   static const uint32_t MESH_BITS = 16;
+   static const uint32_t LOD_BITS = 2;
+   static const uint32_t DEPTH_BITS = 22;
+
+   // Object count from which the BVH frustum query beats testing every
+   // object's bounds in SIMD (see benchmarks/SpatialIndexBenchmark.cpp)
+   static const uint32_t TREE_CULL_THRESHOLD = 150000;
+
+   RenderQueue() = default;
+   ~RenderQueue() = default;
+
+   // depth is normalised view depth in [0, 1]; nearer objects sort first.
+   // Meshes of one index type sort together so the index buffer rebinds rarely.
+   static uint64_t makeSortKey(uint32_t pipelineId, VkIndexType indexType, uint32_t materialId, uint32_t meshId,
+                               uint32_t lod, float depth);
+
+   // Cull, build, sort and batch this frame's draws from the scene's camera.
+   // viewportHeight is the internal render height LOD errors are projected to.
+   void build(const Scene& scene, float viewportHeight, const LodSelection& lodSelection);
+
+   const std::vector<DrawBatch>& getBatches() const { return m_batches; }
+
+   // Object index for each slot, so transforms can be written in batch order
+   const std::vector<uint32_t>& getInstanceOrder() const { return m_instanceOrder; }
+
+   // Drawable objects not drawn in the last build, by the BVH or the exact test
+   uint32_t getCulledCount() const { return m_culledCount; }
+
+private:
+   struct SortItem {
+      uint64_t key;
+      uint32_t objectIndex;
+   };
+
+   // LSD radix sort on the key, 8 bits per pass; passes where every key shares
+   // the same byte are skipped
+   static void radixSort(std::vector<SortItem>& items, std::vector<SortItem>& scratch);
+
+   // Frustum culling scratch: BVH results, drawable candidates and their bounds
+   Frustum m_frustum;
+   BoundsSoA m_bounds;
+   std::vector<uint32_t> m_queryResults;
+   std::vector<uint32_t> m_candidates;
+   std::vector<uint8_t> m_visible;
+   uint32_t m_culledCount = 0;
+
+   // LOD each object used last frame, for hysteresis; reset when the scene's
+   // structure changes since object indices may have moved
+   std::vector<uint8_t> m_objectLods;
+   uint64_t m_structureVersion = UINT64_MAX;
+
+   std::vector<SortItem> m_items;
+   std::vector<SortItem> m_scratch;
+   std::vector<DrawBatch> m_batches;
+   std::vector<uint32_t> m_instanceOrder;
+};
+
+}
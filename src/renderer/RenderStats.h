@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Plaster {
+
+// Per-frame counters filled in while recording, shown by the stats overlay
+struct RenderStats {
+   uint32_t objects = 0;          // Drawn this frame, after frustum culling
+   uint32_t culledObjects = 0;    // Rejected by the CPU frustum test
+   uint32_t drawCalls = 0;
+   uint32_t prepassDrawCalls = 0;
+
+   // Binds actually recorded
+   uint32_t pipelineBinds = 0;
+   uint32_t descriptorSetBinds = 0;
+   uint32_t vertexBufferBinds = 0;
+
+   // Binds skipped because the state was already bound by the previous draw
+   uint32_t bindsSaved = 0;
+
+   // Fragment shader invocations in the scene pass and invocations per scene
+   // pixel, from a pipeline statistics query (a couple of frames old). Zero
+   // when the device cannot report them.
+   uint64_t fragmentInvocations = 0;
+   float overdraw = 0.0f;
+
+   // CPU time spent recording the frame's primary command buffer, including
+   // waiting for any secondary buffers recorded on worker threads
+   float recordMs = 0.0f;
+
+   void reset() { *this = RenderStats{}; }
+
+   // Fold in counters recorded on another thread
+   void accumulate(const RenderStats& other) {
+      objects += other.objects;
+      culledObjects += other.culledObjects;
+      drawCalls += other.drawCalls;
+      prepassDrawCalls += other.prepassDrawCalls;
+      pipelineBinds += other.pipelineBinds;
+      descriptorSetBinds += other.descriptorSetBinds;
+      vertexBufferBinds += other.vertexBufferBinds;
+      bindsSaved += other.bindsSaved;
+   }
+};
+
+}
@@ -1,28 +1,156 @@
 #include "ShaderCompiler.h"
+#include "../core/ThreadPool.h"
 #include <cmath>
 #include <shaderc/shaderc.hpp>
+#include <filesystem>
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <iomanip>
+#include <algorithm>
 
-namespace Plaster() {
+namespace Plaster {
 
-ShaderCompiler::ShaderCompiler(){
+// Bump when the compile options change in a way the cache key does not capture
+static const uint32_t SHADER_CACHE_VERSION = 1;
+static const uint32_t SPIRV_MAGIC = 0x07230203;
+static const shaderc_optimization_level OPTIMIZATION_LEVEL = shaderc_optimization_level_performance;
+
+// 64-bit FNV-1a, chained so several fields feed one key
+static uint64_t hashBytes(const void* data, size_t size, uint64_t hash = 0xcbf29ce484222325ull) {
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  for (size_t i = 0; i < size; i++) {
+    hash ^= bytes[i];
+    hash *= 0x100000001b3ull;
+  }
+  return hash;
+}
+
+ShaderCompiler::ShaderCompiler()
+  : m_cacheDirectory(DEFAULT_CACHE_DIRECTORY)
+  , m_cacheHits(0)
+  , m_cacheMisses(0) {
 }
 
 ShaderCompiler::~ShaderCompiler(){
+  // Joins the workers after they drain any outstanding compiles
+  m_pool.reset();
 }
 
 bool ShaderCompiler::compileFromSource(
   const std::string& source,
   ShaderStage stage,
   const std::string& entryPoint, 
-  std::vector<uint32_t>& spirvOut
+  std::vector<uint32_t>& spirvOut,
+  const std::string& sourceName
+) {
+  ShaderCompileResult result = compile(source, stage, entryPoint, sourceName);
+  if (!result.success) {
+    m_lastError = result.error;
+    return false;
+  }
+
+  spirvOut = std::move(result.spirv);
+  return true;
+}
+
+bool ShaderCompiler::compileFromFile(
+  const std::string& filePath,
+  ShaderStage stage,
+  const std::string& entryPoint,
+  std::vector<uint32_t>& spirvOut 
+) {
+  std::string source;
+  if (!readFile(filePath, source)) {
+    m_lastError = "Failed to open file: " + filePath;
+    return false;
+  }
+
+  return compileFromSource(source, stage, entryPoint, spirvOut, filePath); 
+}
+
+std::future<ShaderCompileResult> ShaderCompiler::compileFromSourceAsync(
+  std::string source,
+  ShaderStage stage,
+  std::string entryPoint,
+  std::string sourceName
+) {
+  return getPool().submit([this, source = std::move(source), stage,
+                           entryPoint = std::move(entryPoint), sourceName = std::move(sourceName)]() {
+    return compile(source, stage, entryPoint, sourceName);
+  });
+}
+
+std::future<ShaderCompileResult> ShaderCompiler::compileFromFileAsync(
+  std::string filePath,
+  ShaderStage stage,
+  std::string entryPoint,
+  ShaderDefines defines
+) {
+  // File reads happen on the worker too, so the caller never blocks on disk
+  return getPool().submit([this, filePath = std::move(filePath), stage, entryPoint = std::move(entryPoint),
+                           defines = std::move(defines)]() {
+    std::string source;
+    if (!readFile(filePath, source)) {
+      ShaderCompileResult result;
+      result.error = "Failed to open file: " + filePath;
+      std::cerr << result.error << std::endl;
+      return result;
+    }
+    return compile(source, stage, entryPoint, filePath, defines);
+  });
+}
+
+ShaderCacheStats ShaderCompiler::getCacheStats() const {
+  ShaderCacheStats stats;
+  stats.hits = m_cacheHits.load();
+  stats.misses = m_cacheMisses.load();
+  return stats;
+}
+
+void ShaderCompiler::resetCacheStats() {
+  m_cacheHits = 0;
+  m_cacheMisses = 0;
+}
+
+ThreadPool& ShaderCompiler::getPool() {
+  if (!m_pool) {
+    uint32_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+    m_pool = std::make_unique<ThreadPool>(threadCount);
+  }
+  return *m_pool;
+}
+
+bool ShaderCompiler::readFile(const std::string& filePath, std::string& source) {
+  std::ifstream file(filePath);
+  if (!file.is_open()) {
+    return false;
+  }
+
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  source = buffer.str();
+  return true;
+}
+
+ShaderCompileResult ShaderCompiler::compile(
+  const std::string& source,
+  ShaderStage stage,
+  const std::string& entryPoint,
+  const std::string& sourceName,
+  const ShaderDefines& defines
 ) {
-  shaderc::Compiler compiler;
+  ShaderCompileResult compileResult;
+
+  // shaderc::Compiler is not safe to share between threads, so each thread
+  // (main or worker) gets its own
+  thread_local shaderc::Compiler compiler;
   shaderc::CompileOptions options;
 
-  options.SetOptimizationLevel(shaderc_optimization_level_performance);
+  options.SetOptimizationLevel(OPTIMIZATION_LEVEL);
+  for (const auto& define : defines) {
+    options.AddMacroDefinition(define.first, define.second);
+  }
 
   options.SetTargetEnvironment(shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_2);
 
@@ -38,46 +166,143 @@ bool ShaderCompiler::compileFromSource(
       kind = shaderc_glsl_compute_shader;
       break;
     default:
-      m_lastError = "Unknown stage";
-      return false;
+      compileResult.error = "Unknown stage";
+      return compileResult;
   }
 
-  shaderc::SpvCompilationResult result = compiler.CompileGlslToSpv(
+  // Preprocessing is cheap next to compilation and resolves macros, so the
+  // hash only changes when the code the compiler would see changes
+  shaderc::PreprocessedSourceCompilationResult preprocessed = compiler.PreprocessGlsl(
     source,
     kind,
-    "shader.glsl",
+    sourceName.c_str(),
+    options
+  );
+
+  if (preprocessed.GetCompilationStatus() != shaderc_compilation_status_success) {
+    compileResult.error = preprocessed.GetErrorMessage();
+    std::cerr << "Shader preprocessing failed: " << compileResult.error << std::endl;
+    return compileResult;
+  }
+
+  std::string preprocessedSource(preprocessed.cbegin(), preprocessed.cend());
+
+  uint64_t key = 0;
+  if (!m_cacheDirectory.empty()) {
+    unsigned int spvVersion = 0, spvRevision = 0;
+    shaderc_get_spv_version(&spvVersion, &spvRevision);
+
+    uint32_t fields[] = {
+      SHADER_CACHE_VERSION,
+      static_cast<uint32_t>(stage),
+      static_cast<uint32_t>(OPTIMIZATION_LEVEL),
+      spvVersion,
+      spvRevision
+    };
+    key = hashBytes(preprocessedSource.data(), preprocessedSource.size());
+    key = hashBytes(entryPoint.data(), entryPoint.size(), key);
+    key = hashBytes(fields, sizeof(fields), key);
+
+    if (loadCached(key, compileResult.spirv)) {
+      m_cacheHits++;
+      compileResult.success = true;
+      compileResult.cacheHit = true;
+      std::cout << "Shader cache hit: " << sourceName << " (" << compileResult.spirv.size() << " words)" << std::endl;
+      return compileResult;
+    }
+    m_cacheMisses++;
+  }
+
+  shaderc::SpvCompilationResult result = compiler.CompileGlslToSpv(
+    preprocessedSource,
+    kind,
+    sourceName.c_str(),
     entryPoint.c_str(),
     options 
   );
 
   if (result.GetCompilationStatus() != shaderc_compilation_status_success) {
-    m_lastError = result.GetErrorMessage();
-    std::cerr << "Shader compilation failed: " << m_lastError << std::endl;
-    return false;
+    compileResult.error = result.GetErrorMessage();
+    std::cerr << "Shader compilation failed: " << compileResult.error << std::endl;
+    return compileResult;
   }
 
-  spirvOut = std::vector<uint32_t>(result.cbegin(), result.cend());
+  compileResult.spirv = std::vector<uint32_t>(result.cbegin(), result.cend());
+  compileResult.success = true;
+
+  if (!m_cacheDirectory.empty()) {
+    storeCached(key, compileResult.spirv);
+  }
   
-  std::cout << "Shader compiled successfully (" << spirvOut.size() << " words)" << std::endl;
-  return true;
+  std::cout << "Shader compiled successfully (" << compileResult.spirv.size() << " words)" << std::endl;
+  return compileResult;
 }
-bool ShaderCompiler::compileFromFile(
-  const std::string& filePath,
-  ShaderStage stage,
-  const std::string& entryPoint,
-  std::vector<uint32_t>& spirvOut 
-) {
-  std::ifstream file(filePath);
+
+void ShaderCompiler::clearCache() {
+  if (m_cacheDirectory.empty()) return;
+
+  std::error_code ec;
+  uint32_t removed = 0;
+  for (const auto& entry : std::filesystem::directory_iterator(m_cacheDirectory, ec)) {
+    if (entry.path().extension() == ".spv" && std::filesystem::remove(entry.path(), ec)) {
+      removed++;
+    }
+  }
+
+  std::cout << "Cleared shader cache (" << removed << " entries)" << std::endl;
+}
+
+std::string ShaderCompiler::getCachePath(uint64_t key) const {
+  std::ostringstream name;
+  name << std::hex << std::setw(16) << std::setfill('0') << key << ".spv";
+  return (std::filesystem::path(m_cacheDirectory) / name.str()).string();
+}
+
+bool ShaderCompiler::loadCached(uint64_t key, std::vector<uint32_t>& spirvOut) const {
+  std::ifstream file(getCachePath(key), std::ios::binary | std::ios::ate);
   if (!file.is_open()) {
-    m_lastError = "Failed to open file: " + filePath;
     return false;
   }
-  
-  std::stringstream buffer;
-  buffer << file.rdbuf();
-  std::string source = buffer.str();
 
-  return compileFromSource(source, stage, entryPoint, spirvOut); 
+  std::streamsize size = file.tellg();
+  if (size <= 0 || size % sizeof(uint32_t) != 0) {
+    return false;
+  }
+
+  std::vector<uint32_t> spirv(static_cast<size_t>(size) / sizeof(uint32_t));
+  file.seekg(0);
+  file.read(reinterpret_cast<char*>(spirv.data()), size);
+
+  // A torn or foreign file is treated as a miss and overwritten on store
+  if (!file || spirv[0] != SPIRV_MAGIC) {
+    return false;
+  }
+
+  spirvOut = std::move(spirv);
+  return true;
+}
+
+void ShaderCompiler::storeCached(uint64_t key, const std::vector<uint32_t>& spirv) const {
+  std::error_code ec;
+  std::filesystem::create_directories(m_cacheDirectory, ec);
+
+  std::string path = getCachePath(key);
+  // Workers may store the same key at once; give each its own temp file
+  std::string tempPath = path + "." + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id())) + ".tmp";
+  {
+    std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+      std::cerr << "Failed to write shader cache entry: " << tempPath << std::endl;
+      return;
+    }
+    file.write(reinterpret_cast<const char*>(spirv.data()),
+               static_cast<std::streamsize>(spirv.size() * sizeof(uint32_t)));
+  }
+
+  std::filesystem::rename(tempPath, path, ec);
+  if (ec) {
+    std::cerr << "Failed to store shader cache entry: " << ec.message() << std::endl;
+  }
 }
 
 VkShaderModule ShaderCompiler::createShaderModule(
@@ -106,6 +331,7 @@ VkShaderStageFlagBits ShaderCompiler::getVulkanStage(ShaderStage stage) {
     case ShaderStage::COMPUTE:
       return VK_SHADER_STAGE_COMPUTE_BIT;
   }
+  return VK_SHADER_STAGE_ALL;
 }
 
 }
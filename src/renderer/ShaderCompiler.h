@@ -2,52 +2,126 @@
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <cstdint>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <utility>
 #include <vulkan/vulkan.h>
 
 namespace Plaster {
+class ThreadPool;
+
 enum class ShaderStage {
   VERTEX,
   FRAGMENT,
-  COMPUTE 
+  COMPUTE
 };
 
 struct ShaderModule {
   VkShaderModule module;
   ShaderStage stage;
-  std::vector<uint32> spirvCode;
+  std::vector<uint32_t> spirvCode;
   std::string entryPoint;
 };
 
+// Counters for the on-disk SPIR-V cache
+struct ShaderCacheStats {
+  uint32_t hits = 0;
+  uint32_t misses = 0;
+};
+
+// Preprocessor macros (name, value) for building a permutation of one source
+using ShaderDefines = std::vector<std::pair<std::string, std::string>>;
+
+// Outcome of one compile; async compiles report errors here instead of getLastError()
+struct ShaderCompileResult {
+  bool success = false;
+  bool cacheHit = false;
+  std::vector<uint32_t> spirv;
+  std::string error;
+};
+
 class ShaderCompiler {
 public:
+  static constexpr const char* DEFAULT_CACHE_DIRECTORY = "cache/shaders";
+
   ShaderCompiler();
   ~ShaderCompiler();
 
-  bool compileFromSource() {
+  bool compileFromSource(
     const std::string& source,
-    ShaderStage stage, 
+    ShaderStage stage,
     const std::string& entryPoint,
-    std::vector<uint32_t>& spirvOut
-  };
-  
-  bool compileFromFile() {
+    std::vector<uint32_t>& spirvOut,
+    const std::string& sourceName = "shader.glsl"
+  );
+
+  bool compileFromFile(
       const std::string& filePath,
       ShaderStage stage,
       const std::string& entryPoint,
-      std::vector<uint32_t>& spirvOut 
-  };
+      std::vector<uint32_t>& spirvOut
+  );
+
+  // Compile on a worker pool owned by this compiler. Each worker keeps its own
+  // shaderc::Compiler, so independent stages and permutations build in
+  // parallel. The compiler must outlive the returned futures, and async calls
+  // should come from a single thread.
+  std::future<ShaderCompileResult> compileFromSourceAsync(
+      std::string source,
+      ShaderStage stage,
+      std::string entryPoint,
+      std::string sourceName = "shader.glsl"
+  );
+
+  std::future<ShaderCompileResult> compileFromFileAsync(
+      std::string filePath,
+      ShaderStage stage,
+      std::string entryPoint,
+      ShaderDefines defines = {}
+  );
 
   VkShaderModule createShaderModule(
       VkDevice device,
-      const std::vector<uin32_t>& spirvCode 
+      const std::vector<uint32_t>& spirvCode
   );
-  
+
+  // SPIR-V is cached on disk keyed by a hash of the preprocessed source, stage,
+  // entry point, optimisation level and compiler version. An empty directory
+  // disables the cache.
+  void setCacheDirectory(const std::string& directory) { m_cacheDirectory = directory; }
+  const std::string& getCacheDirectory() const { return m_cacheDirectory; }
+
+  // Delete every cached SPIR-V blob so the next compile goes through shaderc
+  void clearCache();
+
+  ShaderCacheStats getCacheStats() const;
+  void resetCacheStats();
+
   const std::string& getLastError() const { return m_lastError; }
 
 private:
     std::string m_lastError;
-    
+    std::string m_cacheDirectory;
+    std::atomic<uint32_t> m_cacheHits;
+    std::atomic<uint32_t> m_cacheMisses;
+    std::unique_ptr<ThreadPool> m_pool;
+
     VkShaderStageFlagBits getVulkanStage(ShaderStage stage);
+
+    ThreadPool& getPool();
+    ShaderCompileResult compile(
+      const std::string& source,
+      ShaderStage stage,
+      const std::string& entryPoint,
+      const std::string& sourceName,
+      const ShaderDefines& defines = {}
+    );
+    static bool readFile(const std::string& filePath, std::string& source);
+
+    std::string getCachePath(uint64_t key) const;
+    bool loadCached(uint64_t key, std::vector<uint32_t>& spirvOut) const;
+    void storeCached(uint64_t key, const std::vector<uint32_t>& spirv) const;
 };
 }
-
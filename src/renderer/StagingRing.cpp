@@ -0,0 +1,101 @@
+#include "StagingRing.h"
+#include <iostream>
+
+namespace Plaster {
+
+StagingRing::StagingRing()
+    : m_allocator(nullptr)
+    , m_buffer(VK_NULL_HANDLE)
+    , m_allocation(nullptr)
+    , m_mapped(nullptr)
+    , m_capacity(0)
+    , m_head(0)
+    , m_tail(0)
+{
+}
+
+StagingRing::~StagingRing() {
+    if (m_buffer != VK_NULL_HANDLE) {
+        std::cerr << "Warning: StagingRing destroyed without explicit cleanup" << std::endl;
+    }
+}
+
+bool StagingRing::create(VmaAllocator allocator, VkDeviceSize capacity) {
+    m_allocator = allocator;
+
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = capacity;
+    bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    VmaAllocationCreateInfo allocInfo{};
+    allocInfo.usage = VMA_MEMORY_USAGE_CPU_ONLY;
+    allocInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+    VmaAllocationInfo allocationInfo{};
+    if (vmaCreateBuffer(m_allocator, &bufferInfo, &allocInfo, &m_buffer, &m_allocation, &allocationInfo) != VK_SUCCESS) {
+        std::cerr << "Failed to create staging ring (" << capacity << " bytes)" << std::endl;
+        return false;
+    }
+
+    m_mapped = static_cast<uint8_t*>(allocationInfo.pMappedData);
+    m_capacity = capacity;
+    m_head = 0;
+    m_tail = 0;
+    return true;
+}
+
+void StagingRing::destroy() {
+    if (m_buffer != VK_NULL_HANDLE) {
+        vmaDestroyBuffer(m_allocator, m_buffer, m_allocation);
+        m_buffer = VK_NULL_HANDLE;
+        m_allocation = nullptr;
+        m_mapped = nullptr;
+        m_capacity = 0;
+        m_head = 0;
+        m_tail = 0;
+    }
+}
+
+bool StagingRing::allocate(VkDeviceSize size, VkDeviceSize alignment, StagingRegion& region) {
+    if (m_buffer == VK_NULL_HANDLE || size == 0 || size > m_capacity) {
+        return false;
+    }
+
+    // Once drained, restart at the beginning of the buffer so the whole
+    // capacity is available again
+    if (m_head == m_tail) {
+        m_head = (m_head + m_capacity - 1) / m_capacity * m_capacity;
+        m_tail = m_head;
+    }
+
+    uint64_t start = (m_head + alignment - 1) / alignment * alignment;
+
+    // Never split an allocation across the end of the buffer; skip to the start instead
+    if (start % m_capacity + size > m_capacity) {
+        start = (start / m_capacity + 1) * m_capacity;
+    }
+    if (start + size - m_tail > m_capacity) {
+        return false;
+    }
+
+    m_head = start + size;
+
+    region.buffer = m_buffer;
+    region.offset = static_cast<VkDeviceSize>(start % m_capacity);
+    region.mapped = m_mapped + region.offset;
+    return true;
+}
+
+void StagingRing::flush(const StagingRegion& region, VkDeviceSize size) {
+    vmaFlushAllocation(m_allocator, m_allocation, region.offset, size);
+}
+
+void StagingRing::release(uint64_t mark) {
+    if (mark > m_tail) {
+        m_tail = mark;
+    }
+}
+
+}
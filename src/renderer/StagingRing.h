@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <vk_mem_alloc.h>
+#include <cstdint>
+
+namespace Plaster {
+
+// Region of the staging ring handed out for one upload
+struct StagingRegion {
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VkDeviceSize offset = 0;
+    void* mapped = nullptr;
+};
+
+// One persistently mapped host buffer used as a ring for staging uploads.
+// Positions are tracked as ever-increasing byte counters, so a batch records
+// the head after its last allocation and releasing that mark reclaims
+// everything the batch used once its fence has signalled. Releases must
+// happen in allocation order.
+class StagingRing {
+public:
+    StagingRing();
+    ~StagingRing();
+
+    StagingRing(const StagingRing&) = delete;
+    StagingRing& operator=(const StagingRing&) = delete;
+
+    bool create(VmaAllocator allocator, VkDeviceSize capacity);
+    void destroy();
+
+    // Carve size bytes from the ring. Fails when the ring is too full; the
+    // caller should wait for in-flight uploads to retire and try again. An
+    // empty ring always fits anything up to its capacity.
+    bool allocate(VkDeviceSize size, VkDeviceSize alignment, StagingRegion& region);
+
+    // Write back CPU writes to a region (no-op on HOST_COHERENT memory)
+    void flush(const StagingRegion& region, VkDeviceSize size);
+
+    // Position after the most recent allocation
+    uint64_t getHead() const { return m_head; }
+
+    // Reclaim everything allocated before mark
+    void release(uint64_t mark);
+
+    VkDeviceSize getCapacity() const { return m_capacity; }
+    VkDeviceSize getUsed() const { return static_cast<VkDeviceSize>(m_head - m_tail); }
+
+private:
+    VmaAllocator m_allocator;
+    VkBuffer m_buffer;
+    VmaAllocation m_allocation;
+    uint8_t* m_mapped;
+    VkDeviceSize m_capacity;
+    uint64_t m_head;
+    uint64_t m_tail;
+};
+
+}
@@ -1,5 +1,4 @@
   #include "Texture.h"
-  #include "VulkanBuffer.h"
   #include <iostream>
 
   namespace Plaster {
@@ -20,8 +19,7 @@
   bool Texture::createFromData(
       VmaAllocator allocator,
       VkDevice device,
-      VkCommandPool commandPool,
-      VkQueue graphicsQueue,
+      UploadManager& uploads,
       const void* pixels,
       uint32_t width,
       uint32_t height,
@@ -33,20 +31,6 @@
 
       VkDeviceSize imageSize = width * height * 4; // Assuming 4 bytes per pixel (RGBA)
 
-      // Create staging buffer
-      VulkanBuffer stagingBuffer;
-      if (!stagingBuffer.create(
-          allocator,
-          imageSize,
-          VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-          VMA_MEMORY_USAGE_CPU_ONLY,
-          VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT
-      )) {
-          return false;
-      }
-
-      stagingBuffer.copyData(allocator, pixels, imageSize);
-
       // Create image
       VkImageCreateInfo imageInfo{};
       imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
@@ -68,21 +52,16 @@
 
       if (vmaCreateImage(allocator, &imageInfo, &allocInfo, &m_image, &m_allocation, nullptr) != VK_SUCCESS) {
           std::cerr << "Failed to create image!" << std::endl;
-          stagingBuffer.destroy(allocator);
           return false;
       }
 
-      // Transition layout and copy
-      transitionImageLayout(device, commandPool, graphicsQueue, m_image, format,
-                           VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-
-      copyBufferToImage(device, commandPool, graphicsQueue, stagingBuffer.getBuffer(),
-                       m_image, width, height);
-
-      transitionImageLayout(device, commandPool, graphicsQueue, m_image, format,
-                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-
-      stagingBuffer.destroy(allocator);
+      // Staging, layout transitions and the copy are batched by the upload manager
+      std::optional<UploadHandle> upload = uploads.uploadImage(pixels, imageSize, m_image, width, height);
+      if (!upload) {
+          std::cerr << "Failed to queue texture upload!" << std::endl;
+          return false;
+      }
+      m_upload = *upload;
 
       // Create image view
       VkImageViewCreateInfo viewInfo{};
@@ -127,11 +106,10 @@
   bool Texture::createPlaceholder(
       VmaAllocator allocator,
       VkDevice device,
-      VkCommandPool commandPool,
-      VkQueue graphicsQueue
+      UploadManager& uploads
   ) {
       uint32_t white = 0xFFFFFFFF; // RGBA white
-      return createFromData(allocator, device, commandPool, graphicsQueue,
+      return createFromData(allocator, device, uploads,
                            &white, 1, 1, VK_FORMAT_R8G8B8A8_UNORM, VK_FILTER_NEAREST);
   }
 
@@ -151,123 +129,4 @@
       }
   }
 
-  void Texture::transitionImageLayout(
-      VkDevice device,
-      VkCommandPool commandPool,
-      VkQueue graphicsQueue,
-      VkImage image,
-      VkFormat format,
-      VkImageLayout oldLayout,
-      VkImageLayout newLayout
-  ) {
-      VkCommandBufferAllocateInfo allocInfo{};
-      allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-      allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-      allocInfo.commandPool = commandPool;
-      allocInfo.commandBufferCount = 1;
-
-      VkCommandBuffer commandBuffer;
-      vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer);
-
-      VkCommandBufferBeginInfo beginInfo{};
-      beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-      beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-
-      vkBeginCommandBuffer(commandBuffer, &beginInfo);
-
-      VkImageMemoryBarrier barrier{};
-      barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-      barrier.oldLayout = oldLayout;
-      barrier.newLayout = newLayout;
-      barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-      barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-      barrier.image = image;
-      barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-      barrier.subresourceRange.baseMipLevel = 0;
-      barrier.subresourceRange.levelCount = 1;
-      barrier.subresourceRange.baseArrayLayer = 0;
-      barrier.subresourceRange.layerCount = 1;
-
-      VkPipelineStageFlags sourceStage;
-      VkPipelineStageFlags destinationStage;
-
-      if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) {
-          barrier.srcAccessMask = 0;
-          barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-          sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-          destinationStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-      } else if (oldLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL && newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
-          barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-          barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-          sourceStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-          destinationStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-      } else {
-          throw std::runtime_error("Unsupported layout transition!");
-      }
-
-      vkCmdPipelineBarrier(commandBuffer, sourceStage, destinationStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
-
-      vkEndCommandBuffer(commandBuffer);
-
-      VkSubmitInfo submitInfo{};
-      submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-      submitInfo.commandBufferCount = 1;
-      submitInfo.pCommandBuffers = &commandBuffer;
-
-      vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
-      vkQueueWaitIdle(graphicsQueue);
-
-      vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
   }
-
-  void Texture::copyBufferToImage(
-      VkDevice device,
-      VkCommandPool commandPool,
-      VkQueue graphicsQueue,
-      VkBuffer buffer,
-      VkImage image,
-      uint32_t width,
-      uint32_t height
-  ) {
-      VkCommandBufferAllocateInfo allocInfo{};
-      allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-      allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-      allocInfo.commandPool = commandPool;
-      allocInfo.commandBufferCount = 1;
-
-      VkCommandBuffer commandBuffer;
-      vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer);
-
-      VkCommandBufferBeginInfo beginInfo{};
-      beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-      beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-
-      vkBeginCommandBuffer(commandBuffer, &beginInfo);
-
-      VkBufferImageCopy region{};
-      region.bufferOffset = 0;
-      region.bufferRowLength = 0;
-      region.bufferImageHeight = 0;
-      region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-      region.imageSubresource.mipLevel = 0;
-      region.imageSubresource.baseArrayLayer = 0;
-      region.imageSubresource.layerCount = 1;
-      region.imageOffset = {0, 0, 0};
-      region.imageExtent = {width, height, 1};
-
-      vkCmdCopyBufferToImage(commandBuffer, buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
-
-      vkEndCommandBuffer(commandBuffer);
-
-      VkSubmitInfo submitInfo{};
-      submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-      submitInfo.commandBufferCount = 1;
-      submitInfo.pCommandBuffers = &commandBuffer;
-
-      vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
-      vkQueueWaitIdle(graphicsQueue);
-
-      vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
-  }
-
-  
\ No newline at end of file
@@ -3,6 +3,7 @@
   #include <vulkan/vulkan.h>
   #include <vk_mem_alloc.h>
   #include <string>
+  #include "UploadManager.h"
 
   namespace Plaster {
 
@@ -11,12 +12,12 @@
       Texture();
       ~Texture();
 
-      // Create texture from raw data
+      // Create texture from raw data. The pixel copy is queued on the upload
+      // manager and lands with its next flush.
       bool createFromData(
           VmaAllocator allocator,
           VkDevice device,
-          VkCommandPool commandPool,
-          VkQueue graphicsQueue,
+          UploadManager& uploads,
           const void* pixels,
           uint32_t width,
           uint32_t height,
@@ -28,8 +29,7 @@
       bool createPlaceholder(
           VmaAllocator allocator,
           VkDevice device,
-          VkCommandPool commandPool,
-          VkQueue graphicsQueue
+          UploadManager& uploads
       );
 
       // Destroy texture
@@ -42,6 +42,10 @@
       uint32_t getWidth() const { return m_width; }
       uint32_t getHeight() const { return m_height; }
 
+      // True once the pixel upload has finished on the GPU
+      bool isResident(const UploadManager& uploads) const { return uploads.isComplete(m_upload); }
+      UploadHandle getUploadHandle() const { return m_upload; }
+
   private:
       VkImage m_image;
       VmaAllocation m_allocation;
@@ -49,26 +53,7 @@
       VkSampler m_sampler;
       uint32_t m_width;
       uint32_t m_height;
-
-      void transitionImageLayout(
-          VkDevice device,
-          VkCommandPool commandPool,
-          VkQueue graphicsQueue,
-          VkImage image,
-          VkFormat format,
-          VkImageLayout oldLayout,
-          VkImageLayout newLayout
-      );
-
-      void copyBufferToImage(
-          VkDevice device,
-          VkCommandPool commandPool,
-          VkQueue graphicsQueue,
-          VkBuffer buffer,
-          VkImage image,
-          uint32_t width,
-          uint32_t height
-      );
+      UploadHandle m_upload;
   };
 
   }
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <cstdint>
 
 namespace Plaster {
 
@@ -21,12 +22,19 @@ struct LightUBO {
    float padding[3];
 };
 
-// Per-object transform (matches shader set 1, binding 0)
-struct ObjectUBO {
+// Per-object transform and material (matches shader set 1, binding 0).
+// Stored as one std430 array per frame and indexed with gl_InstanceIndex.
+// The normal matrix drops its unused last column so the struct stays 128
+// bytes, a power of two that per-object descriptor offsets rely on.
+struct ObjectData {
    glm::mat4 model;
-   glm::mat4 normalMatrix;
+   glm::mat3x4 normalMatrix;  // Columns of the 3x3 normal matrix, w unused
+   uint32_t materialIndex;    // MaterialRegistry slot
+   uint32_t padding[3];
 };
 
+static_assert(sizeof(ObjectData) == 128, "ObjectData must match the shaders' std430 layout");
+
 // Helper to create warm horror lighting
 inline LightUBO createPlastibooLighting() {
    LightUBO lights{};
@@ -0,0 +1,512 @@
+#include "UploadManager.h"
+#include <cstring>
+#include <iostream>
+#include <algorithm>
+#include <limits>
+
+namespace Plaster {
+
+// Satisfies the vkCmdCopyBufferToImage offset rules for every colour format we upload
+static const VkDeviceSize STAGING_ALIGNMENT = 16;
+
+UploadManager::UploadManager()
+    : m_allocator(nullptr)
+    , m_device(VK_NULL_HANDLE)
+    , m_graphicsFamily(0)
+    , m_graphicsQueue(VK_NULL_HANDLE)
+    , m_transferFamily(0)
+    , m_transferQueue(VK_NULL_HANDLE)
+    , m_transferPool(VK_NULL_HANDLE)
+    , m_graphicsPool(VK_NULL_HANDLE)
+    , m_nextBatchId(1)
+    , m_completedBatchId(0)
+    , m_dedicatedStagingCount(0)
+{
+}
+
+UploadManager::~UploadManager() {
+    if (m_device != VK_NULL_HANDLE) {
+        std::cerr << "Warning: UploadManager destroyed without explicit cleanup" << std::endl;
+    }
+}
+
+std::optional<uint32_t> UploadManager::findTransferQueueFamily(VkPhysicalDevice physicalDevice) {
+    uint32_t count = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &count, nullptr);
+    std::vector<VkQueueFamilyProperties> families(count);
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &count, families.data());
+
+    std::optional<uint32_t> fallback;
+    for (uint32_t i = 0; i < count; i++) {
+        VkQueueFlags flags = families[i].queueFlags;
+        if (families[i].queueCount == 0 || !(flags & VK_QUEUE_TRANSFER_BIT) || (flags & VK_QUEUE_GRAPHICS_BIT)) {
+            continue;
+        }
+        if (!(flags & VK_QUEUE_COMPUTE_BIT)) {
+            return i;
+        }
+        if (!fallback) {
+            fallback = i;
+        }
+    }
+    return fallback;
+}
+
+bool UploadManager::create(
+    VmaAllocator allocator,
+    VkDevice device,
+    uint32_t graphicsFamily,
+    VkQueue graphicsQueue,
+    uint32_t transferFamily,
+    VkQueue transferQueue,
+    VkDeviceSize stagingSize
+) {
+    m_allocator = allocator;
+    m_device = device;
+    m_graphicsFamily = graphicsFamily;
+    m_graphicsQueue = graphicsQueue;
+
+    // A "dedicated" queue from the graphics family needs no ownership transfer,
+    // so treat it as the graphics queue path
+    if (transferQueue != VK_NULL_HANDLE && transferFamily != graphicsFamily) {
+        m_transferFamily = transferFamily;
+        m_transferQueue = transferQueue;
+    } else {
+        m_transferFamily = graphicsFamily;
+        m_transferQueue = VK_NULL_HANDLE;
+    }
+
+    // Keep the ring a whole number of copy alignments so wrapped offsets stay aligned
+    stagingSize = std::max(stagingSize / STAGING_ALIGNMENT, VkDeviceSize(1)) * STAGING_ALIGNMENT;
+    if (!m_ring.create(m_allocator, stagingSize)) {
+        return false;
+    }
+
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    poolInfo.queueFamilyIndex = m_graphicsFamily;
+    if (vkCreateCommandPool(m_device, &poolInfo, nullptr, &m_graphicsPool) != VK_SUCCESS) {
+        std::cerr << "Failed to create upload command pool" << std::endl;
+        return false;
+    }
+
+    if (hasDedicatedTransferQueue()) {
+        poolInfo.queueFamilyIndex = m_transferFamily;
+        if (vkCreateCommandPool(m_device, &poolInfo, nullptr, &m_transferPool) != VK_SUCCESS) {
+            std::cerr << "Failed to create transfer command pool" << std::endl;
+            return false;
+        }
+        std::cout << "Uploads use dedicated transfer queue family " << m_transferFamily << std::endl;
+    } else {
+        std::cout << "Uploads use the graphics queue" << std::endl;
+    }
+    std::cout << "Staging ring: " << (stagingSize >> 20) << " MB" << std::endl;
+
+    return true;
+}
+
+void UploadManager::destroy() {
+    if (m_device == VK_NULL_HANDLE) return;
+
+    if (m_recording) {
+        flush();
+    }
+    while (!m_inFlight.empty()) {
+        Batch& batch = m_inFlight.front();
+        vkWaitForFences(m_device, 1, &batch.fence, VK_TRUE, std::numeric_limits<uint64_t>::max());
+        retire(batch);
+        destroyBatch(batch);
+        m_inFlight.pop_front();
+    }
+    for (Batch& batch : m_free) {
+        destroyBatch(batch);
+    }
+    m_free.clear();
+    m_ring.destroy();
+
+    if (m_transferPool != VK_NULL_HANDLE) {
+        vkDestroyCommandPool(m_device, m_transferPool, nullptr);
+        m_transferPool = VK_NULL_HANDLE;
+    }
+    if (m_graphicsPool != VK_NULL_HANDLE) {
+        vkDestroyCommandPool(m_device, m_graphicsPool, nullptr);
+        m_graphicsPool = VK_NULL_HANDLE;
+    }
+    m_transferQueue = VK_NULL_HANDLE;
+    m_device = VK_NULL_HANDLE;
+}
+
+std::optional<UploadHandle> UploadManager::uploadBuffer(const void* data, VkDeviceSize size, VkBuffer dstBuffer,
+                                                        VkDeviceSize dstOffset) {
+    if (size == 0) return UploadHandle{};
+
+    StagingRegion staging;
+    StagingBuffer dedicated;
+    if (!stage(data, size, staging, dedicated)) return std::nullopt;
+
+    Batch* batch = beginBatch();
+    if (!batch) {
+        releaseDedicated(dedicated);
+        return std::nullopt;
+    }
+    track(*batch, dedicated);
+
+    VkBufferCopy region{};
+    region.srcOffset = staging.offset;
+    region.dstOffset = dstOffset;
+    region.size = size;
+    vkCmdCopyBuffer(batch->transferCommands, staging.buffer, dstBuffer, 1, &region);
+
+    if (hasDedicatedTransferQueue()) {
+        VkBufferMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        barrier.srcQueueFamilyIndex = m_transferFamily;
+        barrier.dstQueueFamilyIndex = m_graphicsFamily;
+        barrier.buffer = dstBuffer;
+        barrier.offset = dstOffset;
+        barrier.size = size;
+
+        // Release half; the matching acquire is recorded on the graphics queue at flush
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = 0;
+        vkCmdPipelineBarrier(batch->transferCommands, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT |
+                                VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+        batch->bufferAcquires.push_back(barrier);
+    }
+
+    return UploadHandle{ batch->id };
+}
+
+std::optional<UploadHandle> UploadManager::uploadImage(const void* pixels, VkDeviceSize size, VkImage image,
+                                                       uint32_t width, uint32_t height) {
+    if (size == 0) return UploadHandle{};
+
+    StagingRegion staging;
+    StagingBuffer dedicated;
+    if (!stage(pixels, size, staging, dedicated)) return std::nullopt;
+
+    Batch* batch = beginBatch();
+    if (!batch) {
+        releaseDedicated(dedicated);
+        return std::nullopt;
+    }
+    track(*batch, dedicated);
+
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    vkCmdPipelineBarrier(batch->transferCommands, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    VkBufferImageCopy region{};
+    region.bufferOffset = staging.offset;
+    region.bufferRowLength = 0;
+    region.bufferImageHeight = 0;
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.mipLevel = 0;
+    region.imageSubresource.baseArrayLayer = 0;
+    region.imageSubresource.layerCount = 1;
+    region.imageOffset = {0, 0, 0};
+    region.imageExtent = {width, height, 1};
+    vkCmdCopyBufferToImage(batch->transferCommands, staging.buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+    if (hasDedicatedTransferQueue()) {
+        // The layout transition happens once, split across the release and acquire
+        barrier.srcQueueFamilyIndex = m_transferFamily;
+        barrier.dstQueueFamilyIndex = m_graphicsFamily;
+        barrier.dstAccessMask = 0;
+        vkCmdPipelineBarrier(batch->transferCommands, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        batch->imageAcquires.push_back(barrier);
+    } else {
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(batch->transferCommands, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                             0, 0, nullptr, 0, nullptr, 1, &barrier);
+    }
+
+    return UploadHandle{ batch->id };
+}
+
+void UploadManager::flush() {
+    if (!m_recording) return;
+
+    Batch batch = std::move(*m_recording);
+    m_recording.reset();
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+
+    if (hasDedicatedTransferQueue()) {
+        vkEndCommandBuffer(batch.transferCommands);
+
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &batch.transferCommands;
+        submitInfo.signalSemaphoreCount = 1;
+        submitInfo.pSignalSemaphores = &batch.transferDone;
+        if (vkQueueSubmit(m_transferQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+            std::cerr << "Failed to submit upload batch to transfer queue" << std::endl;
+        }
+
+        // Acquire ownership on the graphics queue. Frames submitted after this
+        // are ordered behind the acquire barriers, so they see the new data.
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        vkBeginCommandBuffer(batch.acquireCommands, &beginInfo);
+        vkCmdPipelineBarrier(batch.acquireCommands, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                             VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+                             VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                             0, 0, nullptr,
+                             static_cast<uint32_t>(batch.bufferAcquires.size()), batch.bufferAcquires.data(),
+                             static_cast<uint32_t>(batch.imageAcquires.size()), batch.imageAcquires.data());
+        vkEndCommandBuffer(batch.acquireCommands);
+
+        VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+        submitInfo.waitSemaphoreCount = 1;
+        submitInfo.pWaitSemaphores = &batch.transferDone;
+        submitInfo.pWaitDstStageMask = &waitStage;
+        submitInfo.pCommandBuffers = &batch.acquireCommands;
+        submitInfo.signalSemaphoreCount = 0;
+        submitInfo.pSignalSemaphores = nullptr;
+        if (vkQueueSubmit(m_graphicsQueue, 1, &submitInfo, batch.fence) != VK_SUCCESS) {
+            std::cerr << "Failed to submit upload acquire batch" << std::endl;
+        }
+    } else {
+        // Make the copies visible to every later submission on this queue
+        VkMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT |
+                                VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(batch.transferCommands, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+                             VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                             0, 1, &barrier, 0, nullptr, 0, nullptr);
+        vkEndCommandBuffer(batch.transferCommands);
+
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &batch.transferCommands;
+        if (vkQueueSubmit(m_graphicsQueue, 1, &submitInfo, batch.fence) != VK_SUCCESS) {
+            std::cerr << "Failed to submit upload batch" << std::endl;
+        }
+    }
+
+    m_inFlight.push_back(std::move(batch));
+}
+
+void UploadManager::update() {
+    while (!m_inFlight.empty()) {
+        Batch& batch = m_inFlight.front();
+        if (vkGetFenceStatus(m_device, batch.fence) != VK_SUCCESS) {
+            break;
+        }
+        retire(batch);
+        m_free.push_back(std::move(batch));
+        m_inFlight.pop_front();
+    }
+}
+
+bool UploadManager::isComplete(UploadHandle handle) const {
+    if (handle.batch <= m_completedBatchId) return true;
+    if (m_recording && m_recording->id == handle.batch) return false;
+
+    for (const Batch& batch : m_inFlight) {
+        if (batch.id == handle.batch) {
+            return vkGetFenceStatus(m_device, batch.fence) == VK_SUCCESS;
+        }
+    }
+    return true;
+}
+
+void UploadManager::wait(UploadHandle handle) {
+    if (m_recording && m_recording->id == handle.batch) {
+        flush();
+    }
+    for (Batch& batch : m_inFlight) {
+        if (batch.id == handle.batch) {
+            vkWaitForFences(m_device, 1, &batch.fence, VK_TRUE, std::numeric_limits<uint64_t>::max());
+            break;
+        }
+    }
+    update();
+}
+
+UploadManager::Batch* UploadManager::beginBatch() {
+    if (m_recording) return &*m_recording;
+    if (m_device == VK_NULL_HANDLE) {
+        std::cerr << "UploadManager used before create()" << std::endl;
+        return nullptr;
+    }
+
+    Batch batch;
+    if (!m_free.empty()) {
+        batch = std::move(m_free.back());
+        m_free.pop_back();
+        vkResetFences(m_device, 1, &batch.fence);
+    } else {
+        VkCommandBufferAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandBufferCount = 1;
+
+        allocInfo.commandPool = hasDedicatedTransferQueue() ? m_transferPool : m_graphicsPool;
+        if (vkAllocateCommandBuffers(m_device, &allocInfo, &batch.transferCommands) != VK_SUCCESS) {
+            std::cerr << "Failed to allocate upload command buffer" << std::endl;
+            return nullptr;
+        }
+
+        if (hasDedicatedTransferQueue()) {
+            allocInfo.commandPool = m_graphicsPool;
+            if (vkAllocateCommandBuffers(m_device, &allocInfo, &batch.acquireCommands) != VK_SUCCESS) {
+                std::cerr << "Failed to allocate upload acquire command buffer" << std::endl;
+                destroyBatch(batch);
+                return nullptr;
+            }
+
+            VkSemaphoreCreateInfo semaphoreInfo{};
+            semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+            if (vkCreateSemaphore(m_device, &semaphoreInfo, nullptr, &batch.transferDone) != VK_SUCCESS) {
+                std::cerr << "Failed to create upload semaphore" << std::endl;
+                destroyBatch(batch);
+                return nullptr;
+            }
+        }
+
+        VkFenceCreateInfo fenceInfo{};
+        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        if (vkCreateFence(m_device, &fenceInfo, nullptr, &batch.fence) != VK_SUCCESS) {
+            std::cerr << "Failed to create upload fence" << std::endl;
+            destroyBatch(batch);
+            return nullptr;
+        }
+    }
+
+    batch.id = m_nextBatchId++;
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(batch.transferCommands, &beginInfo);
+
+    m_recording = std::move(batch);
+    return &*m_recording;
+}
+
+bool UploadManager::stage(const void* data, VkDeviceSize size, StagingRegion& region, StagingBuffer& dedicated) {
+    if (size <= m_ring.getCapacity()) {
+        bool allocated = m_ring.allocate(size, STAGING_ALIGNMENT, region);
+        while (!allocated) {
+            // Ring is full: submit what has been recorded and retire the oldest batch
+            if (m_recording) {
+                flush();
+            }
+            if (m_inFlight.empty()) {
+                break;
+            }
+            vkWaitForFences(m_device, 1, &m_inFlight.front().fence, VK_TRUE, std::numeric_limits<uint64_t>::max());
+            update();
+            allocated = m_ring.allocate(size, STAGING_ALIGNMENT, region);
+        }
+
+        if (allocated) {
+            std::memcpy(region.mapped, data, static_cast<size_t>(size));
+            m_ring.flush(region, size);
+            return true;
+        }
+    }
+
+    // Larger than the whole ring, or still no room once it has drained: give
+    // it a buffer of its own, freed when the batch retires
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = size;
+    bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    VmaAllocationCreateInfo allocInfo{};
+    allocInfo.usage = VMA_MEMORY_USAGE_CPU_ONLY;
+    allocInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+    VmaAllocationInfo allocationInfo{};
+    if (vmaCreateBuffer(m_allocator, &bufferInfo, &allocInfo, &dedicated.buffer, &dedicated.allocation, &allocationInfo) != VK_SUCCESS) {
+        std::cerr << "Failed to create staging buffer (" << size << " bytes)" << std::endl;
+        return false;
+    }
+
+    std::memcpy(allocationInfo.pMappedData, data, static_cast<size_t>(size));
+    vmaFlushAllocation(m_allocator, dedicated.allocation, 0, size);
+
+    region.buffer = dedicated.buffer;
+    region.offset = 0;
+    region.mapped = allocationInfo.pMappedData;
+    m_dedicatedStagingCount++;
+    return true;
+}
+
+void UploadManager::releaseDedicated(StagingBuffer& dedicated) {
+    if (dedicated.buffer != VK_NULL_HANDLE) {
+        vmaDestroyBuffer(m_allocator, dedicated.buffer, dedicated.allocation);
+        dedicated = StagingBuffer{};
+    }
+}
+
+void UploadManager::track(Batch& batch, const StagingBuffer& dedicated) {
+    if (dedicated.buffer != VK_NULL_HANDLE) {
+        batch.stagingBuffers.push_back(dedicated);
+    } else {
+        batch.ringMark = m_ring.getHead();
+    }
+}
+
+void UploadManager::retire(Batch& batch) {
+    for (StagingBuffer& staging : batch.stagingBuffers) {
+        vmaDestroyBuffer(m_allocator, staging.buffer, staging.allocation);
+    }
+    batch.stagingBuffers.clear();
+    m_ring.release(batch.ringMark);
+    batch.ringMark = 0;
+    batch.bufferAcquires.clear();
+    batch.imageAcquires.clear();
+
+    if (batch.id > m_completedBatchId) {
+        m_completedBatchId = batch.id;
+    }
+}
+
+void UploadManager::destroyBatch(Batch& batch) {
+    if (batch.fence != VK_NULL_HANDLE) {
+        vkDestroyFence(m_device, batch.fence, nullptr);
+        batch.fence = VK_NULL_HANDLE;
+    }
+    if (batch.transferDone != VK_NULL_HANDLE) {
+        vkDestroySemaphore(m_device, batch.transferDone, nullptr);
+        batch.transferDone = VK_NULL_HANDLE;
+    }
+    // Command buffers are released with their pools
+}
+
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include "StagingRing.h"
+#include <vulkan/vulkan.h>
+#include <vk_mem_alloc.h>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <vector>
+
+namespace Plaster {
+
+// Identifies the batch an upload was recorded into. An empty handle (batch 0)
+// refers to nothing and is always complete.
+struct UploadHandle {
+    uint64_t batch = 0;
+};
+
+// Batches CPU-to-GPU copies into one submission per flush instead of a
+// submit-and-wait per resource. Copies run on a dedicated transfer queue when
+// the device has one, with queue family ownership handed to the graphics queue
+// afterwards; otherwise they run on the graphics queue. Completion is tracked
+// with one fence per batch.
+//
+// Staging memory comes from a persistently mapped ring that is reclaimed as
+// batches retire. Uploads larger than the whole ring get a dedicated staging
+// buffer instead.
+class UploadManager {
+public:
+    UploadManager();
+    ~UploadManager();
+
+    UploadManager(const UploadManager&) = delete;
+    UploadManager& operator=(const UploadManager&) = delete;
+
+    // Queue family with TRANSFER but not GRAPHICS support, preferring one
+    // without COMPUTE as well (the DMA engine on most discrete GPUs)
+    static std::optional<uint32_t> findTransferQueueFamily(VkPhysicalDevice physicalDevice);
+
+    static const VkDeviceSize DEFAULT_STAGING_SIZE = 64ull * 1024 * 1024;
+
+    // transferQueue may be VK_NULL_HANDLE to run everything on the graphics queue
+    bool create(
+        VmaAllocator allocator,
+        VkDevice device,
+        uint32_t graphicsFamily,
+        VkQueue graphicsQueue,
+        uint32_t transferFamily,
+        VkQueue transferQueue,
+        VkDeviceSize stagingSize = DEFAULT_STAGING_SIZE
+    );
+
+    // Waits for outstanding batches and frees everything
+    void destroy();
+
+    // Copy data into a device-local buffer. The data is staged immediately, so
+    // the caller's memory may be released as soon as this returns. Returns
+    // nothing if the copy could not be queued; an empty handle only means
+    // there was nothing to copy.
+    std::optional<UploadHandle> uploadBuffer(const void* data, VkDeviceSize size, VkBuffer dstBuffer,
+                                             VkDeviceSize dstOffset = 0);
+
+    // Copy tightly packed pixels into mip 0 of an image created in UNDEFINED
+    // layout; the image ends up in SHADER_READ_ONLY_OPTIMAL. Fails like
+    // uploadBuffer().
+    std::optional<UploadHandle> uploadImage(const void* pixels, VkDeviceSize size, VkImage image,
+                                            uint32_t width, uint32_t height);
+
+    // Submit everything queued since the last flush as a single batch. Later
+    // graphics submissions are ordered after it, so no CPU wait is needed
+    // before drawing the uploaded resources.
+    void flush();
+
+    // Poll fences and recycle finished batches; call once per frame
+    void update();
+
+    // True once the GPU has finished the copy, i.e. the asset is resident
+    bool isComplete(UploadHandle handle) const;
+
+    // Flush if needed and block until the handle completes
+    void wait(UploadHandle handle);
+
+    bool hasDedicatedTransferQueue() const { return m_transferQueue != VK_NULL_HANDLE; }
+
+    const StagingRing& getStagingRing() const { return m_ring; }
+
+    // Uploads that did not fit the ring and got their own staging buffer
+    uint32_t getDedicatedStagingCount() const { return m_dedicatedStagingCount; }
+
+private:
+    struct StagingBuffer {
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VmaAllocation allocation = nullptr;
+    };
+
+    struct Batch {
+        uint64_t id = 0;
+        VkCommandBuffer transferCommands = VK_NULL_HANDLE;
+        VkCommandBuffer acquireCommands = VK_NULL_HANDLE;   // Graphics queue, dedicated transfer only
+        VkSemaphore transferDone = VK_NULL_HANDLE;
+        VkFence fence = VK_NULL_HANDLE;
+        std::vector<StagingBuffer> stagingBuffers;   // Dedicated, oversized uploads only
+        uint64_t ringMark = 0;                       // Ring head after this batch's last allocation
+        std::vector<VkBufferMemoryBarrier> bufferAcquires;
+        std::vector<VkImageMemoryBarrier> imageAcquires;
+    };
+
+    VmaAllocator m_allocator;
+    VkDevice m_device;
+    uint32_t m_graphicsFamily;
+    VkQueue m_graphicsQueue;
+    uint32_t m_transferFamily;
+    VkQueue m_transferQueue;
+    VkCommandPool m_transferPool;
+    VkCommandPool m_graphicsPool;
+
+    uint64_t m_nextBatchId;
+    uint64_t m_completedBatchId;
+    std::optional<Batch> m_recording;
+    std::deque<Batch> m_inFlight;
+    std::vector<Batch> m_free;
+
+    StagingRing m_ring;
+    uint32_t m_dedicatedStagingCount;
+
+    // Copies data into staging memory, retiring in-flight batches if the ring
+    // is full. Called before beginBatch() since it may flush.
+    bool stage(const void* data, VkDeviceSize size, StagingRegion& region, StagingBuffer& dedicated);
+
+    Batch* beginBatch();
+    // Frees a dedicated staging buffer no batch took ownership of
+    void releaseDedicated(StagingBuffer& dedicated);
+    void track(Batch& batch, const StagingBuffer& dedicated);
+    void retire(Batch& batch);
+    void destroyBatch(Batch& batch);
+};
+
+}
@@ -8,6 +8,7 @@ VulkanBuffer::VulkanBuffer()
   : m_buffer(VK_NULL_HANDLE)
   , m_allocation(nullptr)
   , m_size(0)
+  , m_mappedData(nullptr)
 {
 }
 
@@ -36,10 +37,12 @@ bool VulkanBuffer::create (
   allocInfo.usage = memoryUsage;
   allocInfo.flags = flags;
 
-  if (vmaCreateBuffer(allocator, &bufferInfo, &allocInfo, &m_buffer, &m_allocation, nullptr) != VK_SUCCESS) {
+  VmaAllocationInfo allocationInfo{};
+  if (vmaCreateBuffer(allocator, &bufferInfo, &allocInfo, &m_buffer, &m_allocation, &allocationInfo) != VK_SUCCESS) {
     std::cerr << "Failed to create Vulkan Buffer" << std::endl;
     return false;
   }
+  m_mappedData = allocationInfo.pMappedData;
   return true;
 }
 
@@ -49,23 +52,39 @@ void VulkanBuffer::destroy(VmaAllocator allocator) {
     m_buffer = VK_NULL_HANDLE;
     m_allocation = nullptr;
     m_size = 0;
+    m_mappedData = nullptr;
   }
 }
 
 void* VulkanBuffer::map(VmaAllocator allocator) {
+  if (m_mappedData) {
+    return m_mappedData;
+  }
   void* data;
   vmaMapMemory(allocator, m_allocation, &data);
   return data;
 }
 
 void VulkanBuffer::unmap(VmaAllocator allocator) {
-  VmaUnmapMemory(allocator, m_allocation);
+  if (m_mappedData) {
+    return;
+  }
+  vmaUnmapMemory(allocator, m_allocation);
 }
 
 void VulkanBuffer::copyData(VmaAllocator allocator, const void* data, VkDeviceSize size) {
   void* mapped = map(allocator);
   memcpy(mapped, data, size);
   unmap(allocator);
+  flush(allocator, 0, size);
+}
+
+void VulkanBuffer::flush(VmaAllocator allocator, VkDeviceSize offset, VkDeviceSize size) {
+  vmaFlushAllocation(allocator, m_allocation, offset, size);
+}
+
+void VulkanBuffer::invalidate(VmaAllocator allocator, VkDeviceSize offset, VkDeviceSize size) {
+  vmaInvalidateAllocation(allocator, m_allocation, offset, size);
 }
 
 }
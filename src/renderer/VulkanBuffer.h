@@ -22,14 +22,24 @@ public:
 
   void copyData(VmaAllocator allocator, const void* data, VkDeviceSize size);
 
+  // Flush a written range; required when the memory type is not HOST_COHERENT
+  void flush(VmaAllocator allocator, VkDeviceSize offset, VkDeviceSize size);
+
+  // Invalidate a range before reading GPU writes on the host
+  void invalidate(VmaAllocator allocator, VkDeviceSize offset, VkDeviceSize size);
+
   VkBuffer getBuffer() const { return m_buffer; }
   VmaAllocation getAllocation() const { return m_allocation; }
   VkDeviceSize getSize() const { return m_size; }
 
+  // Non-null only when created with VMA_ALLOCATION_CREATE_MAPPED_BIT
+  void* getMappedData() const { return m_mappedData; }
+
 private:
   VkBuffer m_buffer;
   VmaAllocation m_allocation;
   VkDeviceSize m_size;
+  void* m_mappedData;
 };
 
 }
@@ -10,6 +10,11 @@
 #include <set>
 #include <algorithm>
 #include <fstream>
+#include <chrono>
+#include <cstring>
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
 
 VulkanRenderer::VulkanRenderer() = default;
 
@@ -25,15 +30,12 @@ void VulkanRenderer::initialize(const Window& window) {
     pickPhysicalDevice();
     createLogicalDevice();
     createAllocator();
+    createUploadManager();
+    createGeometryPool();
+    createPipelineCache();
     createSwapChain();
     createImageViews();
-    createRenderPass();
-    createDescriptorResources();
-    createGraphicsPipeline();
-    createFramebuffers();
-    createCommandPool();
-    createCommandBuffers();
-    createSyncObjects();
+    createRenderResources();
     
     // Initialize ImGui
     QueueFamilyIndices indices = findQueueFamilies(_physicalDevice);
@@ -51,16 +53,65 @@ void VulkanRenderer::initialize(const Window& window) {
     _initialized = true;
 }
 
+void VulkanRenderer::initializeHeadless(uint32_t width, uint32_t height) {
+    _headless = true;
+    _swapChainExtent = {width, height};
+
+    createInstance();
+    pickPhysicalDevice();
+    createLogicalDevice();
+    createAllocator();
+    createUploadManager();
+    createGeometryPool();
+    createPipelineCache();
+    createOffscreenTargets();
+    createRenderResources();
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(_physicalDevice, &properties);
+    std::cout << "Headless renderer on " << properties.deviceName << " ("
+              << width << "x" << height << ")" << std::endl;
+
+    _initialized = true;
+}
+
+void VulkanRenderer::createRenderResources() {
+    createRenderPass();
+    createDescriptorResources();
+    createGraphicsPipeline();
+    createGpuCuller();
+    createFramebuffers();
+    createSceneTargets();
+    createPostProcessor();
+    createCommandPool();
+    createCommandBuffers();
+    createParallelRecordingResources();
+    createStatisticsQueries();
+    createSyncObjects();
+    createPlaceholderTexture();
+}
+
 void VulkanRenderer::cleanup() {
     if (!_initialized) return;
 
     vkDeviceWaitIdle(_device);
 
     // Shutdown ImGui first
-    _imguiManager.shutdown();
+    if (!_headless) {
+        _imguiManager.shutdown();
+    }
 
     // Cleanup Plastiboo resources
+    _uploadManager.destroy();
+    for (Plaster::GeometryPool& pool : _geometryPools) {
+        pool.destroy(_allocator);
+    }
+    _gpuCuller.destroy(_allocator, _device);
+    _postProcessor.destroy(_device, _allocator);
     _descriptorManager.destroy(_device);
+    _descriptorArena.destroy(_device);
+    _materialRegistry.destroy(_allocator);
+    _placeholderTexture.destroy(_allocator, _device);
 
     for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
         _cameraBuffers[i].destroy(_allocator);
@@ -68,12 +119,26 @@ void VulkanRenderer::cleanup() {
         _objectBuffers[i].destroy(_allocator);
     }
 
+    // Headless and scene targets are VMA images, so these run before the allocator goes away
+    destroySceneTargets();
+    cleanupSwapChain();
+
     if (_allocator != VK_NULL_HANDLE) {
         vmaDestroyAllocator(_allocator);
         _allocator = VK_NULL_HANDLE;
     }
 
-    cleanupSwapChain();
+    for (uint32_t i = 0; i < Plaster::VERTEX_FORMAT_COUNT; i++) {
+        vkDestroyPipeline(_device, _graphicsPipelines[i], nullptr);
+        vkDestroyPipeline(_device, _depthPrepassPipelines[i], nullptr);
+    }
+    if (_statisticsQueryPool != VK_NULL_HANDLE) {
+        vkDestroyQueryPool(_device, _statisticsQueryPool, nullptr);
+    }
+    vkDestroyPipelineLayout(_device, _pipelineLayout, nullptr);
+    vkDestroyRenderPass(_device, _renderPass, nullptr);
+    vkDestroyRenderPass(_device, _sceneRenderPass, nullptr);
+    _pipelineCache.destroy(_device);
 
     // Cleanup synchronization objects
     for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
@@ -82,36 +147,49 @@ void VulkanRenderer::cleanup() {
         vkDestroyFence(_device, _inFlightFences[i], nullptr);
     }
 
+    destroyParallelRecordingResources();
     vkDestroyCommandPool(_device, _commandPool, nullptr);
     vkDestroyDevice(_device, nullptr);
-    vkDestroySurfaceKHR(_instance, _surface, nullptr);
+    if (_surface != VK_NULL_HANDLE) {
+        vkDestroySurfaceKHR(_instance, _surface, nullptr);
+    }
     vkDestroyInstance(_instance, nullptr);
 
     _initialized = false;
 }
 
 void VulkanRenderer::drawFrame() {
-    // Start ImGui frame
-    _imguiManager.newFrame();
-    
-    // Render custom UI with orange acrylic theme
-    TestUI::Render();
-    
-    // Optionally show demo window (comment out for production)
-    // ImGui::ShowDemoWindow();
+    if (!_headless) {
+        // Start ImGui frame
+        _imguiManager.newFrame();
+
+        // Render custom UI with orange acrylic theme
+        TestUI::Render();
+        TestUI::RenderStatsOverlay(_stats);
+
+        // Optionally show demo window (comment out for production)
+        // ImGui::ShowDemoWindow();
+    }
     
     // Wait for the current frame's fence
     vkWaitForFences(_device, 1, &_inFlightFences[_currentFrame], VK_TRUE, UINT64_MAX);
 
-    uint32_t imageIndex;
-    VkResult result = vkAcquireNextImageKHR(_device, _swapChain, UINT64_MAX, 
-        _imageAvailableSemaphores[_currentFrame], VK_NULL_HANDLE, &imageIndex);
-
-    if (result == VK_ERROR_OUT_OF_DATE_KHR) {
-        recreateSwapChain();
-        return;
-    } else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
-        throw std::runtime_error("Failed to acquire swap chain image!");
+    // Nothing in flight uses this slot's transient sets any more
+    _descriptorArena.beginFrame(_device, _currentFrame);
+
+    // Headless frames own a fixed offscreen image each, so there is nothing to acquire
+    uint32_t imageIndex = _currentFrame;
+    VkResult result = VK_SUCCESS;
+    if (!_headless) {
+        result = vkAcquireNextImageKHR(_device, _swapChain, UINT64_MAX,
+            _imageAvailableSemaphores[_currentFrame], VK_NULL_HANDLE, &imageIndex);
+
+        if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+            recreateSwapChain();
+            return;
+        } else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
+            throw std::runtime_error("Failed to acquire swap chain image!");
+        }
     }
 
     // Check if a previous frame is using this image (i.e. there is its fence to wait on)
@@ -124,6 +202,15 @@ void VulkanRenderer::drawFrame() {
     // Only reset the fence if we are submitting work
     vkResetFences(_device, 1, &_inFlightFences[_currentFrame]);
 
+    // Submit this frame's uploads ahead of the frame so its draws are ordered after them
+    _uploadManager.update();
+    _uploadManager.flush();
+
+    // This frame slot's fence has signalled, so its query result is ready
+    readStatisticsQuery();
+
+    uploadObjectTransforms();
+
     vkResetCommandBuffer(_commandBuffers[_currentFrame], 0);
     recordCommandBuffer(_commandBuffers[_currentFrame], imageIndex);
 
@@ -131,8 +218,9 @@ void VulkanRenderer::drawFrame() {
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
     VkSemaphore waitSemaphores[] = {_imageAvailableSemaphores[_currentFrame]};
-    VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-    submitInfo.waitSemaphoreCount = 1;
+    // The first write to the acquired image is the upscale blit
+    VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_TRANSFER_BIT};
+    submitInfo.waitSemaphoreCount = _headless ? 0 : 1;
     submitInfo.pWaitSemaphores = waitSemaphores;
     submitInfo.pWaitDstStageMask = waitStages;
 
@@ -140,13 +228,20 @@ void VulkanRenderer::drawFrame() {
     submitInfo.pCommandBuffers = &_commandBuffers[_currentFrame];
 
     VkSemaphore signalSemaphores[] = {_renderFinishedSemaphores[_currentFrame]};
-    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.signalSemaphoreCount = _headless ? 0 : 1;
     submitInfo.pSignalSemaphores = signalSemaphores;
 
     if (vkQueueSubmit(_graphicsQueue, 1, &submitInfo, _inFlightFences[_currentFrame]) != VK_SUCCESS) {
         throw std::runtime_error("Failed to submit draw command buffer!");
     }
 
+    _lastImageIndex = imageIndex;
+
+    if (_headless) {
+        _currentFrame = (_currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+        return;
+    }
+
     VkPresentInfoKHR presentInfo{};
     presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
     presentInfo.waitSemaphoreCount = 1;
@@ -234,6 +329,9 @@ void VulkanRenderer::createLogicalDevice() {
 
     std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
     std::set<uint32_t> uniqueQueueFamilies = {indices.graphicsFamily.value(), indices.presentFamily.value()};
+    if (indices.transferFamily) {
+        uniqueQueueFamilies.insert(indices.transferFamily.value());
+    }
 
     float queuePriority = 1.0f;
     for (uint32_t queueFamily : uniqueQueueFamilies) {
@@ -245,15 +343,61 @@ void VulkanRenderer::createLogicalDevice() {
         queueCreateInfos.push_back(queueCreateInfo);
     }
 
+    // Pipeline statistics let the stats overlay report overdraw; executing
+    // secondaries inside the query additionally needs inherited queries
+    VkPhysicalDeviceFeatures supportedFeatures;
+    vkGetPhysicalDeviceFeatures(_physicalDevice, &supportedFeatures);
+
     VkPhysicalDeviceFeatures deviceFeatures{};
+    deviceFeatures.pipelineStatisticsQuery = supportedFeatures.pipelineStatisticsQuery;
+    deviceFeatures.inheritedQueries = supportedFeatures.inheritedQueries;
+    _pipelineStatisticsSupported = supportedFeatures.pipelineStatisticsQuery == VK_TRUE;
+    _inheritedQueriesSupported = supportedFeatures.inheritedQueries == VK_TRUE;
+
+    // GPU culling draws each group's instances from a non-zero firstInstance;
+    // multi-draw and the draw-count extension collapse a material's draws into one call
+    deviceFeatures.multiDrawIndirect = supportedFeatures.multiDrawIndirect;
+    deviceFeatures.drawIndirectFirstInstance = supportedFeatures.drawIndirectFirstInstance;
+    _multiDrawIndirectSupported = supportedFeatures.multiDrawIndirect == VK_TRUE;
+    _gpuCullingSupported = supportedFeatures.drawIndirectFirstInstance == VK_TRUE;
+
+    // VK_KHR_swapchain is only needed when presenting
+    std::vector<const char*> enabledExtensions;
+    if (!_headless) {
+        enabledExtensions = _deviceExtensions;
+    }
+    bool drawIndirectCountSupported = checkOptionalDeviceExtension(_physicalDevice, VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+    if (drawIndirectCountSupported) {
+        enabledExtensions.push_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+    }
+
+    // Bindless materials index a runtime-sized sampler array with a push
+    // constant; descriptor indexing features go through VkPhysicalDeviceFeatures2
+    VkPhysicalDeviceDescriptorIndexingFeaturesEXT indexingFeatures{};
+    indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+    _bindlessSupported = queryBindlessSupport(indexingFeatures);
+    if (_bindlessSupported) {
+        deviceFeatures.shaderSampledImageArrayDynamicIndexing = VK_TRUE;
+        enabledExtensions.push_back(VK_KHR_MAINTENANCE3_EXTENSION_NAME);
+        enabledExtensions.push_back(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+    }
+
+    VkPhysicalDeviceFeatures2KHR deviceFeatures2{};
+    deviceFeatures2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR;
+    deviceFeatures2.pNext = &indexingFeatures;
+    deviceFeatures2.features = deviceFeatures;
 
     VkDeviceCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
     createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
     createInfo.pQueueCreateInfos = queueCreateInfos.data();
-    createInfo.pEnabledFeatures = &deviceFeatures;
-    createInfo.enabledExtensionCount = static_cast<uint32_t>(_deviceExtensions.size());
-    createInfo.ppEnabledExtensionNames = _deviceExtensions.data();
+    if (_bindlessSupported) {
+        createInfo.pNext = &deviceFeatures2;
+    } else {
+        createInfo.pEnabledFeatures = &deviceFeatures;
+    }
+    createInfo.enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size());
+    createInfo.ppEnabledExtensionNames = enabledExtensions.data();
 
     if (enableValidationLayers) {
         createInfo.enabledLayerCount = static_cast<uint32_t>(_validationLayers.size());
@@ -268,6 +412,14 @@ void VulkanRenderer::createLogicalDevice() {
 
     vkGetDeviceQueue(_device, indices.graphicsFamily.value(), 0, &_graphicsQueue);
     vkGetDeviceQueue(_device, indices.presentFamily.value(), 0, &_presentQueue);
+    if (indices.transferFamily) {
+        vkGetDeviceQueue(_device, indices.transferFamily.value(), 0, &_transferQueue);
+    }
+
+    if (drawIndirectCountSupported) {
+        _vkCmdDrawIndexedIndirectCount = reinterpret_cast<PFN_vkCmdDrawIndexedIndirectCountKHR>(
+            vkGetDeviceProcAddr(_device, "vkCmdDrawIndexedIndirectCountKHR"));
+    }
 }
 
 bool VulkanRenderer::checkValidationLayerSupport() {
@@ -296,16 +448,121 @@ bool VulkanRenderer::checkValidationLayerSupport() {
 }
 
 std::vector<const char*> VulkanRenderer::getRequiredExtensions() {
-    auto extensions = _window->getRequiredExtensions();
+    // Headless runs need no surface extensions at all
+    std::vector<const char*> extensions;
+    if (!_headless) {
+        extensions = _window->getRequiredExtensions();
+    }
     
     if (enableValidationLayers) {
         extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
     }
 
+    // Needed to query descriptor indexing support on a 1.0 instance
+    _physicalDeviceProperties2Supported = _bindlessEnabled &&
+        checkInstanceExtensionSupport(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+    if (_physicalDeviceProperties2Supported) {
+        extensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+    }
+
     return extensions;
 }
 
+bool VulkanRenderer::checkInstanceExtensionSupport(const char* name) {
+    uint32_t extensionCount;
+    vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, nullptr);
+
+    std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+    vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, availableExtensions.data());
+
+    for (const auto& extension : availableExtensions) {
+        if (strcmp(extension.extensionName, name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool VulkanRenderer::queryBindlessSupport(VkPhysicalDeviceDescriptorIndexingFeaturesEXT& enabledFeatures) {
+    if (!_bindlessEnabled || !_physicalDeviceProperties2Supported ||
+        !checkOptionalDeviceExtension(_physicalDevice, VK_KHR_MAINTENANCE3_EXTENSION_NAME) ||
+        !checkOptionalDeviceExtension(_physicalDevice, VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME)) {
+        return false;
+    }
+
+    auto getFeatures2 = reinterpret_cast<PFN_vkGetPhysicalDeviceFeatures2KHR>(
+        vkGetInstanceProcAddr(_instance, "vkGetPhysicalDeviceFeatures2KHR"));
+    auto getProperties2 = reinterpret_cast<PFN_vkGetPhysicalDeviceProperties2KHR>(
+        vkGetInstanceProcAddr(_instance, "vkGetPhysicalDeviceProperties2KHR"));
+    if (!getFeatures2 || !getProperties2) {
+        return false;
+    }
+
+    VkPhysicalDeviceDescriptorIndexingFeaturesEXT indexingFeatures{};
+    indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+    VkPhysicalDeviceFeatures2KHR features{};
+    features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR;
+    features.pNext = &indexingFeatures;
+    getFeatures2(_physicalDevice, &features);
+
+    // The material index is a push constant, so indexing is dynamically
+    // uniform; textures are registered while earlier frames are in flight
+    if (!features.features.shaderSampledImageArrayDynamicIndexing ||
+        !indexingFeatures.runtimeDescriptorArray ||
+        !indexingFeatures.descriptorBindingPartiallyBound ||
+        !indexingFeatures.descriptorBindingSampledImageUpdateAfterBind) {
+        return false;
+    }
+
+    VkPhysicalDeviceDescriptorIndexingPropertiesEXT indexingProperties{};
+    indexingProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES_EXT;
+    VkPhysicalDeviceProperties2KHR properties{};
+    properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2_KHR;
+    properties.pNext = &indexingProperties;
+    getProperties2(_physicalDevice, &properties);
+
+    uint32_t capacity = MAX_BINDLESS_TEXTURES;
+    capacity = std::min(capacity, indexingProperties.maxPerStageDescriptorUpdateAfterBindSamplers);
+    capacity = std::min(capacity, indexingProperties.maxPerStageDescriptorUpdateAfterBindSampledImages);
+    capacity = std::min(capacity, indexingProperties.maxDescriptorSetUpdateAfterBindSamplers);
+    capacity = std::min(capacity, indexingProperties.maxDescriptorSetUpdateAfterBindSampledImages);
+    if (capacity == 0) {
+        return false;
+    }
+    _bindlessTextureCapacity = capacity;
+
+    enabledFeatures.runtimeDescriptorArray = VK_TRUE;
+    enabledFeatures.descriptorBindingPartiallyBound = VK_TRUE;
+    enabledFeatures.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+    return true;
+}
+
 // Basic implementations for other methods
+void VulkanRenderer::createUploadManager() {
+    QueueFamilyIndices indices = findQueueFamilies(_physicalDevice);
+    uint32_t transferFamily = indices.transferFamily.value_or(indices.graphicsFamily.value());
+
+    if (!_uploadManager.create(_allocator, _device, indices.graphicsFamily.value(), _graphicsQueue,
+                               transferFamily, _transferQueue, _stagingBufferSize)) {
+        throw std::runtime_error("Failed to create upload manager!");
+    }
+}
+
+void VulkanRenderer::createGeometryPool() {
+    for (uint32_t i = 0; i < Plaster::VERTEX_FORMAT_COUNT; i++) {
+        if (!_geometryPools[i].create(_allocator, Plaster::getVertexStride(static_cast<Plaster::VertexFormat>(i)),
+                                      _geometryVertexCapacity, _geometryIndexCapacity)) {
+            throw std::runtime_error("Failed to create geometry pool!");
+        }
+    }
+}
+
+void VulkanRenderer::createPipelineCache() {
+    if (!_pipelineCache.create(_device, _physicalDevice)) {
+        throw std::runtime_error("Failed to create pipeline cache!");
+    }
+}
+
 void VulkanRenderer::createSwapChain() {
     SwapChainSupportDetails swapChainSupport = querySwapChainSupport(_physicalDevice);
 
@@ -326,7 +583,8 @@ void VulkanRenderer::createSwapChain() {
     createInfo.imageColorSpace = surfaceFormat.colorSpace;
     createInfo.imageExtent = extent;
     createInfo.imageArrayLayers = 1;
-    createInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    // Transfer dst for the upscale blit from the internal resolution target
+    createInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
 
     QueueFamilyIndices indices = findQueueFamilies(_physicalDevice);
     uint32_t queueFamilyIndices[] = {indices.graphicsFamily.value(), indices.presentFamily.value()};
@@ -388,25 +646,400 @@ void VulkanRenderer::createImageViews() {
     }
 }
 
+void VulkanRenderer::createRenderTarget(VkExtent2D extent, VkFormat format, VkImageUsageFlags usage,
+                                        VkImageAspectFlags aspect, VkImage& image, VmaAllocation& allocation,
+                                        VkImageView& view) {
+    VkImageCreateInfo imageInfo{};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.format = format;
+    imageInfo.extent = {extent.width, extent.height, 1};
+    imageInfo.mipLevels = 1;
+    imageInfo.arrayLayers = 1;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.usage = usage;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    // Transient attachments may never leave tile memory, so prefer lazily
+    // allocated memory for them where the device has it
+    VmaAllocationCreateInfo allocInfo{};
+    allocInfo.usage = (usage & VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT) ? VMA_MEMORY_USAGE_GPU_LAZILY_ALLOCATED
+                                                                        : VMA_MEMORY_USAGE_GPU_ONLY;
+
+    VkResult result = vmaCreateImage(_allocator, &imageInfo, &allocInfo, &image, &allocation, nullptr);
+    if (result != VK_SUCCESS && allocInfo.usage == VMA_MEMORY_USAGE_GPU_LAZILY_ALLOCATED) {
+        allocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+        result = vmaCreateImage(_allocator, &imageInfo, &allocInfo, &image, &allocation, nullptr);
+    }
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create render target!");
+    }
+
+    VkImageViewCreateInfo viewInfo{};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = image;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format = format;
+    viewInfo.subresourceRange.aspectMask = aspect;
+    viewInfo.subresourceRange.baseMipLevel = 0;
+    viewInfo.subresourceRange.levelCount = 1;
+    viewInfo.subresourceRange.baseArrayLayer = 0;
+    viewInfo.subresourceRange.layerCount = 1;
+
+    if (vkCreateImageView(_device, &viewInfo, nullptr, &view) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create render target view!");
+    }
+}
+
+void VulkanRenderer::createOffscreenTargets() {
+    // RGBA8 UNORM so readback maps straight onto PNG rows
+    _swapChainImageFormat = VK_FORMAT_R8G8B8A8_UNORM;
+    _swapChainImages.resize(MAX_FRAMES_IN_FLIGHT);
+    _swapChainImageViews.resize(MAX_FRAMES_IN_FLIGHT);
+    _offscreenAllocations.resize(MAX_FRAMES_IN_FLIGHT);
+    _imagesInFlight.resize(MAX_FRAMES_IN_FLIGHT, VK_NULL_HANDLE);
+
+    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        createRenderTarget(_swapChainExtent, _swapChainImageFormat,
+                           VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+                           VK_IMAGE_ASPECT_COLOR_BIT, _swapChainImages[i], _offscreenAllocations[i], _swapChainImageViews[i]);
+    }
+}
+
+VkFormat VulkanRenderer::findDepthFormat() {
+    // Post effects sample depth through a single view, so then only
+    // depth-only formats that can be sampled will do
+    const bool sampled = _postProcessor.readsDepth();
+    const std::vector<VkFormat> candidates = sampled
+        ? std::vector<VkFormat>{VK_FORMAT_D32_SFLOAT, VK_FORMAT_D16_UNORM}
+        : std::vector<VkFormat>{VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT};
+    const VkFormatFeatureFlags features = VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT |
+                                          (sampled ? VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT : 0);
+
+    for (VkFormat format : candidates) {
+        VkFormatProperties props;
+        vkGetPhysicalDeviceFormatProperties(_physicalDevice, format, &props);
+        if ((props.optimalTilingFeatures & features) == features) {
+            return format;
+        }
+    }
+
+    throw std::runtime_error("Failed to find a supported depth format!");
+}
+
+void VulkanRenderer::createStatisticsQueries() {
+    if (!_pipelineStatisticsSupported) {
+        std::cout << "Pipeline statistics queries unsupported; overdraw will not be reported" << std::endl;
+        return;
+    }
+    if (_recordingPool && !_inheritedQueriesSupported) {
+        std::cout << "Inherited queries unsupported; overdraw will not be reported with parallel recording" << std::endl;
+        return;
+    }
+
+    VkQueryPoolCreateInfo queryPoolInfo{};
+    queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    queryPoolInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+    queryPoolInfo.queryCount = MAX_FRAMES_IN_FLIGHT;
+    queryPoolInfo.pipelineStatistics = VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+
+    if (vkCreateQueryPool(_device, &queryPoolInfo, nullptr, &_statisticsQueryPool) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create pipeline statistics query pool!");
+    }
+
+    _statisticsPending.assign(MAX_FRAMES_IN_FLIGHT, false);
+}
+
+void VulkanRenderer::readStatisticsQuery() {
+    if (_statisticsQueryPool == VK_NULL_HANDLE || !_statisticsPending[_currentFrame]) {
+        return;
+    }
+
+    uint64_t invocations = 0;
+    if (vkGetQueryPoolResults(_device, _statisticsQueryPool, _currentFrame, 1, sizeof(invocations), &invocations,
+                              sizeof(invocations), VK_QUERY_RESULT_64_BIT) == VK_SUCCESS) {
+        _lastFragmentInvocations = invocations;
+    }
+    _statisticsPending[_currentFrame] = false;
+}
+
+void VulkanRenderer::createSceneTargets() {
+    // Fixed internal size, or a fraction of the output when a scale is set
+    if (_internalScale > 0.0f) {
+        _sceneExtent.width = std::max(1u, static_cast<uint32_t>(_swapChainExtent.width * _internalScale));
+        _sceneExtent.height = std::max(1u, static_cast<uint32_t>(_swapChainExtent.height * _internalScale));
+    } else if (_internalWidth > 0 && _internalHeight > 0) {
+        _sceneExtent = {_internalWidth, _internalHeight};
+    } else {
+        _sceneExtent = _swapChainExtent;
+    }
+
+    // One target per frame in flight so a frame never clears the image the
+    // previous frame is still blitting from
+    _sceneImages.resize(MAX_FRAMES_IN_FLIGHT);
+    _sceneAllocations.resize(MAX_FRAMES_IN_FLIGHT);
+    _sceneImageViews.resize(MAX_FRAMES_IN_FLIGHT);
+    _sceneFramebuffers.resize(MAX_FRAMES_IN_FLIGHT);
+    _depthImages.resize(MAX_FRAMES_IN_FLIGHT);
+    _depthAllocations.resize(MAX_FRAMES_IN_FLIGHT);
+    _depthImageViews.resize(MAX_FRAMES_IN_FLIGHT);
+
+    VkImageAspectFlags depthAspect = VK_IMAGE_ASPECT_DEPTH_BIT;
+    if (_depthFormat == VK_FORMAT_D32_SFLOAT_S8_UINT || _depthFormat == VK_FORMAT_D24_UNORM_S8_UINT) {
+        depthAspect |= VK_IMAGE_ASPECT_STENCIL_BIT;
+    }
+
+    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        createRenderTarget(_sceneExtent, _swapChainImageFormat,
+                           VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                           VK_IMAGE_ASPECT_COLOR_BIT, _sceneImages[i], _sceneAllocations[i], _sceneImageViews[i]);
+
+        // Depth is only stored when a post effect samples it; otherwise it
+        // never leaves the pass
+        createRenderTarget(_sceneExtent, _depthFormat,
+                           VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT |
+                               (_postProcessor.readsDepth() ? VK_IMAGE_USAGE_SAMPLED_BIT
+                                                            : VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT),
+                           depthAspect, _depthImages[i], _depthAllocations[i], _depthImageViews[i]);
+
+        VkImageView attachments[] = {_sceneImageViews[i], _depthImageViews[i]};
+
+        VkFramebufferCreateInfo framebufferInfo{};
+        framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+        framebufferInfo.renderPass = _sceneRenderPass;
+        framebufferInfo.attachmentCount = 2;
+        framebufferInfo.pAttachments = attachments;
+        framebufferInfo.width = _sceneExtent.width;
+        framebufferInfo.height = _sceneExtent.height;
+        framebufferInfo.layers = 1;
+
+        if (vkCreateFramebuffer(_device, &framebufferInfo, nullptr, &_sceneFramebuffers[i]) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create scene framebuffer!");
+        }
+    }
+
+    std::cout << "Scene renders at " << _sceneExtent.width << "x" << _sceneExtent.height
+              << ", upscaled to " << _swapChainExtent.width << "x" << _swapChainExtent.height << std::endl;
+}
+
+void VulkanRenderer::destroySceneTargets() {
+    for (size_t i = 0; i < _sceneImages.size(); i++) {
+        vkDestroyFramebuffer(_device, _sceneFramebuffers[i], nullptr);
+        vkDestroyImageView(_device, _sceneImageViews[i], nullptr);
+        vmaDestroyImage(_allocator, _sceneImages[i], _sceneAllocations[i]);
+        vkDestroyImageView(_device, _depthImageViews[i], nullptr);
+        vmaDestroyImage(_allocator, _depthImages[i], _depthAllocations[i]);
+    }
+    _sceneImages.clear();
+    _depthImages.clear();
+    _depthAllocations.clear();
+    _depthImageViews.clear();
+    _sceneAllocations.clear();
+    _sceneImageViews.clear();
+    _sceneFramebuffers.clear();
+}
+
+void VulkanRenderer::createPostProcessor() {
+    // Effects are optional, but the graph also carries the upscale every frame needs
+    _postProcessor.setShaderCacheDirectory(_shaderCacheDirectory);
+    if (!_postProcessor.create(_device, _pipelineCache.getHandle(), MAX_FRAMES_IN_FLIGHT,
+                               _swapChainImageFormat, _depthFormat, _swapChainImageFormat) ||
+        !_postProcessor.resize(_device, _allocator, _sceneExtent, _swapChainExtent)) {
+        throw std::runtime_error("Failed to create post processor!");
+    }
+}
+void VulkanRenderer::readbackFrame(std::vector<uint8_t>& pixels) {
+    if (!_headless) {
+        throw std::runtime_error("Frame readback is only available in headless mode!");
+    }
+
+    vkDeviceWaitIdle(_device);
+
+    const VkDeviceSize size = static_cast<VkDeviceSize>(_swapChainExtent.width) * _swapChainExtent.height * 4;
+
+    Plaster::VulkanBuffer readbackBuffer;
+    if (!readbackBuffer.create(_allocator, size, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                               VMA_MEMORY_USAGE_GPU_TO_CPU, VMA_ALLOCATION_CREATE_MAPPED_BIT)) {
+        throw std::runtime_error("Failed to create readback buffer!");
+    }
+
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandPool = _commandPool;
+    allocInfo.commandBufferCount = 1;
+
+    VkCommandBuffer commandBuffer;
+    vkAllocateCommandBuffers(_device, &allocInfo, &commandBuffer);
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+    // The render pass left the image in TRANSFER_SRC; make its color writes visible to the copy
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = _swapChainImages[_lastImageIndex];
+    barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    VkBufferImageCopy region{};
+    region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+    region.imageExtent = {_swapChainExtent.width, _swapChainExtent.height, 1};
+
+    vkCmdCopyImageToBuffer(commandBuffer, _swapChainImages[_lastImageIndex], VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                           readbackBuffer.getBuffer(), 1, &region);
+
+    VkBufferMemoryBarrier hostBarrier{};
+    hostBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    hostBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    hostBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    hostBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    hostBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    hostBarrier.buffer = readbackBuffer.getBuffer();
+    hostBarrier.size = VK_WHOLE_SIZE;
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+                         0, 0, nullptr, 1, &hostBarrier, 0, nullptr);
+
+    vkEndCommandBuffer(commandBuffer);
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+
+    if (vkQueueSubmit(_graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to submit frame readback!");
+    }
+    vkQueueWaitIdle(_graphicsQueue);
+
+    vkFreeCommandBuffers(_device, _commandPool, 1, &commandBuffer);
+
+    readbackBuffer.invalidate(_allocator, 0, size);
+    pixels.resize(static_cast<size_t>(size));
+    std::memcpy(pixels.data(), readbackBuffer.getMappedData(), static_cast<size_t>(size));
+
+    readbackBuffer.destroy(_allocator);
+}
+
+bool VulkanRenderer::saveFrame(const std::string& path) {
+    std::vector<uint8_t> pixels;
+    readbackFrame(pixels);
+
+    const int width = static_cast<int>(_swapChainExtent.width);
+    const int height = static_cast<int>(_swapChainExtent.height);
+
+    bool isPng = path.size() >= 4 && path.compare(path.size() - 4, 4, ".png") == 0;
+    if (isPng) {
+        if (!stbi_write_png(path.c_str(), width, height, 4, pixels.data(), width * 4)) {
+            std::cerr << "Failed to write PNG: " << path << std::endl;
+            return false;
+        }
+    } else {
+        std::ofstream file(path, std::ios::binary);
+        if (!file.is_open()) {
+            std::cerr << "Failed to open " << path << " for writing" << std::endl;
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(pixels.data()), static_cast<std::streamsize>(pixels.size()));
+    }
+
+    std::cout << "Saved " << width << "x" << height << " frame to " << path << std::endl;
+    return true;
+}
+
 void VulkanRenderer::createRenderPass() {
-    VkAttachmentDescription colorAttachment{};
-    colorAttachment.format = _swapChainImageFormat;
-    colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
-    colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-    colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-    colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    _depthFormat = findDepthFormat();
+
+    // Scene pass: clears and draws the low-resolution target, which is then
+    // blitted to the output image
+    VkAttachmentDescription sceneAttachment{};
+    sceneAttachment.format = _swapChainImageFormat;
+    sceneAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+    sceneAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    sceneAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    sceneAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    sceneAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    sceneAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    sceneAttachment.finalLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
 
     VkAttachmentReference colorAttachmentRef{};
     colorAttachmentRef.attachment = 0;
     colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
+    VkAttachmentDescription depthAttachment{};
+    depthAttachment.format = _depthFormat;
+    depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+    depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    depthAttachment.storeOp = _postProcessor.readsDepth() ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+    VkAttachmentReference depthAttachmentRef{};
+    depthAttachmentRef.attachment = 1;
+    depthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
     VkSubpassDescription subpass{};
     subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
     subpass.colorAttachmentCount = 1;
     subpass.pColorAttachments = &colorAttachmentRef;
+    subpass.pDepthStencilAttachment = &depthAttachmentRef;
+
+    VkSubpassDependency sceneDependencies[2]{};
+    // Previous blit out of this target must finish before we clear it
+    sceneDependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+    sceneDependencies[0].dstSubpass = 0;
+    sceneDependencies[0].srcStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    sceneDependencies[0].srcAccessMask = 0;
+    sceneDependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+    sceneDependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    // Scene writes must be visible to the upscale blit
+    sceneDependencies[1].srcSubpass = 0;
+    sceneDependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
+    sceneDependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    sceneDependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    sceneDependencies[1].dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    sceneDependencies[1].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+    VkAttachmentDescription sceneAttachments[] = {sceneAttachment, depthAttachment};
+
+    VkRenderPassCreateInfo renderPassInfo{};
+    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    renderPassInfo.attachmentCount = 2;
+    renderPassInfo.pAttachments = sceneAttachments;
+    renderPassInfo.subpassCount = 1;
+    renderPassInfo.pSubpasses = &subpass;
+    renderPassInfo.dependencyCount = 2;
+    renderPassInfo.pDependencies = sceneDependencies;
+
+    if (vkCreateRenderPass(_device, &renderPassInfo, nullptr, &_sceneRenderPass) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create scene render pass!");
+    }
+
+    // UI pass: loads the upscaled scene and draws ImGui on top at full resolution
+    VkAttachmentDescription colorAttachment{};
+    colorAttachment.format = _swapChainImageFormat;
+    colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+    colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+    colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    colorAttachment.initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    colorAttachment.finalLayout = _headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 
     VkSubpassDependency dependency{};
     dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
@@ -414,14 +1047,12 @@ void VulkanRenderer::createRenderPass() {
     dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
     dependency.srcAccessMask = 0;
     dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+
+    subpass.pDepthStencilAttachment = nullptr;
 
-    VkRenderPassCreateInfo renderPassInfo{};
-    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
     renderPassInfo.attachmentCount = 1;
     renderPassInfo.pAttachments = &colorAttachment;
-    renderPassInfo.subpassCount = 1;
-    renderPassInfo.pSubpasses = &subpass;
     renderPassInfo.dependencyCount = 1;
     renderPassInfo.pDependencies = &dependency;
 
@@ -429,74 +1060,59 @@ void VulkanRenderer::createRenderPass() {
         throw std::runtime_error("Failed to create render pass!");
     }
 }
-
 void VulkanRenderer::createGraphicsPipeline() {
     using namespace Plaster;
 
-    // Compile shaders
-    ShaderCompiler compiler;
-    std::vector<uint32_t> vertSpirv, fragSpirv;
-
-    if (!compiler.compileFromFile("src/shaders/plastiboo.vert", ShaderCompiler::ShaderType::Vertex, vertSpirv)) {
-        throw std::runtime_error("Failed to compile vertex shader!");
-    }
+    // Compile every stage and vertex format permutation on the shader
+    // compiler's workers while the fixed function state and layout are built;
+    // only pipeline creation waits on them
+    auto shaderStart = std::chrono::high_resolution_clock::now();
 
-    if (!compiler.compileFromFile("src/shaders/plastiboo.frag", ShaderCompiler::ShaderType::Fragment, fragSpirv)) {
-        throw std::runtime_error("Failed to compile fragment shader!");
+    ShaderCompiler compiler;
+    compiler.setCacheDirectory(_shaderCacheDirectory);
+    if (_clearShaderCache) {
+        compiler.clearCache();
+        _clearShaderCache = false;
     }
-
-    // Create shader modules
-    VkShaderModule vertShaderModule = compiler.createShaderModule(_device, vertSpirv);
-    VkShaderModule fragShaderModule = compiler.createShaderModule(_device, fragSpirv);
-
-    VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
-    vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
-    vertShaderStageInfo.module = vertShaderModule;
-    vertShaderStageInfo.pName = "main";
-
-    VkPipelineShaderStageCreateInfo fragShaderStageInfo{};
-    fragShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-    fragShaderStageInfo.module = fragShaderModule;
-    fragShaderStageInfo.pName = "main";
-
-    VkPipelineShaderStageCreateInfo shaderStages[] = {vertShaderStageInfo, fragShaderStageInfo};
-
-    // Vertex input using PlastibooVertex
-    auto bindingDescription = PlastibooVertex::getBindingDescription();
-    auto attributeDescriptions = PlastibooVertex::getAttributeDescriptions();
+    std::future<ShaderCompileResult> vertCompiles[VERTEX_FORMAT_COUNT] = {
+        compiler.compileFromFileAsync("src/shaders/plastiboo.vert", ShaderStage::VERTEX, "main"),
+        compiler.compileFromFileAsync("src/shaders/plastiboo.vert", ShaderStage::VERTEX, "main", {{"PACKED_VERTEX", "1"}})
+    };
+    const bool bindless = isBindlessActive();
+    std::future<ShaderCompileResult> fragCompile =
+        compiler.compileFromFileAsync("src/shaders/plastiboo.frag", ShaderStage::FRAGMENT, "main",
+                                      bindless ? ShaderDefines{{"BINDLESS", "1"}} : ShaderDefines{});
+
+    // Vertex input per format, same locations in both
+    VkVertexInputBindingDescription bindingDescriptions[VERTEX_FORMAT_COUNT] = {
+        PlastibooVertex::getBindingDescription(),
+        PackedPlastibooVertex::getBindingDescription()
+    };
+    std::vector<VkVertexInputAttributeDescription> attributeDescriptions[VERTEX_FORMAT_COUNT] = {
+        PlastibooVertex::getAttributeDescriptions(),
+        PackedPlastibooVertex::getAttributeDescriptions()
+    };
 
     VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
     vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
     vertexInputInfo.vertexBindingDescriptionCount = 1;
-    vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
-    vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
-    vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
 
     VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
     inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
     inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
     inputAssembly.primitiveRestartEnable = VK_FALSE;
 
-    VkViewport viewport{};
-    viewport.x = 0.0f;
-    viewport.y = 0.0f;
-    viewport.width = (float)_swapChainExtent.width;
-    viewport.height = (float)_swapChainExtent.height;
-    viewport.minDepth = 0.0f;
-    viewport.maxDepth = 1.0f;
-
-    VkRect2D scissor{};
-    scissor.offset = {0, 0};
-    scissor.extent = _swapChainExtent;
-
+    // Viewport and scissor are set per frame from the internal resolution
     VkPipelineViewportStateCreateInfo viewportState{};
     viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
     viewportState.viewportCount = 1;
-    viewportState.pViewports = &viewport;
     viewportState.scissorCount = 1;
-    viewportState.pScissors = &scissor;
+
+    VkDynamicState dynamicStates[] = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+    VkPipelineDynamicStateCreateInfo dynamicState{};
+    dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamicState.dynamicStateCount = 2;
+    dynamicState.pDynamicStates = dynamicStates;
 
     VkPipelineRasterizationStateCreateInfo rasterizer{};
     rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
@@ -513,6 +1129,15 @@ void VulkanRenderer::createGraphicsPipeline() {
     multisampling.sampleShadingEnable = VK_FALSE;
     multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
 
+    // LESS_OR_EQUAL lets the main pass accept the exact depth the pre-pass wrote
+    VkPipelineDepthStencilStateCreateInfo depthStencil{};
+    depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    depthStencil.depthTestEnable = VK_TRUE;
+    depthStencil.depthWriteEnable = VK_TRUE;
+    depthStencil.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+    depthStencil.depthBoundsTestEnable = VK_FALSE;
+    depthStencil.stencilTestEnable = VK_FALSE;
+
     VkPipelineColorBlendAttachmentState colorBlendAttachment{};
     colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
                                           VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
@@ -524,42 +1149,119 @@ void VulkanRenderer::createGraphicsPipeline() {
     colorBlending.attachmentCount = 1;
     colorBlending.pAttachments = &colorBlendAttachment;
 
-    // Pipeline layout with descriptor sets
+    // Pipeline layout with descriptor sets; bindless swaps set 2 for one with
+    // the texture table. The per-draw object offset arrives through one push
+    // constant range.
     std::vector<VkDescriptorSetLayout> setLayouts = {
         _descriptorManager.getCameraLayout(),
         _descriptorManager.getObjectLayout(),
-        _descriptorManager.getMaterialLayout()
+        bindless ? _descriptorManager.getBindlessLayout() : _descriptorManager.getMaterialLayout()
     };
 
+    VkPushConstantRange drawConstantRange = Plaster::getDrawPushConstantRange();
+
     VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
     pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
     pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
     pipelineLayoutInfo.pSetLayouts = setLayouts.data();
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &drawConstantRange;
 
     if (vkCreatePipelineLayout(_device, &pipelineLayoutInfo, nullptr, &_pipelineLayout) != VK_SUCCESS) {
         throw std::runtime_error("Failed to create pipeline layout!");
     }
 
+    ShaderCompileResult vertResults[VERTEX_FORMAT_COUNT];
+    for (uint32_t i = 0; i < VERTEX_FORMAT_COUNT; i++) {
+        vertResults[i] = vertCompiles[i].get();
+        if (!vertResults[i].success) {
+            throw std::runtime_error("Failed to compile vertex shader!");
+        }
+    }
+    ShaderCompileResult fragResult = fragCompile.get();
+
+    if (!fragResult.success) {
+        throw std::runtime_error("Failed to compile fragment shader!");
+    }
+
+    auto shaderEnd = std::chrono::high_resolution_clock::now();
+    double shaderMs = std::chrono::duration<double, std::milli>(shaderEnd - shaderStart).count();
+    ShaderCacheStats cacheStats = compiler.getCacheStats();
+    std::cout << "Shaders ready in " << shaderMs << " ms (cache: " << cacheStats.hits << " hits, "
+              << cacheStats.misses << " misses)" << std::endl;
+
+    // Create shader modules
+    VkShaderModule vertShaderModules[VERTEX_FORMAT_COUNT];
+    for (uint32_t i = 0; i < VERTEX_FORMAT_COUNT; i++) {
+        vertShaderModules[i] = compiler.createShaderModule(_device, vertResults[i].spirv);
+    }
+    VkShaderModule fragShaderModule = compiler.createShaderModule(_device, fragResult.spirv);
+
+    VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
+    vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
+    vertShaderStageInfo.pName = "main";
+
+    VkPipelineShaderStageCreateInfo fragShaderStageInfo{};
+    fragShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+    fragShaderStageInfo.module = fragShaderModule;
+    fragShaderStageInfo.pName = "main";
+
+    VkPipelineShaderStageCreateInfo shaderStages[] = {vertShaderStageInfo, fragShaderStageInfo};
+
     VkGraphicsPipelineCreateInfo pipelineInfo{};
     pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-    pipelineInfo.stageCount = 2;
     pipelineInfo.pStages = shaderStages;
     pipelineInfo.pVertexInputState = &vertexInputInfo;
     pipelineInfo.pInputAssemblyState = &inputAssembly;
     pipelineInfo.pViewportState = &viewportState;
     pipelineInfo.pRasterizationState = &rasterizer;
     pipelineInfo.pMultisampleState = &multisampling;
+    pipelineInfo.pDepthStencilState = &depthStencil;
     pipelineInfo.pColorBlendState = &colorBlending;
+    pipelineInfo.pDynamicState = &dynamicState;
     pipelineInfo.layout = _pipelineLayout;
-    pipelineInfo.renderPass = _renderPass;
+    pipelineInfo.renderPass = _sceneRenderPass;
     pipelineInfo.subpass = 0;
 
-    if (vkCreateGraphicsPipelines(_device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &_graphicsPipeline) != VK_SUCCESS) {
-        throw std::runtime_error("Failed to create graphics pipeline!");
+    auto pipelineStart = std::chrono::high_resolution_clock::now();
+
+    const VkColorComponentFlags colorWriteMask = colorBlendAttachment.colorWriteMask;
+    for (uint32_t i = 0; i < VERTEX_FORMAT_COUNT; i++) {
+        shaderStages[0].module = vertShaderModules[i];
+        vertexInputInfo.pVertexBindingDescriptions = &bindingDescriptions[i];
+        vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions[i].size());
+        vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions[i].data();
+
+        colorBlendAttachment.colorWriteMask = colorWriteMask;
+        depthStencil.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+        pipelineInfo.stageCount = 2;
+
+        if (vkCreateGraphicsPipelines(_device, _pipelineCache.getHandle(), 1, &pipelineInfo, nullptr, &_graphicsPipelines[i]) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create graphics pipeline!");
+        }
+
+        // Depth pre-pass variant: vertex stage only and no color writes, so it
+        // costs little more than rasterisation
+        colorBlendAttachment.colorWriteMask = 0;
+        depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
+        pipelineInfo.stageCount = 1;
+
+        if (vkCreateGraphicsPipelines(_device, _pipelineCache.getHandle(), 1, &pipelineInfo, nullptr, &_depthPrepassPipelines[i]) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create depth pre-pass pipeline!");
+        }
     }
 
+    auto pipelineEnd = std::chrono::high_resolution_clock::now();
+    double pipelineMs = std::chrono::duration<double, std::milli>(pipelineEnd - pipelineStart).count();
+    std::cout << "Pipeline creation took " << pipelineMs << " ms ("
+              << (_pipelineCache.isWarm() ? "warm" : "cold") << " cache)" << std::endl;
+
     vkDestroyShaderModule(_device, fragShaderModule, nullptr);
-    vkDestroyShaderModule(_device, vertShaderModule, nullptr);
+    for (VkShaderModule module : vertShaderModules) {
+        vkDestroyShaderModule(_device, module, nullptr);
+    }
 
     std::cout << "Plastiboo graphics pipeline created" << std::endl;
 }
@@ -614,6 +1316,75 @@ void VulkanRenderer::createCommandBuffers() {
     }
 }
 
+void VulkanRenderer::createParallelRecordingResources() {
+    if (_recordingThreadCount <= 1) return;
+
+    _recordingPool = std::make_unique<Plaster::ThreadPool>(_recordingThreadCount);
+
+    QueueFamilyIndices queueFamilyIndices = findQueueFamilies(_physicalDevice);
+
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    poolInfo.queueFamilyIndex = queueFamilyIndices.graphicsFamily.value();
+
+    _workerCommandPools.resize(MAX_FRAMES_IN_FLIGHT);
+    _workerCommandBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+    _workerPrepassCommandBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+    for (size_t frame = 0; frame < MAX_FRAMES_IN_FLIGHT; frame++) {
+        _workerCommandPools[frame].resize(_recordingThreadCount);
+        _workerCommandBuffers[frame].resize(_recordingThreadCount);
+        _workerPrepassCommandBuffers[frame].resize(_recordingThreadCount);
+
+        for (uint32_t worker = 0; worker < _recordingThreadCount; worker++) {
+            if (vkCreateCommandPool(_device, &poolInfo, nullptr, &_workerCommandPools[frame][worker]) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create worker command pool!");
+            }
+
+            VkCommandBufferAllocateInfo allocInfo{};
+            allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            allocInfo.commandPool = _workerCommandPools[frame][worker];
+            allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+            allocInfo.commandBufferCount = 1;
+
+            if (vkAllocateCommandBuffers(_device, &allocInfo, &_workerCommandBuffers[frame][worker]) != VK_SUCCESS ||
+                vkAllocateCommandBuffers(_device, &allocInfo, &_workerPrepassCommandBuffers[frame][worker]) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to allocate worker command buffer!");
+            }
+        }
+    }
+
+    // ImGui is recorded on the main thread from the main pool
+    _uiCommandBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool = _commandPool;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+    allocInfo.commandBufferCount = (uint32_t)_uiCommandBuffers.size();
+
+    if (vkAllocateCommandBuffers(_device, &allocInfo, _uiCommandBuffers.data()) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate UI command buffers!");
+    }
+
+    std::cout << "Recording scene draws on " << _recordingThreadCount << " worker threads" << std::endl;
+}
+
+void VulkanRenderer::destroyParallelRecordingResources() {
+    _recordingPool.reset();
+
+    // Destroying a pool frees the buffers allocated from it
+    for (auto& framePools : _workerCommandPools) {
+        for (VkCommandPool pool : framePools) {
+            vkDestroyCommandPool(_device, pool, nullptr);
+        }
+    }
+    _workerCommandPools.clear();
+    _workerCommandBuffers.clear();
+    _workerPrepassCommandBuffers.clear();
+    _uiCommandBuffers.clear();
+}
+
 void VulkanRenderer::createSyncObjects() {
     _imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
     _renderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
@@ -636,6 +1407,40 @@ void VulkanRenderer::createSyncObjects() {
 }
 
 void VulkanRenderer::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex) {
+    auto recordStart = std::chrono::high_resolution_clock::now();
+    _stats.reset();
+    _stats.fragmentInvocations = _lastFragmentInvocations;
+    _stats.overdraw = static_cast<float>(_lastFragmentInvocations) /
+                      static_cast<float>(_sceneExtent.width * _sceneExtent.height);
+
+    bool drawScene = _currentScene && _graphicsPipelines[0] != VK_NULL_HANDLE;
+    bool gpuDriven = drawScene && _gpuCuller.isCreated();
+    const auto& batches = _renderQueue.getBatches();
+
+    flushMaterials();
+    if (drawScene && !gpuDriven && _drawDataMode == Plaster::DrawDataMode::PER_DRAW_DESCRIPTOR_SETS) {
+        allocatePerObjectSets();
+    }
+    if (gpuDriven) {
+        _stats.objects = _gpuCuller.getObjectCount();
+    } else if (drawScene) {
+        _stats.objects = static_cast<uint32_t>(_renderQueue.getInstanceOrder().size());
+        _stats.culledObjects = _renderQueue.getCulledCount();
+    }
+
+    // With GPU culling there are no CPU batches to split, so only the UI goes
+    // to a secondary buffer and the few indirect draws are recorded inline
+    bool parallel = _recordingPool != nullptr;
+    std::vector<VkCommandBuffer> sceneSecondaries;
+    VkCommandBuffer uiSecondary = VK_NULL_HANDLE;
+    if (parallel) {
+        recordSecondaryCommandBuffers(imageIndex, sceneSecondaries, uiSecondary);
+    }
+
+    VkSubpassContents contents = parallel ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS : VK_SUBPASS_CONTENTS_INLINE;
+    VkSubpassContents sceneContents = parallel && !gpuDriven ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS
+                                                             : VK_SUBPASS_CONTENTS_INLINE;
+
     VkCommandBufferBeginInfo beginInfo{};
     beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
 
@@ -643,59 +1448,358 @@ void VulkanRenderer::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t
         throw std::runtime_error("Failed to begin recording command buffer!");
     }
 
+    // Culling and draw generation run in compute, ahead of the scene pass
+    if (gpuDriven) {
+        _gpuCuller.recordCull(commandBuffer, _currentFrame, static_cast<float>(_sceneExtent.height), _lodSelection);
+    }
+
+    // Scene pass at the internal resolution
     VkRenderPassBeginInfo renderPassInfo{};
     renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    renderPassInfo.renderPass = _renderPass;
-    renderPassInfo.framebuffer = _swapChainFramebuffers[imageIndex];
+    renderPassInfo.renderPass = _sceneRenderPass;
+    renderPassInfo.framebuffer = _sceneFramebuffers[_currentFrame];
     renderPassInfo.renderArea.offset = {0, 0};
-    renderPassInfo.renderArea.extent = _swapChainExtent;
+    renderPassInfo.renderArea.extent = _sceneExtent;
 
     // Dark gradient background to see through translucent acrylic windows
-    VkClearValue clearColor = {{{0.05f, 0.05f, 0.08f, 1.0f}}};  // Dark blue-gray
-    renderPassInfo.clearValueCount = 1;
-    renderPassInfo.pClearValues = &clearColor;
-
-    vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+    VkClearValue clearValues[2]{};
+    clearValues[0].color = {{0.05f, 0.05f, 0.08f, 1.0f}};  // Dark blue-gray
+    clearValues[1].depthStencil = {1.0f, 0};
+    renderPassInfo.clearValueCount = 2;
+    renderPassInfo.pClearValues = clearValues;
+
+    // Count fragment shader invocations across the whole scene pass
+    if (_statisticsQueryPool != VK_NULL_HANDLE) {
+        vkCmdResetQueryPool(commandBuffer, _statisticsQueryPool, _currentFrame, 1);
+        vkCmdBeginQuery(commandBuffer, _statisticsQueryPool, _currentFrame, 0);
+    }
 
-    // Render scene geometry
-    if (_currentScene && _graphicsPipeline != VK_NULL_HANDLE) {
-        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _graphicsPipeline);
+    vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, sceneContents);
 
-        // Bind camera descriptor set (set 0)
-        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _pipelineLayout,
-                               0, 1, &_cameraDescriptorSets[_currentFrame], 0, nullptr);
+    if (gpuDriven) {
+        recordIndirectDraws(commandBuffer, _stats);
+    } else if (parallel) {
+        if (!sceneSecondaries.empty()) {
+            vkCmdExecuteCommands(commandBuffer, static_cast<uint32_t>(sceneSecondaries.size()), sceneSecondaries.data());
+        }
+    } else if (drawScene) {
+        bindSceneState(commandBuffer, _stats);
+        if (_depthPrepassEnabled) {
+            recordDepthPrepass(commandBuffer, 0, batches.size(), _stats);
+        }
+        recordBatches(commandBuffer, 0, batches.size(), _stats);
+    }
 
-        // Render each object
-        for (const auto& obj : _currentScene->getObjects()) {
-            // Update object uniform buffer
-            Plaster::ObjectUBO objectData{};
-            objectData.model = obj.getModelMatrix();
-            objectData.normalMatrix = obj.getNormalMatrix();
-            _objectBuffers[_currentFrame].copyData(_allocator, &objectData, sizeof(Plaster::ObjectUBO));
+    vkCmdEndRenderPass(commandBuffer);
 
-            // Bind object descriptor set (set 1)
-            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _pipelineLayout,
-                                   1, 1, &_objectDescriptorSets[_currentFrame], 0, nullptr);
+    if (_statisticsQueryPool != VK_NULL_HANDLE) {
+        vkCmdEndQuery(commandBuffer, _statisticsQueryPool, _currentFrame);
+        _statisticsPending[_currentFrame] = true;
+    }
 
-            // Bind mesh and draw
-            obj.mesh->bind(commandBuffer);
-            obj.mesh->draw(commandBuffer);
+    // Post effects, then the nearest-neighbour upscale into the output image
+    _postProcessor.record(commandBuffer, _device, _currentFrame,
+                          _sceneImages[_currentFrame], _sceneImageViews[_currentFrame],
+                          _depthImages[_currentFrame], _depthImageViews[_currentFrame],
+                          _swapChainImages[imageIndex], _swapChainImageViews[imageIndex]);
+
+    // UI pass at full resolution on top of the upscaled scene
+    VkRenderPassBeginInfo uiPassInfo{};
+    uiPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    uiPassInfo.renderPass = _renderPass;
+    uiPassInfo.framebuffer = _swapChainFramebuffers[imageIndex];
+    uiPassInfo.renderArea.offset = {0, 0};
+    uiPassInfo.renderArea.extent = _swapChainExtent;
+
+    vkCmdBeginRenderPass(commandBuffer, &uiPassInfo, contents);
+
+    if (parallel) {
+        if (uiSecondary != VK_NULL_HANDLE) {
+            vkCmdExecuteCommands(commandBuffer, 1, &uiSecondary);
         }
+    } else if (!_headless) {
+        // Render ImGui
+        _imguiManager.render(commandBuffer);
     }
 
-    // Render ImGui
-    _imguiManager.render(commandBuffer);
-
     vkCmdEndRenderPass(commandBuffer);
 
     if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
         throw std::runtime_error("Failed to record command buffer!");
     }
+
+    auto recordEnd = std::chrono::high_resolution_clock::now();
+    _stats.recordMs = std::chrono::duration<float, std::milli>(recordEnd - recordStart).count();
+}
+
+void VulkanRenderer::bindSceneState(VkCommandBuffer commandBuffer, Plaster::RenderStats& stats) {
+    // Viewport is dynamic so the internal resolution can follow window resizes
+    VkViewport viewport{};
+    viewport.width = (float)_sceneExtent.width;
+    viewport.height = (float)_sceneExtent.height;
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+
+    VkRect2D scissor{};
+    scissor.extent = _sceneExtent;
+    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+    // Camera (set 0), object data (set 1) and materials (set 2) are shared by
+    // every draw; each object's data holds its material's registry slot
+    VkDescriptorSet frameSets[] = {_cameraDescriptorSets[_currentFrame], _objectDescriptorSets[_currentFrame],
+                                   getMaterialSet()};
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _pipelineLayout,
+                           0, 3, frameSets, 0, nullptr);
+    stats.descriptorSetBinds += 3;
+
+    // Push constants are undefined until written, so start every command
+    // buffer from zeros: instanced draws then index objects by instance alone
+    Plaster::DrawPushConstants drawConstants{};
+    Plaster::pushDrawConstants(commandBuffer, _pipelineLayout, drawConstants);
+}
+
+void VulkanRenderer::recordDepthPrepass(VkCommandBuffer commandBuffer, size_t firstBatch, size_t lastBatch,
+                                        Plaster::RenderStats& stats) {
+    // Lay down depth with the position-only pipeline so the plastiboo
+    // fragment shader runs at most once per visible pixel
+    const auto& batches = _renderQueue.getBatches();
+    uint32_t boundPipeline = UINT32_MAX;
+    VkIndexType boundIndexType = VK_INDEX_TYPE_MAX_ENUM;
+    for (size_t i = firstBatch; i < lastBatch; i++) {
+        const auto& batch = batches[i];
+        if (batch.pipelineId != boundPipeline) {
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _depthPrepassPipelines[batch.pipelineId]);
+            stats.pipelineBinds++;
+        }
+        if (batch.pipelineId != boundPipeline || batch.mesh->getIndexType() != boundIndexType) {
+            _geometryPools[batch.pipelineId].bind(commandBuffer, batch.mesh->getIndexType());
+            boundIndexType = batch.mesh->getIndexType();
+            stats.vertexBufferBinds++;
+        }
+        boundPipeline = batch.pipelineId;
+        batch.mesh->draw(commandBuffer, batch.instanceCount, batch.firstInstance, batch.lod);
+        stats.prepassDrawCalls++;
+    }
+}
+
+void VulkanRenderer::recordBatches(VkCommandBuffer commandBuffer, size_t firstBatch, size_t lastBatch,
+                                   Plaster::RenderStats& stats) {
+    const auto& batches = _renderQueue.getBatches();
+
+    // Matches the zeroed constants bindSceneState pushed
+    Plaster::DrawPushConstants drawConstants{};
+
+    // Batches arrive sorted by pipeline, index type, material, mesh, LOD and
+    // depth, so each piece of state only needs binding when it differs from
+    // the last batch. The pipeline id is the vertex format, and each format
+    // has its own geometry pool, so vertex and index buffers bind once per
+    // format and index type. The per-draw modes split each batch into one
+    // draw per object for comparing how per-object data is delivered.
+    uint32_t boundPipeline = UINT32_MAX;
+    VkIndexType boundIndexType = VK_INDEX_TYPE_MAX_ENUM;
+    for (size_t i = firstBatch; i < lastBatch; i++) {
+        const auto& batch = batches[i];
+
+        if (batch.pipelineId != boundPipeline || batch.mesh->getIndexType() != boundIndexType) {
+            _geometryPools[batch.pipelineId].bind(commandBuffer, batch.mesh->getIndexType());
+            boundIndexType = batch.mesh->getIndexType();
+            stats.vertexBufferBinds++;
+        }
+
+        if (batch.pipelineId != boundPipeline) {
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _graphicsPipelines[batch.pipelineId]);
+            boundPipeline = batch.pipelineId;
+            stats.pipelineBinds++;
+        } else {
+            stats.bindsSaved++;
+        }
+
+        switch (_drawDataMode) {
+        case Plaster::DrawDataMode::INSTANCED:
+            batch.mesh->draw(commandBuffer, batch.instanceCount, batch.firstInstance, batch.lod);
+            stats.drawCalls++;
+            break;
+        case Plaster::DrawDataMode::PER_DRAW_PUSH_CONSTANTS:
+            // The object's slot travels in the command buffer itself
+            for (uint32_t slot = batch.firstInstance; slot < batch.firstInstance + batch.instanceCount; slot++) {
+                drawConstants.objectOffset = slot;
+                Plaster::pushDrawConstants(commandBuffer, _pipelineLayout, drawConstants);
+                batch.mesh->draw(commandBuffer, 1, 0, batch.lod);
+                stats.drawCalls++;
+            }
+            break;
+        case Plaster::DrawDataMode::PER_DRAW_DESCRIPTOR_SETS:
+            // Each object's own set, as a renderer with a set per object would
+            // record it; the instance only skips to the slot within the set
+            for (uint32_t slot = batch.firstInstance; slot < batch.firstInstance + batch.instanceCount; slot++) {
+                vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _pipelineLayout,
+                                       1, 1, &_perObjectSets[slot], 0, nullptr);
+                stats.descriptorSetBinds++;
+                const VkDeviceSize offset = slot * sizeof(Plaster::ObjectData);
+                const uint32_t instance = static_cast<uint32_t>(offset % _storageBufferAlignment / sizeof(Plaster::ObjectData));
+                batch.mesh->draw(commandBuffer, 1, instance, batch.lod);
+                stats.drawCalls++;
+            }
+            break;
+        }
+    }
+}
+
+void VulkanRenderer::recordIndirectDraws(VkCommandBuffer commandBuffer, Plaster::RenderStats& stats) {
+    const auto& lists = _gpuCuller.getDrawLists();
+    if (lists.empty() || _gpuCuller.getObjectCount() == 0) return;
+
+    VkViewport viewport{};
+    viewport.width = (float)_sceneExtent.width;
+    viewport.height = (float)_sceneExtent.height;
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+
+    VkRect2D scissor{};
+    scissor.extent = _sceneExtent;
+    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+    // Set 1 points at the transforms the cull pass wrote for visible objects
+    VkDescriptorSet frameSets[] = {_cameraDescriptorSets[_currentFrame], _culledObjectDescriptorSets[_currentFrame],
+                                   getMaterialSet()};
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _pipelineLayout,
+                           0, 3, frameSets, 0, nullptr);
+    stats.descriptorSetBinds += 3;
+
+    // Indirect commands carry firstInstance, so the object offset stays zero
+    Plaster::DrawPushConstants drawConstants{};
+    Plaster::pushDrawConstants(commandBuffer, _pipelineLayout, drawConstants);
+
+    // One indirect call per vertex format and index type: lists are ordered
+    // by format then index type, and the cull pass wrote each object's
+    // material into its data, so nothing changes between materials
+    if (_depthPrepassEnabled) {
+        uint32_t boundPipeline = UINT32_MAX;
+        for (uint32_t i = 0; i < static_cast<uint32_t>(lists.size()); i++) {
+            if (lists[i].pipelineId != boundPipeline) {
+                vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _depthPrepassPipelines[lists[i].pipelineId]);
+                boundPipeline = lists[i].pipelineId;
+                stats.pipelineBinds++;
+            }
+            _geometryPools[lists[i].pipelineId].bind(commandBuffer, lists[i].indexType);
+            stats.vertexBufferBinds++;
+            stats.prepassDrawCalls += _gpuCuller.recordDraws(commandBuffer, _currentFrame, i);
+        }
+    }
+
+    uint32_t boundPipeline = UINT32_MAX;
+    for (uint32_t i = 0; i < static_cast<uint32_t>(lists.size()); i++) {
+        if (lists[i].pipelineId != boundPipeline) {
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _graphicsPipelines[lists[i].pipelineId]);
+            boundPipeline = lists[i].pipelineId;
+            stats.pipelineBinds++;
+        }
+        _geometryPools[lists[i].pipelineId].bind(commandBuffer, lists[i].indexType);
+        stats.vertexBufferBinds++;
+        stats.drawCalls += _gpuCuller.recordDraws(commandBuffer, _currentFrame, i);
+    }
+}
+
+void VulkanRenderer::beginSecondaryCommandBuffer(VkCommandBuffer commandBuffer, VkRenderPass renderPass,
+                                                 VkFramebuffer framebuffer) {
+    VkCommandBufferInheritanceInfo inheritanceInfo{};
+    inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritanceInfo.renderPass = renderPass;
+    inheritanceInfo.subpass = 0;
+    inheritanceInfo.framebuffer = framebuffer;
+    if (renderPass == _sceneRenderPass && _statisticsQueryPool != VK_NULL_HANDLE) {
+        inheritanceInfo.pipelineStatistics = VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+    }
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+    if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to begin recording secondary command buffer!");
+    }
 }
+void VulkanRenderer::recordSecondaryCommandBuffers(uint32_t imageIndex, std::vector<VkCommandBuffer>& sceneSecondaries,
+                                                   VkCommandBuffer& uiSecondary) {
+    const size_t batchCount = _renderQueue.getBatches().size();
+    const uint32_t workerCount = _recordingPool->getThreadCount();
+    const size_t chunkSize = (batchCount + workerCount - 1) / workerCount;
+    const VkFramebuffer sceneFramebuffer = _sceneFramebuffers[_currentFrame];
+
+    // Split the sorted batches into contiguous chunks so state changes stay
+    // coherent inside each secondary buffer; every chunk rebinds its own state.
+    // With the depth pre-pass each worker records its chunk's pre-pass into a
+    // second buffer, and all pre-pass buffers execute before any main pass
+    // buffer, so no chunk is shaded before the whole scene's depth is down.
+    std::vector<Plaster::RenderStats> chunkStats(workerCount);
+    std::vector<std::future<void>> pending;
+    std::vector<VkCommandBuffer> prepassSecondaries;
+    const bool prepass = _depthPrepassEnabled;
+    for (uint32_t worker = 0; worker < workerCount && chunkSize > 0; worker++) {
+        size_t firstBatch = worker * chunkSize;
+        if (firstBatch >= batchCount) break;
+        size_t lastBatch = std::min(firstBatch + chunkSize, batchCount);
+
+        VkCommandPool pool = _workerCommandPools[_currentFrame][worker];
+        VkCommandBuffer secondary = _workerCommandBuffers[_currentFrame][worker];
+        VkCommandBuffer prepassSecondary = _workerPrepassCommandBuffers[_currentFrame][worker];
+        Plaster::RenderStats* stats = &chunkStats[worker];
+        pending.push_back(_recordingPool->submit([this, pool, secondary, prepassSecondary, prepass, sceneFramebuffer,
+                                                  firstBatch, lastBatch, stats]() {
+            vkResetCommandPool(_device, pool, 0);
+            if (prepass) {
+                beginSecondaryCommandBuffer(prepassSecondary, _sceneRenderPass, sceneFramebuffer);
+                bindSceneState(prepassSecondary, *stats);
+                recordDepthPrepass(prepassSecondary, firstBatch, lastBatch, *stats);
+                if (vkEndCommandBuffer(prepassSecondary) != VK_SUCCESS) {
+                    throw std::runtime_error("Failed to record depth pre-pass command buffer!");
+                }
+            }
+            beginSecondaryCommandBuffer(secondary, _sceneRenderPass, sceneFramebuffer);
+            bindSceneState(secondary, *stats);
+            recordBatches(secondary, firstBatch, lastBatch, *stats);
+            if (vkEndCommandBuffer(secondary) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to record secondary command buffer!");
+            }
+        }));
+        if (prepass) {
+            prepassSecondaries.push_back(prepassSecondary);
+        }
+        sceneSecondaries.push_back(secondary);
+    }
+    sceneSecondaries.insert(sceneSecondaries.begin(), prepassSecondaries.begin(), prepassSecondaries.end());
+
+    // ImGui draws in the full resolution pass; record it here while workers run
+    uiSecondary = VK_NULL_HANDLE;
+    if (!_headless) {
+        uiSecondary = _uiCommandBuffers[_currentFrame];
+        vkResetCommandBuffer(uiSecondary, 0);
+        beginSecondaryCommandBuffer(uiSecondary, _renderPass, _swapChainFramebuffers[imageIndex]);
+        _imguiManager.render(uiSecondary);
+        if (vkEndCommandBuffer(uiSecondary) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to record UI command buffer!");
+        }
+    }
 
+    // get() rethrows anything a worker threw
+    for (auto& future : pending) {
+        future.get();
+    }
+
+    for (const auto& stats : chunkStats) {
+        _stats.accumulate(stats);
+    }
+}
 // Helper method implementations
 bool VulkanRenderer::isDeviceSuitable(VkPhysicalDevice device) {
     QueueFamilyIndices indices = findQueueFamilies(device);
+
+    if (_headless) {
+        return indices.isComplete();
+    }
     bool extensionsSupported = checkDeviceExtensionSupport(device);
     
     bool swapChainAdequate = false;
@@ -722,8 +1826,13 @@ QueueFamilyIndices VulkanRenderer::findQueueFamilies(VkPhysicalDevice device) {
             indices.graphicsFamily = i;
         }
 
+        // Without a surface the graphics queue doubles as the "present" queue
         VkBool32 presentSupport = false;
-        vkGetPhysicalDeviceSurfaceSupportKHR(device, i, _surface, &presentSupport);
+        if (_headless) {
+            presentSupport = indices.graphicsFamily.has_value() && indices.graphicsFamily.value() == static_cast<uint32_t>(i);
+        } else {
+            vkGetPhysicalDeviceSurfaceSupportKHR(device, i, _surface, &presentSupport);
+        }
 
         if (presentSupport) {
             indices.presentFamily = i;
@@ -736,6 +1845,8 @@ QueueFamilyIndices VulkanRenderer::findQueueFamilies(VkPhysicalDevice device) {
         i++;
     }
 
+    indices.transferFamily = Plaster::UploadManager::findTransferQueueFamily(device);
+
     return indices;
 }
 
@@ -755,6 +1866,21 @@ bool VulkanRenderer::checkDeviceExtensionSupport(VkPhysicalDevice device) {
     return requiredExtensions.empty();
 }
 
+bool VulkanRenderer::checkOptionalDeviceExtension(VkPhysicalDevice device, const char* name) {
+    uint32_t extensionCount;
+    vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+
+    std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+    vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
+
+    for (const auto& extension : availableExtensions) {
+        if (strcmp(extension.extensionName, name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
 SwapChainSupportDetails VulkanRenderer::querySwapChainSupport(VkPhysicalDevice device) {
     SwapChainSupportDetails details;
 
@@ -827,7 +1953,14 @@ void VulkanRenderer::cleanupSwapChain() {
         vkDestroyImageView(_device, imageView, nullptr);
     }
 
-    vkDestroySwapchainKHR(_device, _swapChain, nullptr);
+    if (_headless) {
+        for (size_t i = 0; i < _swapChainImages.size(); i++) {
+            vmaDestroyImage(_allocator, _swapChainImages[i], _offscreenAllocations[i]);
+        }
+        _offscreenAllocations.clear();
+    } else {
+        vkDestroySwapchainKHR(_device, _swapChain, nullptr);
+    }
 }
 
 void VulkanRenderer::recreateSwapChain() {
@@ -840,11 +1973,17 @@ void VulkanRenderer::recreateSwapChain() {
 
     vkDeviceWaitIdle(_device);
 
+    destroySceneTargets();
     cleanupSwapChain();
 
     createSwapChain();
     createImageViews();
     createFramebuffers();
+    createSceneTargets();
+
+    if (!_postProcessor.resize(_device, _allocator, _sceneExtent, _swapChainExtent)) {
+        throw std::runtime_error("Failed to rebuild post processing graphs!");
+    }
 }
 
 VkShaderModule VulkanRenderer::createShaderModule(const std::vector<char>& code) {
@@ -890,7 +2029,6 @@ void VulkanRenderer::createDescriptorResources() {
     // Create uniform buffers for each frame
     _cameraBuffers.resize(MAX_FRAMES_IN_FLIGHT);
     _lightBuffers.resize(MAX_FRAMES_IN_FLIGHT);
-    _objectBuffers.resize(MAX_FRAMES_IN_FLIGHT);
 
     for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
         if (!_cameraBuffers[i].create(_allocator, sizeof(Plaster::CameraUBO),
@@ -906,19 +2044,17 @@ void VulkanRenderer::createDescriptorResources() {
                                      VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT)) {
             throw std::runtime_error("Failed to create light uniform buffer!");
         }
-
-        if (!_objectBuffers[i].create(_allocator, sizeof(Plaster::ObjectUBO),
-                                      VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-                                      VMA_MEMORY_USAGE_CPU_TO_GPU,
-                                      VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT)) {
-            throw std::runtime_error("Failed to create object uniform buffer!");
-        }
     }
 
     // Allocate descriptor sets
     _cameraDescriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
     _objectDescriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
     _materialDescriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
+    _objectBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+
+    if (!_materialRegistry.create(_allocator, MAX_FRAMES_IN_FLIGHT)) {
+        throw std::runtime_error("Failed to create material registry!");
+    }
 
     for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
         if (!_descriptorManager.allocateDescriptorSets(_device, i,
@@ -933,14 +2069,209 @@ void VulkanRenderer::createDescriptorResources() {
                                                   _cameraBuffers[i].getBuffer(),
                                                   _lightBuffers[i].getBuffer());
 
-        // Update object descriptor set
-        _descriptorManager.updateObjectDescriptor(_device, _objectDescriptorSets[i],
-                                                  _objectBuffers[i].getBuffer());
+        // Textures are written once the placeholder exists
+        _descriptorManager.updateMaterialBuffer(_device, _materialDescriptorSets[i], _materialRegistry.getBuffer(i));
+
+        // Create object transform buffer and point the object set at it
+        createObjectBuffer(i, INITIAL_OBJECT_CAPACITY);
     }
 
+    _descriptorArena.create(MAX_FRAMES_IN_FLIGHT);
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(_physicalDevice, &properties);
+    _storageBufferAlignment = properties.limits.minStorageBufferOffsetAlignment;
+
+    createBindlessDescriptors();
+
     std::cout << "Descriptor resources created" << std::endl;
 }
 
+void VulkanRenderer::createBindlessDescriptors() {
+    if (!_bindlessSupported) {
+        if (_bindlessEnabled) {
+            std::cout << "Descriptor indexing unsupported, using fixed material textures" << std::endl;
+        }
+        return;
+    }
+
+    if (!_descriptorManager.createBindlessResources(_device, MAX_FRAMES_IN_FLIGHT, _bindlessTextureCapacity)) {
+        std::cerr << "Failed to create bindless texture table, using fixed material textures" << std::endl;
+        return;
+    }
+
+    _bindlessDescriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
+    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        if (!_descriptorManager.allocateBindlessSet(_device, _bindlessDescriptorSets[i])) {
+            throw std::runtime_error("Failed to allocate bindless descriptor set!");
+        }
+        _descriptorManager.updateMaterialBuffer(_device, _bindlessDescriptorSets[i], _materialRegistry.getBuffer(i));
+    }
+
+    std::cout << "Bindless materials enabled (" << _bindlessTextureCapacity << " texture slots)" << std::endl;
+}
+
+uint32_t VulkanRenderer::registerBindlessTexture(const Plaster::Texture& texture) {
+    if (!isBindlessActive()) {
+        return 0;
+    }
+    if (_bindlessTextureCount >= _bindlessTextureCapacity) {
+        std::cerr << "Bindless texture table full, using the placeholder" << std::endl;
+        return 0;
+    }
+
+    // The array is update-after-bind and partially bound, so a new slot can be
+    // written while earlier frames that never read it are still in flight
+    uint32_t index = _bindlessTextureCount++;
+    for (VkDescriptorSet set : _bindlessDescriptorSets) {
+        _descriptorManager.updateBindlessTexture(_device, set, index, texture.getImageView(), texture.getSampler());
+    }
+    return index;
+}
+
+void VulkanRenderer::createObjectBuffer(uint32_t frameIndex, uint32_t capacity) {
+    if (!_objectBuffers[frameIndex].create(_allocator, sizeof(Plaster::ObjectData) * capacity,
+                                           VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                           VMA_MEMORY_USAGE_CPU_TO_GPU,
+                                           VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT |
+                                           VMA_ALLOCATION_CREATE_MAPPED_BIT)) {
+        throw std::runtime_error("Failed to create object storage buffer!");
+    }
+
+    _descriptorManager.updateObjectDescriptor(_device, _objectDescriptorSets[frameIndex],
+                                              _objectBuffers[frameIndex].getBuffer());
+}
+
+void VulkanRenderer::createGpuCuller() {
+    if (!_gpuCullingEnabled) {
+        return;
+    }
+    if (!_gpuCullingSupported) {
+        std::cout << "drawIndirectFirstInstance unsupported, culling on the CPU" << std::endl;
+        return;
+    }
+
+    _gpuCuller.setShaderCacheDirectory(_shaderCacheDirectory);
+    if (!_gpuCuller.create(_allocator, _device, _pipelineCache.getHandle(), _cameraBuffers,
+                           _multiDrawIndirectSupported, _vkCmdDrawIndexedIndirectCount)) {
+        std::cerr << "Failed to create GPU culler, culling on the CPU" << std::endl;
+        _gpuCuller.destroy(_allocator, _device);
+        return;
+    }
+
+    // The vertex shader reads the culler's object buffer through its own set 1
+    _culledObjectDescriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
+    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        if (!_descriptorManager.allocateObjectSet(_device, _culledObjectDescriptorSets[i])) {
+            throw std::runtime_error("Failed to allocate culled object descriptor set!");
+        }
+        _descriptorManager.updateObjectDescriptor(_device, _culledObjectDescriptorSets[i],
+                                                  _gpuCuller.getObjectBuffer(i));
+    }
+}
+
+void VulkanRenderer::uploadObjectTransforms() {
+    if (!_currentScene) {
+        return;
+    }
+
+    const auto& objects = _currentScene->getObjects();
+
+    // GPU-driven: hand over raw transforms, the cull pass does the rest
+    if (_gpuCuller.isCreated()) {
+        if (_gpuCuller.update(_currentFrame, objects, _currentScene->getStructureVersion())) {
+            _descriptorManager.updateObjectDescriptor(_device, _culledObjectDescriptorSets[_currentFrame],
+                                                      _gpuCuller.getObjectBuffer(_currentFrame));
+        }
+        return;
+    }
+
+    _renderQueue.build(*_currentScene, static_cast<float>(_sceneExtent.height), _lodSelection);
+
+    const auto& instanceOrder = _renderQueue.getInstanceOrder();
+    if (instanceOrder.empty()) {
+        return;
+    }
+
+    const VkDeviceSize requiredSize = sizeof(Plaster::ObjectData) * instanceOrder.size();
+
+    // Grow this frame's buffer if the scene outgrew it. Its fence has already
+    // signalled, so neither the buffer nor its descriptor set is in use.
+    if (requiredSize > _objectBuffers[_currentFrame].getSize()) {
+        uint32_t capacity = static_cast<uint32_t>(_objectBuffers[_currentFrame].getSize() / sizeof(Plaster::ObjectData));
+        while (capacity < instanceOrder.size()) {
+            capacity *= 2;
+        }
+
+        _objectBuffers[_currentFrame].destroy(_allocator);
+        createObjectBuffer(_currentFrame, capacity);
+    }
+
+    // Write every transform and material in one pass, in batch order, into the persistently mapped buffer
+    auto* objectData = static_cast<Plaster::ObjectData*>(_objectBuffers[_currentFrame].getMappedData());
+    for (size_t slot = 0; slot < instanceOrder.size(); slot++) {
+        const Plaster::RenderObject& obj = objects[instanceOrder[slot]];
+        glm::mat4 model = obj.getModelMatrix();
+        // Packed meshes store positions in their bounding box; normals are unaffected
+        objectData[slot].model = model * obj.mesh->getDequantizeMatrix();
+        objectData[slot].normalMatrix = glm::mat3x4(glm::transpose(glm::inverse(model)));
+        objectData[slot].materialIndex = obj.material->getIndex();
+    }
+
+    _objectBuffers[_currentFrame].flush(_allocator, 0, requiredSize);
+}
+
+void VulkanRenderer::allocatePerObjectSets() {
+    // Allocated up front on this thread: the arena is not shared with the
+    // recording workers, which only read the sets. The frame slot's arena was
+    // reset once its fence signalled, so last frame's sets are gone.
+    const size_t objectCount = _renderQueue.getInstanceOrder().size();
+    const VkBuffer objectBuffer = _objectBuffers[_currentFrame].getBuffer();
+
+    _perObjectSets.resize(objectCount);
+    for (size_t slot = 0; slot < objectCount; slot++) {
+        // Both sizes are powers of two, so the aligned start is a whole number of slots back
+        const VkDeviceSize offset = slot * sizeof(Plaster::ObjectData);
+        _perObjectSets[slot] = _descriptorArena.allocate(_device, _descriptorManager.getObjectLayout(), {
+            Plaster::DescriptorBinding::forBuffer(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, objectBuffer,
+                                                  offset - offset % _storageBufferAlignment)
+        });
+        if (_perObjectSets[slot] == VK_NULL_HANDLE) {
+            throw std::runtime_error("Failed to allocate per-object descriptor set!");
+        }
+    }
+}
+
+void VulkanRenderer::createPlaceholderTexture() {
+    // Bound to the palette, blue noise and albedo slots until real textures are loaded
+    if (!_placeholderTexture.createPlaceholder(_allocator, _device, _uploadManager)) {
+        throw std::runtime_error("Failed to create placeholder texture!");
+    }
+
+    // The palette, blue noise and albedo slots of the fixed material sets
+    for (VkDescriptorSet set : _materialDescriptorSets) {
+        for (uint32_t binding = 1; binding <= 3; binding++) {
+            _descriptorManager.updateMaterialTexture(_device, set, binding, _placeholderTexture.getImageView(),
+                                                     _placeholderTexture.getSampler());
+        }
+    }
+
+    // Bindless slot 0, the default albedo of every material
+    registerBindlessTexture(_placeholderTexture);
+}
+
+void VulkanRenderer::flushMaterials() {
+    // This frame's fence has signalled, so its registry buffer and set 2 are
+    // free to rewrite; only materials edited since its last use are copied
+    bool recreated = false;
+    if (!_materialRegistry.flush(_allocator, _currentFrame, recreated)) {
+        throw std::runtime_error("Failed to flush material registry!");
+    }
+    if (recreated) {
+        _descriptorManager.updateMaterialBuffer(_device, getMaterialSet(), _materialRegistry.getBuffer(_currentFrame));
+    }
+}
+
 void VulkanRenderer::renderScene(Plaster::Scene& scene) {
     _currentScene = &scene;
 
@@ -955,6 +2286,7 @@ void VulkanRenderer::renderScene(Plaster::Scene& scene) {
     cameraData.cameraPos = scene.getCamera().getPosition();
 
     _cameraBuffers[_currentFrame].copyData(_allocator, &cameraData, sizeof(Plaster::CameraUBO));
+    _postProcessor.setDepthRange(scene.getCamera().getNearPlane(), scene.getCamera().getFarPlane());
 
     // Update light uniform buffer
     _lightBuffers[_currentFrame].copyData(_allocator, &scene.getLights(), sizeof(Plaster::LightUBO));
@@ -5,10 +5,25 @@
 #include <vector>
 #include <optional>
 #include <memory>
+#include <string>
 #include "../ui/ImGuiManager.h"
 #include "DescriptorManager.h"
+#include "DescriptorAllocator.h"
 #include "VulkanBuffer.h"
 #include "UniformBuffers.h"
+#include "RenderQueue.h"
+#include "RenderStats.h"
+#include "Texture.h"
+#include "PipelineCache.h"
+#include "UploadManager.h"
+#include "GeometryPool.h"
+#include "GpuCuller.h"
+#include "MaterialRegistry.h"
+#include "PushConstants.h"
+#include "ShaderCompiler.h"
+#include "../PostProcessor/PostProcessor.h"
+#include "../core/ThreadPool.h"
+#include <unordered_map>
 
 class Window;
 
@@ -19,6 +34,7 @@ namespace Plaster {
 struct QueueFamilyIndices {
     std::optional<uint32_t> graphicsFamily;
     std::optional<uint32_t> presentFamily;
+    std::optional<uint32_t> transferFamily; // Transfer-only family, when the device has one
 
     bool isComplete() const {
         return graphicsFamily.has_value() && presentFamily.has_value();
@@ -37,11 +53,85 @@ public:
     ~VulkanRenderer();
 
     void initialize(const Window& window);
+
+    // Render into offscreen images with no window, surface or swapchain.
+    // Works on CPU implementations such as lavapipe.
+    void initializeHeadless(uint32_t width, uint32_t height);
     void cleanup();
     void drawFrame();
     void renderScene(Plaster::Scene& scene);
 
     bool isInitialized() const { return _initialized; }
+    bool isHeadless() const { return _headless; }
+
+    // Resolution the scene is rendered at before a nearest-neighbour upscale to
+    // the output, for the chunky PS1 look. Either a fixed size (320x240,
+    // 640x480, ...) or a fraction of the output size; set before initialize().
+    // A 0x0 size with no scale renders at full resolution.
+    void setInternalResolution(uint32_t width, uint32_t height) { _internalWidth = width; _internalHeight = height; _internalScale = 0.0f; }
+    void setInternalResolutionScale(float scale) { _internalScale = scale; }
+    VkExtent2D getInternalExtent() const { return _sceneExtent; }
+
+    // Depth-only pass before the main pass so the expensive fragment shader
+    // runs once per pixel. Can be toggled at any time.
+    void setDepthPrepassEnabled(bool enabled) { _depthPrepassEnabled = enabled; }
+    bool isDepthPrepassEnabled() const { return _depthPrepassEnabled; }
+
+    // Cull and build draws in a compute pass and draw the scene with indirect
+    // commands, so CPU frame cost does not grow with object count. Falls back
+    // to CPU batching when disabled or when the device lacks
+    // drawIndirectFirstInstance. Must be set before initialize().
+    void setGpuCullingEnabled(bool enabled) { _gpuCullingEnabled = enabled; }
+    bool isGpuCullingActive() const { return _gpuCuller.isCreated(); }
+
+    // How CPU-batched draws find their object data: one instanced draw per
+    // batch, or one draw per object with the slot in a push constant or a
+    // descriptor set bound before each draw. The per-draw modes exist to
+    // measure the cost of per-object data; GPU culling ignores the setting.
+    // Can be changed at any time.
+    void setDrawDataMode(Plaster::DrawDataMode mode) { _drawDataMode = mode; }
+    Plaster::DrawDataMode getDrawDataMode() const { return _drawDataMode; }
+
+    // Meshes switch to a coarser LOD once its error projects below the
+    // threshold in pixels at the internal resolution. A zero threshold always
+    // draws LOD 0. Can be changed at any time.
+    void setLodSelection(const Plaster::LodSelection& selection) { _lodSelection = selection; }
+    const Plaster::LodSelection& getLodSelection() const { return _lodSelection; }
+
+    // Append a full-screen effect (a fragment shader, see PostProcessor) run on
+    // the scene before it is upscaled; scale sizes its target against the
+    // scene and inputs names the scene depth and noise it samples. Must be
+    // called before initialize().
+    void addPostEffect(const std::string& fragmentShaderPath, float scale = 1.0f,
+                       Plaster::PostEffectInputs inputs = {}) {
+        _postProcessor.addEffect(fragmentShaderPath, scale, inputs);
+    }
+
+    // Bindless textures: every texture in one descriptor array, indexed by the
+    // material, instead of fixed texture bindings in set 2. Needs
+    // VK_EXT_descriptor_indexing and falls back to the fixed bindings without
+    // it. Must be set before initialize().
+    void setBindlessEnabled(bool enabled) { _bindlessEnabled = enabled; }
+    bool isBindlessActive() const { return !_bindlessDescriptorSets.empty(); }
+
+    // Add a texture to the bindless table and return its index for
+    // PlastibooMaterial::setAlbedoTexture. Returns 0, the white placeholder,
+    // when bindless is inactive or the table is full.
+    uint32_t registerBindlessTexture(const Plaster::Texture& texture);
+
+    // Copy the most recently rendered headless frame to tightly packed RGBA8
+    void readbackFrame(std::vector<uint8_t>& pixels);
+
+    // Save the most recent headless frame; .png writes a PNG, anything else raw RGBA8
+    bool saveFrame(const std::string& path);
+
+    // Number of worker threads recording scene draws into secondary command
+    // buffers. Must be set before initialize(); 0 or 1 records on the main thread.
+    void setRecordingThreadCount(uint32_t count) { _recordingThreadCount = count; }
+    uint32_t getRecordingThreadCount() const { return _recordingThreadCount; }
+
+    // Counters from the most recently recorded frame
+    const Plaster::RenderStats& getStats() const { return _stats; }
 
     VkDevice getDevice() const { return _device; }
     VkPhysicalDevice getPhysicalDevice() const { return _physicalDevice; }
@@ -49,6 +139,38 @@ public:
     VkQueue getGraphicsQueue() const { return _graphicsQueue; }
     VmaAllocator getAllocator() const { return _allocator; }
 
+    // Batched asset uploads, flushed once per frame
+    Plaster::UploadManager& getUploadManager() { return _uploadManager; }
+
+    // Vertices, and indices of each index type, every vertex format's pool
+    // holds. Pools do not grow, so size them for the scene. Must be set before
+    // initialize().
+    void setGeometryPoolCapacity(uint32_t vertices, uint32_t indices) {
+        _geometryVertexCapacity = vertices;
+        _geometryIndexCapacity = indices;
+    }
+
+    // Shared vertex/index buffers every mesh of a vertex format is sub-allocated from
+    Plaster::GeometryPool& getGeometryPool(Plaster::VertexFormat format = Plaster::VertexFormat::FULL) {
+        return _geometryPools[static_cast<uint32_t>(format)];
+    }
+
+    // Transient descriptor sets for dynamic content, valid until this frame
+    // slot is recorded again
+    Plaster::DescriptorArena& getDescriptorArena() { return _descriptorArena; }
+
+    // Slots for every material's data; pass to PlastibooMaterial::create
+    Plaster::MaterialRegistry& getMaterialRegistry() { return _materialRegistry; }
+
+    // Size of the persistently mapped upload staging ring. Must be set before initialize().
+    void setStagingBufferSize(VkDeviceSize bytes) { _stagingBufferSize = bytes; }
+
+    // Directory every shader compile caches SPIR-V in; empty disables the
+    // cache. A cleared cache is emptied before the first compile. Must be set
+    // before initialize().
+    void setShaderCacheDirectory(const std::string& directory) { _shaderCacheDirectory = directory; }
+    void setClearShaderCache(bool clear) { _clearShaderCache = clear; }
+
 private:
     // Core Vulkan objects
     VkInstance _instance = VK_NULL_HANDLE;
@@ -56,6 +178,7 @@ private:
     VkDevice _device = VK_NULL_HANDLE;
     VkQueue _graphicsQueue = VK_NULL_HANDLE;
     VkQueue _presentQueue = VK_NULL_HANDLE;
+    VkQueue _transferQueue = VK_NULL_HANDLE;
     VkSurfaceKHR _surface = VK_NULL_HANDLE;
 
     // Swap chain
@@ -65,16 +188,66 @@ private:
     VkExtent2D _swapChainExtent;
     std::vector<VkImageView> _swapChainImageViews;
 
-    // Render pass and pipeline
+    // Low-resolution scene target (one per frame in flight), upscaled into the output
+    VkRenderPass _sceneRenderPass = VK_NULL_HANDLE;
+    VkExtent2D _sceneExtent{};
+    uint32_t _internalWidth = 320;
+    uint32_t _internalHeight = 240;
+    float _internalScale = 0.0f;
+    std::vector<VkImage> _sceneImages;
+    std::vector<VmaAllocation> _sceneAllocations;
+    std::vector<VkImageView> _sceneImageViews;
+    std::vector<VkFramebuffer> _sceneFramebuffers;
+
+    // Post effects and the upscale into the output, as a render graph per frame in flight
+    Plaster::PostProcessor _postProcessor;
+
+    // Scene depth, at the internal resolution and recreated with it
+    VkFormat _depthFormat = VK_FORMAT_UNDEFINED;
+    std::vector<VkImage> _depthImages;
+    std::vector<VmaAllocation> _depthAllocations;
+    std::vector<VkImageView> _depthImageViews;
+    VkPipeline _depthPrepassPipelines[Plaster::VERTEX_FORMAT_COUNT] = {};
+    bool _depthPrepassEnabled = false;
+
+    // Fragment shader invocation counts per frame in flight, for overdraw
+    VkQueryPool _statisticsQueryPool = VK_NULL_HANDLE;
+    std::vector<bool> _statisticsPending;
+    uint64_t _lastFragmentInvocations = 0;
+    bool _pipelineStatisticsSupported = false;
+    bool _inheritedQueriesSupported = false;
+
+    // GPU-driven culling and indirect drawing
+    Plaster::GpuCuller _gpuCuller;
+    std::vector<VkDescriptorSet> _culledObjectDescriptorSets; // Set 1 over the culler's object buffer
+    bool _gpuCullingEnabled = true;
+    Plaster::DrawDataMode _drawDataMode = Plaster::DrawDataMode::INSTANCED;
+    Plaster::LodSelection _lodSelection;
+    bool _gpuCullingSupported = false;
+    bool _multiDrawIndirectSupported = false;
+    PFN_vkCmdDrawIndexedIndirectCountKHR _vkCmdDrawIndexedIndirectCount = nullptr;
+
+    // Render pass and pipeline (_renderPass draws ImGui over the upscaled scene)
     VkRenderPass _renderPass = VK_NULL_HANDLE;
     VkPipelineLayout _pipelineLayout = VK_NULL_HANDLE;
-    VkPipeline _graphicsPipeline = VK_NULL_HANDLE;
+    VkPipeline _graphicsPipelines[Plaster::VERTEX_FORMAT_COUNT] = {};  // Indexed by VertexFormat
+    Plaster::PipelineCache _pipelineCache;
     std::vector<VkFramebuffer> _swapChainFramebuffers;
 
     // Command buffers
     VkCommandPool _commandPool = VK_NULL_HANDLE;
     std::vector<VkCommandBuffer> _commandBuffers;
 
+    // Parallel recording: one pool per worker slot per frame in flight, so no
+    // pool is ever touched by two threads at once, holding that worker's main
+    // pass and depth pre-pass secondary buffers
+    uint32_t _recordingThreadCount = 0;
+    std::unique_ptr<Plaster::ThreadPool> _recordingPool;
+    std::vector<std::vector<VkCommandPool>> _workerCommandPools;
+    std::vector<std::vector<VkCommandBuffer>> _workerCommandBuffers;
+    std::vector<std::vector<VkCommandBuffer>> _workerPrepassCommandBuffers;
+    std::vector<VkCommandBuffer> _uiCommandBuffers;
+
     // Synchronization
     std::vector<VkSemaphore> _imageAvailableSemaphores;
     std::vector<VkSemaphore> _renderFinishedSemaphores;
@@ -88,6 +261,12 @@ private:
     bool _initialized = false;
     const Window* _window = nullptr;
 
+    // Headless mode: one VMA-allocated color target per frame in flight stands
+    // in for the swapchain images, indexed by the current frame
+    bool _headless = false;
+    std::vector<VmaAllocation> _offscreenAllocations;
+    uint32_t _lastImageIndex = 0;
+
     // ImGui Manager
     ImGuiManager _imguiManager;
 
@@ -95,20 +274,57 @@ private:
     VmaAllocator _allocator = VK_NULL_HANDLE;
 
     // Plaster rendering components
+    Plaster::UploadManager _uploadManager;
+    VkDeviceSize _stagingBufferSize = Plaster::UploadManager::DEFAULT_STAGING_SIZE;
+    std::string _shaderCacheDirectory = Plaster::ShaderCompiler::DEFAULT_CACHE_DIRECTORY;
+    bool _clearShaderCache = false;
+    Plaster::GeometryPool _geometryPools[Plaster::VERTEX_FORMAT_COUNT];
+    uint32_t _geometryVertexCapacity = Plaster::GeometryPool::DEFAULT_VERTEX_CAPACITY;
+    uint32_t _geometryIndexCapacity = Plaster::GeometryPool::DEFAULT_INDEX_CAPACITY;
     Plaster::DescriptorManager _descriptorManager;
 
     // Uniform buffers (per frame)
     std::vector<Plaster::VulkanBuffer> _cameraBuffers;
     std::vector<Plaster::VulkanBuffer> _lightBuffers;
+
+    // Object transforms (per frame, persistently mapped, one slot per object)
     std::vector<Plaster::VulkanBuffer> _objectBuffers;
+    static const uint32_t INITIAL_OBJECT_CAPACITY = 1024;
 
     // Descriptor sets (per frame)
     std::vector<VkDescriptorSet> _cameraDescriptorSets;
     std::vector<VkDescriptorSet> _objectDescriptorSets;
-    std::vector<VkDescriptorSet> _materialDescriptorSets;
+    std::vector<VkDescriptorSet> _materialDescriptorSets;  // Set 2: registry buffer and fixed textures
+
+    // Every material's data, one buffer per frame so it can grow between frames
+    Plaster::MaterialRegistry _materialRegistry;
+
+    // Bindless set 2 replacing _materialDescriptorSets when supported
+    std::vector<VkDescriptorSet> _bindlessDescriptorSets;
+    bool _bindlessEnabled = true;
+    bool _bindlessSupported = false;
+    bool _physicalDeviceProperties2Supported = false;
+    uint32_t _bindlessTextureCapacity = 0;
+    uint32_t _bindlessTextureCount = 0;
+    static const uint32_t MAX_BINDLESS_TEXTURES = 4096;
+
+    // Bound to the palette, blue noise and albedo slots until real textures are loaded
+    Plaster::Texture _placeholderTexture;
+
+    // Per-frame transient sets
+    Plaster::DescriptorArena _descriptorArena;
 
-    // Scene being rendered
+    // PER_DRAW_DESCRIPTOR_SETS: a set per object slot, from the arena, each
+    // pointing set 1 at that slot's ObjectData. Offsets honour the device's
+    // storage buffer alignment, so a set may start a few slots early and its
+    // draw's first instance makes up the difference.
+    std::vector<VkDescriptorSet> _perObjectSets;
+    VkDeviceSize _storageBufferAlignment = 1;
+
+    // Scene being rendered, sorted into instanced draws each frame
     Plaster::Scene* _currentScene = nullptr;
+    Plaster::RenderQueue _renderQueue;
+    Plaster::RenderStats _stats;
 
     // Validation layers
 #ifdef NDEBUG
@@ -131,6 +347,9 @@ private:
     void pickPhysicalDevice();
     void createLogicalDevice();
     void createAllocator();
+    void createUploadManager();
+    void createGeometryPool();
+    void createPipelineCache();
     void createSwapChain();
     void createImageViews();
     void createRenderPass();
@@ -139,7 +358,21 @@ private:
     void createFramebuffers();
     void createCommandPool();
     void createCommandBuffers();
+    void createParallelRecordingResources();
+    void destroyParallelRecordingResources();
     void createSyncObjects();
+    void createPlaceholderTexture();
+    void createGpuCuller();
+    void createRenderResources();
+    void createOffscreenTargets();
+    void createRenderTarget(VkExtent2D extent, VkFormat format, VkImageUsageFlags usage, VkImageAspectFlags aspect,
+                            VkImage& image, VmaAllocation& allocation, VkImageView& view);
+    void createPostProcessor();
+    VkFormat findDepthFormat();
+    void createStatisticsQueries();
+    void readStatisticsQuery();
+    void createSceneTargets();
+    void destroySceneTargets();
 
     // Helper methods
     bool checkValidationLayerSupport();
@@ -147,14 +380,38 @@ private:
     bool isDeviceSuitable(VkPhysicalDevice device);
     QueueFamilyIndices findQueueFamilies(VkPhysicalDevice device);
     bool checkDeviceExtensionSupport(VkPhysicalDevice device);
+    bool checkOptionalDeviceExtension(VkPhysicalDevice device, const char* name);
+    bool checkInstanceExtensionSupport(const char* name);
+    bool queryBindlessSupport(VkPhysicalDeviceDescriptorIndexingFeaturesEXT& enabledFeatures);
     SwapChainSupportDetails querySwapChainSupport(VkPhysicalDevice device);
     VkSurfaceFormatKHR chooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& availableFormats);
     VkPresentModeKHR chooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes);
     VkExtent2D chooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities);
     VkShaderModule createShaderModule(const std::vector<char>& code);
 
+    // Object transform buffers
+    void createObjectBuffer(uint32_t frameIndex, uint32_t capacity);
+    void uploadObjectTransforms();
+    void allocatePerObjectSets();
+
+    // Materials and bindless textures
+    void createBindlessDescriptors();
+    void flushMaterials();
+    VkDescriptorSet getMaterialSet() const {
+        return isBindlessActive() ? _bindlessDescriptorSets[_currentFrame] : _materialDescriptorSets[_currentFrame];
+    }
+
     // Command buffer recording
     void recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex);
+    // Scene state every scene command buffer starts from, then the depth
+    // pre-pass and main pass draws of a range of batches
+    void bindSceneState(VkCommandBuffer commandBuffer, Plaster::RenderStats& stats);
+    void recordDepthPrepass(VkCommandBuffer commandBuffer, size_t firstBatch, size_t lastBatch, Plaster::RenderStats& stats);
+    void recordBatches(VkCommandBuffer commandBuffer, size_t firstBatch, size_t lastBatch, Plaster::RenderStats& stats);
+    void recordIndirectDraws(VkCommandBuffer commandBuffer, Plaster::RenderStats& stats);
+    void recordSecondaryCommandBuffers(uint32_t imageIndex, std::vector<VkCommandBuffer>& sceneSecondaries,
+                                       VkCommandBuffer& uiSecondary);
+    void beginSecondaryCommandBuffer(VkCommandBuffer commandBuffer, VkRenderPass renderPass, VkFramebuffer framebuffer);
 
     // Cleanup helpers
     void cleanupSwapChain();
@@ -0,0 +1,394 @@
+#include "DynamicAABBTree.h"
+#include <algorithm>
+#include <array>
+#include <limits>
+
+namespace Plaster {
+
+static const uint32_t SAH_BIN_COUNT = 12;
+
+DynamicAABBTree::DynamicAABBTree(float margin, float marginScale)
+    : m_root(NULL_NODE)
+    , m_freeList(NULL_NODE)
+    , m_proxyCount(0)
+    , m_margin(margin)
+    , m_marginScale(marginScale)
+{
+}
+
+BoundingBox DynamicAABBTree::fatten(const BoundingBox& box) const {
+    glm::vec3 grow = glm::vec3(m_margin) + (box.max - box.min) * m_marginScale;
+    return BoundingBox(box.min - grow, box.max + grow);
+}
+
+int32_t DynamicAABBTree::createProxy(const BoundingBox& box, uint32_t userData) {
+    int32_t proxy = allocateNode();
+    Node& node = m_nodes[proxy];
+    node.box = fatten(box);
+    node.userData = userData;
+    node.height = 0;
+
+    insertLeaf(proxy);
+    m_proxyCount++;
+    return proxy;
+}
+
+void DynamicAABBTree::destroyProxy(int32_t proxy) {
+    removeLeaf(proxy);
+    freeNode(proxy);
+    m_proxyCount--;
+}
+
+bool DynamicAABBTree::moveProxy(int32_t proxy, const BoundingBox& box) {
+    // Still inside the fat box: nothing above the leaf needs to change
+    if (m_nodes[proxy].box.contains(box)) {
+        return false;
+    }
+
+    removeLeaf(proxy);
+    m_nodes[proxy].box = fatten(box);
+    insertLeaf(proxy);
+    return true;
+}
+
+void DynamicAABBTree::clear() {
+    m_nodes.clear();
+    m_root = NULL_NODE;
+    m_freeList = NULL_NODE;
+    m_proxyCount = 0;
+}
+
+void DynamicAABBTree::build(const std::vector<BoundingBox>& boxes, const std::vector<uint32_t>& userData,
+                            std::vector<int32_t>& proxies) {
+    clear();
+    proxies.assign(boxes.size(), NULL_NODE);
+    if (boxes.empty()) {
+        return;
+    }
+
+    std::vector<BuildItem> items(boxes.size());
+    for (uint32_t i = 0; i < static_cast<uint32_t>(boxes.size()); i++) {
+        items[i].box = fatten(boxes[i]);
+        items[i].centroid = boxes[i].getCenter();
+        items[i].index = i;
+    }
+
+    m_nodes.reserve(boxes.size() * 2 - 1);
+    m_root = buildRange(items, 0, items.size(), userData, proxies);
+    m_nodes[m_root].parent = NULL_NODE;
+    m_proxyCount = boxes.size();
+}
+
+int32_t DynamicAABBTree::buildRange(std::vector<BuildItem>& items, size_t begin, size_t end,
+                                    const std::vector<uint32_t>& userData, std::vector<int32_t>& proxies) {
+    if (end - begin == 1) {
+        const BuildItem& item = items[begin];
+        int32_t leaf = allocateNode();
+        m_nodes[leaf].box = item.box;
+        m_nodes[leaf].userData = userData[item.index];
+        m_nodes[leaf].height = 0;
+        proxies[item.index] = leaf;
+        return leaf;
+    }
+
+    BoundingBox centroidBounds;
+    for (size_t i = begin; i < end; i++) {
+        centroidBounds.expand(items[i].centroid);
+    }
+
+    // Binned SAH: drop centroids into a few bins per axis and take the bin
+    // boundary that minimises count * area summed over both sides
+    struct Bin {
+        BoundingBox box;
+        uint32_t count = 0;
+    };
+
+    float bestCost = std::numeric_limits<float>::max();
+    int bestAxis = -1;
+    uint32_t bestSplit = 0;
+    for (int axis = 0; axis < 3; axis++) {
+        float extent = centroidBounds.max[axis] - centroidBounds.min[axis];
+        if (extent <= 0.0f) continue;
+
+        std::array<Bin, SAH_BIN_COUNT> bins{};
+        float scale = SAH_BIN_COUNT / extent;
+        for (size_t i = begin; i < end; i++) {
+            uint32_t bin = std::min(static_cast<uint32_t>((items[i].centroid[axis] - centroidBounds.min[axis]) * scale),
+                                    SAH_BIN_COUNT - 1);
+            bins[bin].count++;
+            bins[bin].box.expand(items[i].box);
+        }
+
+        // Right-hand sweep first so the left sweep can evaluate every split in one pass
+        std::array<float, SAH_BIN_COUNT> rightArea{};
+        std::array<uint32_t, SAH_BIN_COUNT> rightCount{};
+        BoundingBox right;
+        uint32_t count = 0;
+        for (uint32_t b = SAH_BIN_COUNT - 1; b > 0; b--) {
+            if (bins[b].count > 0) right.expand(bins[b].box);
+            count += bins[b].count;
+            rightArea[b] = right.isValid() ? right.getSurfaceArea() : 0.0f;
+            rightCount[b] = count;
+        }
+
+        BoundingBox left;
+        count = 0;
+        for (uint32_t b = 0; b < SAH_BIN_COUNT - 1; b++) {
+            if (bins[b].count > 0) left.expand(bins[b].box);
+            count += bins[b].count;
+            if (count == 0 || rightCount[b + 1] == 0) continue;
+
+            float cost = count * left.getSurfaceArea() + rightCount[b + 1] * rightArea[b + 1];
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestAxis = axis;
+                bestSplit = b;
+            }
+        }
+    }
+
+    size_t mid = begin + (end - begin) / 2;
+    if (bestAxis >= 0) {
+        float minCentroid = centroidBounds.min[bestAxis];
+        float scale = SAH_BIN_COUNT / (centroidBounds.max[bestAxis] - minCentroid);
+        auto split = std::partition(items.begin() + begin, items.begin() + end, [&](const BuildItem& item) {
+            uint32_t bin = std::min(static_cast<uint32_t>((item.centroid[bestAxis] - minCentroid) * scale),
+                                    SAH_BIN_COUNT - 1);
+            return bin <= bestSplit;
+        });
+        size_t splitIndex = static_cast<size_t>(split - items.begin());
+        if (splitIndex > begin && splitIndex < end) {
+            mid = splitIndex;
+        }
+    }
+    // Otherwise every centroid coincides and any even split is as good as another
+
+    int32_t child1 = buildRange(items, begin, mid, userData, proxies);
+    int32_t child2 = buildRange(items, mid, end, userData, proxies);
+
+    int32_t node = allocateNode();
+    m_nodes[node].child1 = child1;
+    m_nodes[node].child2 = child2;
+    m_nodes[child1].parent = node;
+    m_nodes[child2].parent = node;
+    refit(node);
+    return node;
+}
+
+int32_t DynamicAABBTree::allocateNode() {
+    if (m_freeList == NULL_NODE) {
+        m_nodes.emplace_back();
+        return static_cast<int32_t>(m_nodes.size() - 1);
+    }
+
+    int32_t node = m_freeList;
+    m_freeList = m_nodes[node].parent;
+    m_nodes[node] = Node{};
+    return node;
+}
+
+void DynamicAABBTree::freeNode(int32_t node) {
+    m_nodes[node].parent = m_freeList;
+    m_nodes[node].child1 = NULL_NODE;
+    m_nodes[node].child2 = NULL_NODE;
+    m_nodes[node].height = -1;
+    m_freeList = node;
+}
+
+void DynamicAABBTree::insertLeaf(int32_t leaf) {
+    if (m_root == NULL_NODE) {
+        m_root = leaf;
+        m_nodes[leaf].parent = NULL_NODE;
+        return;
+    }
+
+    // Walk down to the sibling that grows the tree's total surface area least
+    const BoundingBox leafBox = m_nodes[leaf].box;
+    int32_t index = m_root;
+    while (!m_nodes[index].isLeaf()) {
+        const Node& node = m_nodes[index];
+        float area = node.box.getSurfaceArea();
+        float combinedArea = BoundingBox::merge(node.box, leafBox).getSurfaceArea();
+
+        // Cost of pairing with this node, and the cost pushed onto every
+        // ancestor if the leaf goes further down
+        float cost = 2.0f * combinedArea;
+        float inheritanceCost = 2.0f * (combinedArea - area);
+
+        float childCost[2];
+        int32_t children[2] = {node.child1, node.child2};
+        for (int c = 0; c < 2; c++) {
+            const Node& child = m_nodes[children[c]];
+            float merged = BoundingBox::merge(leafBox, child.box).getSurfaceArea();
+            childCost[c] = (child.isLeaf() ? merged : merged - child.box.getSurfaceArea()) + inheritanceCost;
+        }
+
+        if (cost < childCost[0] && cost < childCost[1]) {
+            break;
+        }
+        index = childCost[0] < childCost[1] ? children[0] : children[1];
+    }
+
+    int32_t sibling = index;
+    int32_t oldParent = m_nodes[sibling].parent;
+    int32_t newParent = allocateNode();
+    m_nodes[newParent].parent = oldParent;
+    m_nodes[newParent].box = BoundingBox::merge(leafBox, m_nodes[sibling].box);
+    m_nodes[newParent].height = m_nodes[sibling].height + 1;
+    m_nodes[newParent].child1 = sibling;
+    m_nodes[newParent].child2 = leaf;
+    m_nodes[sibling].parent = newParent;
+    m_nodes[leaf].parent = newParent;
+
+    if (oldParent == NULL_NODE) {
+        m_root = newParent;
+    } else if (m_nodes[oldParent].child1 == sibling) {
+        m_nodes[oldParent].child1 = newParent;
+    } else {
+        m_nodes[oldParent].child2 = newParent;
+    }
+
+    // Refit and rebalance the ancestors
+    index = m_nodes[leaf].parent;
+    while (index != NULL_NODE) {
+        index = balance(index);
+        refit(index);
+        index = m_nodes[index].parent;
+    }
+}
+
+void DynamicAABBTree::removeLeaf(int32_t leaf) {
+    if (leaf == m_root) {
+        m_root = NULL_NODE;
+        return;
+    }
+
+    int32_t parent = m_nodes[leaf].parent;
+    int32_t grandParent = m_nodes[parent].parent;
+    int32_t sibling = m_nodes[parent].child1 == leaf ? m_nodes[parent].child2 : m_nodes[parent].child1;
+
+    if (grandParent == NULL_NODE) {
+        m_root = sibling;
+        m_nodes[sibling].parent = NULL_NODE;
+        freeNode(parent);
+        return;
+    }
+
+    // The sibling takes the parent's place
+    if (m_nodes[grandParent].child1 == parent) {
+        m_nodes[grandParent].child1 = sibling;
+    } else {
+        m_nodes[grandParent].child2 = sibling;
+    }
+    m_nodes[sibling].parent = grandParent;
+    freeNode(parent);
+
+    int32_t index = grandParent;
+    while (index != NULL_NODE) {
+        index = balance(index);
+        refit(index);
+        index = m_nodes[index].parent;
+    }
+}
+
+void DynamicAABBTree::refit(int32_t index) {
+    Node& node = m_nodes[index];
+    const Node& child1 = m_nodes[node.child1];
+    const Node& child2 = m_nodes[node.child2];
+    node.box = BoundingBox::merge(child1.box, child2.box);
+    node.height = 1 + std::max(child1.height, child2.height);
+}
+
+// Rotate the taller grandchild up when the two subtrees of iA differ in
+// height by more than one. Returns the node now at iA's position.
+int32_t DynamicAABBTree::balance(int32_t iA) {
+    Node& A = m_nodes[iA];
+    if (A.isLeaf() || A.height < 2) {
+        return iA;
+    }
+
+    int32_t iB = A.child1;
+    int32_t iC = A.child2;
+    Node& B = m_nodes[iB];
+    Node& C = m_nodes[iC];
+
+    int32_t heightDifference = C.height - B.height;
+
+    auto replaceChild = [this](int32_t parent, int32_t oldChild, int32_t newChild) {
+        if (parent == NULL_NODE) {
+            m_root = newChild;
+        } else if (m_nodes[parent].child1 == oldChild) {
+            m_nodes[parent].child1 = newChild;
+        } else {
+            m_nodes[parent].child2 = newChild;
+        }
+    };
+
+    // C is taller: rotate it up
+    if (heightDifference > 1) {
+        int32_t iF = C.child1;
+        int32_t iG = C.child2;
+        Node& F = m_nodes[iF];
+        Node& G = m_nodes[iG];
+
+        C.child1 = iA;
+        C.parent = A.parent;
+        A.parent = iC;
+        replaceChild(C.parent, iA, iC);
+
+        if (F.height > G.height) {
+            C.child2 = iF;
+            A.child2 = iG;
+            G.parent = iA;
+            A.box = BoundingBox::merge(B.box, G.box);
+            C.box = BoundingBox::merge(A.box, F.box);
+            A.height = 1 + std::max(B.height, G.height);
+            C.height = 1 + std::max(A.height, F.height);
+        } else {
+            C.child2 = iG;
+            A.child2 = iF;
+            F.parent = iA;
+            A.box = BoundingBox::merge(B.box, F.box);
+            C.box = BoundingBox::merge(A.box, G.box);
+            A.height = 1 + std::max(B.height, F.height);
+            C.height = 1 + std::max(A.height, G.height);
+        }
+        return iC;
+    }
+
+    // B is taller: rotate it up
+    if (heightDifference < -1) {
+        int32_t iD = B.child1;
+        int32_t iE = B.child2;
+        Node& D = m_nodes[iD];
+        Node& E = m_nodes[iE];
+
+        B.child1 = iA;
+        B.parent = A.parent;
+        A.parent = iB;
+        replaceChild(B.parent, iA, iB);
+
+        if (D.height > E.height) {
+            B.child2 = iD;
+            A.child1 = iE;
+            E.parent = iA;
+            A.box = BoundingBox::merge(C.box, E.box);
+            B.box = BoundingBox::merge(A.box, D.box);
+            A.height = 1 + std::max(C.height, E.height);
+            B.height = 1 + std::max(A.height, D.height);
+        } else {
+            B.child2 = iE;
+            A.child1 = iD;
+            D.parent = iA;
+            A.box = BoundingBox::merge(C.box, D.box);
+            B.box = BoundingBox::merge(A.box, E.box);
+            A.height = 1 + std::max(C.height, D.height);
+            B.height = 1 + std::max(A.height, E.height);
+        }
+        return iB;
+    }
+
+    return iA;
+}
+
+}
@@ -0,0 +1,184 @@
+#pragma once
+
+#include "../math/BoundingBox.h"
+#include "../math/Frustum.h"
+#include "../math/Ray.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Plaster {
+
+// Dynamic bounding volume hierarchy over object AABBs. Leaves store a "fat"
+// box grown on each axis by a fixed margin plus a fraction of the box's size
+// on that axis, so moves small relative to the object only touch the leaf;
+// larger moves remove and reinsert it, refitting the ancestors on the way. Inserts pick a
+// sibling by surface-area cost and the tree is kept balanced with AVL style
+// rotations. build() replaces the tree with a binned SAH build for level loads.
+class DynamicAABBTree {
+public:
+    static constexpr int32_t NULL_NODE = -1;
+
+    static constexpr float DEFAULT_MARGIN = 0.05f;
+    static constexpr float DEFAULT_MARGIN_SCALE = 0.25f;
+
+    explicit DynamicAABBTree(float margin = DEFAULT_MARGIN, float marginScale = DEFAULT_MARGIN_SCALE);
+    ~DynamicAABBTree() = default;
+
+    // Fat box growth per axis: margin + marginScale * box extent. Applies to
+    // boxes inserted or reinserted afterwards.
+    void setMargin(float margin, float marginScale) {
+        m_margin = margin;
+        m_marginScale = marginScale;
+    }
+    float getMargin() const { return m_margin; }
+    float getMarginScale() const { return m_marginScale; }
+
+    // Insert a box and return its proxy id; userData comes back from queries
+    int32_t createProxy(const BoundingBox& box, uint32_t userData);
+    void destroyProxy(int32_t proxy);
+
+    // Update a proxy's box. Returns true when the leaf had to be reinserted.
+    bool moveProxy(int32_t proxy, const BoundingBox& box);
+
+    uint32_t getUserData(int32_t proxy) const { return m_nodes[proxy].userData; }
+    void setUserData(int32_t proxy, uint32_t userData) { m_nodes[proxy].userData = userData; }
+    const BoundingBox& getFatBox(int32_t proxy) const { return m_nodes[proxy].box; }
+
+    // Discard the tree and bulk build it over boxes. proxies receives the id
+    // of each box; userData[i] is reported for boxes[i].
+    void build(const std::vector<BoundingBox>& boxes, const std::vector<uint32_t>& userData,
+               std::vector<int32_t>& proxies);
+
+    void clear();
+
+    size_t getProxyCount() const { return m_proxyCount; }
+    int32_t getHeight() const { return m_root == NULL_NODE ? 0 : m_nodes[m_root].height; }
+
+    // callback(userData) for every leaf whose fat box overlaps; return false to stop
+    template<typename Callback>
+    void query(const BoundingBox& box, Callback&& callback) const;
+
+    // callback(userData) for every leaf whose fat box touches the frustum; return false to stop
+    template<typename Callback>
+    void query(const Frustum& frustum, Callback&& callback) const;
+
+    // callback(userData, distance) for every leaf the ray enters within
+    // maxDistance. The callback returns the new maxDistance (its own hit
+    // distance to find the closest hit), or a negative value to stop.
+    template<typename Callback>
+    void raycast(const Ray& ray, float maxDistance, Callback&& callback) const;
+
+private:
+    struct Node {
+        BoundingBox box;
+        int32_t parent = NULL_NODE;  // Next free node while on the free list
+        int32_t child1 = NULL_NODE;
+        int32_t child2 = NULL_NODE;
+        int32_t height = 0;          // Leaves are 0, free nodes -1
+        uint32_t userData = 0;
+
+        bool isLeaf() const { return child1 == NULL_NODE; }
+    };
+
+    struct BuildItem {
+        BoundingBox box;
+        glm::vec3 centroid;
+        uint32_t index;
+    };
+
+    std::vector<Node> m_nodes;
+    int32_t m_root;
+    int32_t m_freeList;
+    size_t m_proxyCount;
+    float m_margin;
+    float m_marginScale;
+
+    BoundingBox fatten(const BoundingBox& box) const;
+    int32_t allocateNode();
+    void freeNode(int32_t node);
+    void insertLeaf(int32_t leaf);
+    void removeLeaf(int32_t leaf);
+    int32_t balance(int32_t node);
+    void refit(int32_t node);
+    int32_t buildRange(std::vector<BuildItem>& items, size_t begin, size_t end,
+                       const std::vector<uint32_t>& userData, std::vector<int32_t>& proxies);
+};
+
+template<typename Callback>
+void DynamicAABBTree::query(const BoundingBox& box, Callback&& callback) const {
+    if (m_root == NULL_NODE) return;
+
+    std::vector<int32_t> stack;
+    stack.reserve(64);
+    stack.push_back(m_root);
+    while (!stack.empty()) {
+        const Node& node = m_nodes[stack.back()];
+        stack.pop_back();
+
+        if (!node.box.overlaps(box)) continue;
+
+        if (node.isLeaf()) {
+            if (!callback(node.userData)) return;
+        } else {
+            stack.push_back(node.child1);
+            stack.push_back(node.child2);
+        }
+    }
+}
+
+template<typename Callback>
+void DynamicAABBTree::query(const Frustum& frustum, Callback&& callback) const {
+    if (m_root == NULL_NODE) return;
+
+    // Each entry carries the planes its parent was not already fully inside
+    struct Entry {
+        int32_t node;
+        uint32_t planeMask;
+    };
+
+    std::vector<Entry> stack;
+    stack.reserve(64);
+    stack.push_back({m_root, Frustum::ALL_PLANES});
+    while (!stack.empty()) {
+        Entry entry = stack.back();
+        stack.pop_back();
+        const Node& node = m_nodes[entry.node];
+
+        if (entry.planeMask != 0 && !frustum.intersects(node.box, entry.planeMask)) continue;
+
+        if (node.isLeaf()) {
+            if (!callback(node.userData)) return;
+        } else {
+            stack.push_back({node.child1, entry.planeMask});
+            stack.push_back({node.child2, entry.planeMask});
+        }
+    }
+}
+
+template<typename Callback>
+void DynamicAABBTree::raycast(const Ray& ray, float maxDistance, Callback&& callback) const {
+    if (m_root == NULL_NODE) return;
+
+    std::vector<int32_t> stack;
+    stack.reserve(64);
+    stack.push_back(m_root);
+    while (!stack.empty()) {
+        const Node& node = m_nodes[stack.back()];
+        stack.pop_back();
+
+        float distance = 0.0f;
+        if (!ray.intersects(node.box, maxDistance, distance)) continue;
+
+        if (node.isLeaf()) {
+            float result = callback(node.userData, distance);
+            if (result < 0.0f) return;
+            maxDistance = result;
+        } else {
+            stack.push_back(node.child1);
+            stack.push_back(node.child2);
+        }
+    }
+}
+
+}
@@ -24,8 +24,17 @@ glm::mat4 RenderObject::getNormalMatrix() const {
     return glm::transpose(glm::inverse(model));
 }
 
+BoundingBox RenderObject::getWorldBounds() const {
+    if (!mesh) {
+        return BoundingBox(position, position);
+    }
+    return mesh->getBounds().transformed(getModelMatrix());
+}
+
 Scene::Scene()
-    : m_camera(60.0f, 16.0f / 9.0f, 0.1f, 100.0f)
+    : m_bulkAdding(false)
+    , m_structureVersion(0)
+    , m_camera(60.0f, 16.0f / 9.0f, 0.1f, 100.0f)
 {
     // Initialize with default Plastiboo lighting
     m_lights = createPlastibooLighting();
@@ -35,8 +44,8 @@ Scene::Scene()
     m_camera.lookAt(glm::vec3(0.0f, 0.0f, 0.0f));
 }
 
-void Scene::addObject(std::shared_ptr<Mesh> mesh, std::shared_ptr<PlastibooMaterial> material,
-                      const glm::vec3& position, const glm::vec3& rotation, const glm::vec3& scale) {
+uint32_t Scene::addObject(std::shared_ptr<Mesh> mesh, std::shared_ptr<PlastibooMaterial> material,
+                          const glm::vec3& position, const glm::vec3& rotation, const glm::vec3& scale) {
     RenderObject obj;
     obj.mesh = mesh;
     obj.material = material;
@@ -44,7 +53,128 @@ void Scene::addObject(std::shared_ptr<Mesh> mesh, std::shared_ptr<PlastibooMater
     obj.rotation = rotation;
     obj.scale = scale;
 
+    uint32_t index = static_cast<uint32_t>(m_objects.size());
     m_objects.push_back(obj);
+    m_objectBounds.push_back(obj.getWorldBounds());
+    m_proxies.push_back(m_bulkAdding ? DynamicAABBTree::NULL_NODE
+                                     : m_spatialIndex.createProxy(m_objectBounds.back(), index));
+    m_structureVersion++;
+    return index;
+}
+
+void Scene::removeObject(uint32_t index) {
+    if (m_proxies[index] != DynamicAABBTree::NULL_NODE) {
+        m_spatialIndex.destroyProxy(m_proxies[index]);
+    }
+
+    // Swap the last object in so indices stay dense
+    uint32_t last = static_cast<uint32_t>(m_objects.size() - 1);
+    if (index != last) {
+        m_objects[index] = std::move(m_objects[last]);
+        m_objectBounds[index] = m_objectBounds[last];
+        m_proxies[index] = m_proxies[last];
+        if (m_proxies[index] != DynamicAABBTree::NULL_NODE) {
+            m_spatialIndex.setUserData(m_proxies[index], index);
+        }
+    }
+
+    m_objects.pop_back();
+    m_objectBounds.pop_back();
+    m_proxies.pop_back();
+    m_structureVersion++;
+}
+
+void Scene::moveObject(uint32_t index, const glm::vec3& position, const glm::vec3& rotation, const glm::vec3& scale) {
+    RenderObject& obj = m_objects[index];
+    obj.position = position;
+    obj.rotation = rotation;
+    obj.scale = scale;
+    updateObjectBounds(index);
+}
+
+void Scene::updateObjectBounds(uint32_t index) {
+    m_objectBounds[index] = m_objects[index].getWorldBounds();
+    if (m_proxies[index] != DynamicAABBTree::NULL_NODE) {
+        m_spatialIndex.moveProxy(m_proxies[index], m_objectBounds[index]);
+    }
+}
+
+void Scene::setSpatialIndexMargin(float margin, float marginScale) {
+    m_spatialIndex.setMargin(margin, marginScale);
+    if (!m_bulkAdding) {
+        endBulkAdd();
+    }
+}
+
+void Scene::endBulkAdd() {
+    m_bulkAdding = false;
+
+    std::vector<uint32_t> indices(m_objects.size());
+    for (uint32_t i = 0; i < static_cast<uint32_t>(indices.size()); i++) {
+        indices[i] = i;
+    }
+    m_spatialIndex.build(m_objectBounds, indices, m_proxies);
+}
+
+void Scene::queryFrustum(const Frustum& frustum, std::vector<uint32_t>& results) const {
+    results.clear();
+    m_spatialIndex.query(frustum, [&](uint32_t index) {
+        results.push_back(index);
+        return true;
+    });
+}
+
+void Scene::queryBox(const BoundingBox& box, std::vector<uint32_t>& results) const {
+    results.clear();
+    m_spatialIndex.query(box, [&](uint32_t index) {
+        results.push_back(index);
+        return true;
+    });
+}
+
+void Scene::querySphere(const glm::vec3& center, float radius, std::vector<uint32_t>& results) const {
+    results.clear();
+    BoundingBox sphereBox(center - glm::vec3(radius), center + glm::vec3(radius));
+    m_spatialIndex.query(sphereBox, [&](uint32_t index) {
+        const BoundingBox& bounds = m_objectBounds[index];
+        glm::vec3 closest = glm::clamp(center, bounds.min, bounds.max);
+        glm::vec3 offset = closest - center;
+        if (glm::dot(offset, offset) <= radius * radius) {
+            results.push_back(index);
+        }
+        return true;
+    });
+}
+
+bool Scene::raycast(const Ray& ray, float maxDistance, RaycastHit& hit) const {
+    bool found = false;
+    m_spatialIndex.raycast(ray, maxDistance, [&](uint32_t index, float) {
+        // The leaf box is enlarged; test the tight bounds before accepting
+        float distance = 0.0f;
+        if (!ray.intersects(m_objectBounds[index], maxDistance, distance)) {
+            return maxDistance;
+        }
+        maxDistance = distance;
+        hit.objectIndex = index;
+        hit.distance = distance;
+        found = true;
+        return distance;
+    });
+    return found;
+}
+
+bool Scene::isSegmentBlocked(const glm::vec3& from, const glm::vec3& to) const {
+    Ray ray(from, to - from);
+    bool blocked = false;
+    m_spatialIndex.raycast(ray, 1.0f, [&](uint32_t index, float) {
+        float distance = 0.0f;
+        if (ray.intersects(m_objectBounds[index], 1.0f, distance)) {
+            blocked = true;
+            return -1.0f;
+        }
+        return 1.0f;
+    });
+    return blocked;
 }
 
 }
@@ -4,6 +4,9 @@
 #include "../renderer/PlastibooMaterial.h"
 #include "../renderer/UniformBuffers.h"
 #include "../components/Camera.h"
+#include "../math/Frustum.h"
+#include "../math/Ray.h"
+#include "DynamicAABBTree.h"
 #include <memory>
 #include <vector>
 #include <glm/glm.hpp>
@@ -25,6 +28,14 @@ struct RenderObject {
 
     glm::mat4 getModelMatrix() const;
     glm::mat4 getNormalMatrix() const;
+
+    // Mesh bounds in world space (a point at position when there is no mesh)
+    BoundingBox getWorldBounds() const;
+};
+
+struct RaycastHit {
+    uint32_t objectIndex = 0;
+    float distance = 0.0f;
 };
 
 class Scene {
@@ -32,15 +43,58 @@ public:
     Scene();
     ~Scene() = default;
 
-    // Object management
-    void addObject(std::shared_ptr<Mesh> mesh, std::shared_ptr<PlastibooMaterial> material,
-                   const glm::vec3& position = glm::vec3(0.0f),
-                   const glm::vec3& rotation = glm::vec3(0.0f),
-                   const glm::vec3& scale = glm::vec3(1.0f));
+    // Object management. Objects are addressed by index; removeObject() moves
+    // the last object into the removed slot.
+    uint32_t addObject(std::shared_ptr<Mesh> mesh, std::shared_ptr<PlastibooMaterial> material,
+                       const glm::vec3& position = glm::vec3(0.0f),
+                       const glm::vec3& rotation = glm::vec3(0.0f),
+                       const glm::vec3& scale = glm::vec3(1.0f));
+    void removeObject(uint32_t index);
+    void moveObject(uint32_t index, const glm::vec3& position, const glm::vec3& rotation, const glm::vec3& scale);
+
+    // Call after editing an object's transform or mesh through getObjects()
+    void updateObjectBounds(uint32_t index);
+
+    // Level loading: objects added between these calls skip incremental
+    // insertion and the spatial index is bulk built once at the end
+    void beginBulkAdd() { m_bulkAdding = true; }
+    void endBulkAdd();
 
     std::vector<RenderObject>& getObjects() { return m_objects; }
     const std::vector<RenderObject>& getObjects() const { return m_objects; }
 
+    // Tight world-space bounds, kept in step with the spatial index
+    const BoundingBox& getObjectBounds(uint32_t index) const { return m_objectBounds[index]; }
+
+    // Spatial queries through the BVH. Results are object indices; box and
+    // frustum queries test the tree's slightly enlarged leaf boxes, so callers
+    // wanting an exact answer re-test getObjectBounds().
+    void queryFrustum(const Frustum& frustum, std::vector<uint32_t>& results) const;
+    void queryBox(const BoundingBox& box, std::vector<uint32_t>& results) const;
+
+    // Objects whose bounds touch a sphere, e.g. those a point light would reach
+    void querySphere(const glm::vec3& center, float radius, std::vector<uint32_t>& results) const;
+
+    // Closest object bounds along the ray within maxDistance, e.g. for picking
+    bool raycast(const Ray& ray, float maxDistance, RaycastHit& hit) const;
+
+    // True when any object bounds cross the segment, e.g. for sound occlusion
+    bool isSegmentBlocked(const glm::vec3& from, const glm::vec3& to) const;
+
+    const DynamicAABBTree& getSpatialIndex() const { return m_spatialIndex; }
+
+    // How far leaf boxes are grown (DynamicAABBTree::setMargin). Larger margins
+    // absorb more moves without reinsertion but make queries test more leaves.
+    // The index is rebuilt so existing objects use the new margin.
+    void setSpatialIndexMargin(float margin, float marginScale);
+
+    // Bumped whenever objects are added, removed or their mesh/material changes, so
+    // renderers can cache per-scene draw structures. Transform edits through
+    // getObjects() do not need it; call markStructureChanged() after swapping
+    // an object's mesh or material.
+    uint64_t getStructureVersion() const { return m_structureVersion; }
+    void markStructureChanged() { m_structureVersion++; }
+
     // Camera access
     Camera& getCamera() { return m_camera; }
     const Camera& getCamera() const { return m_camera; }
@@ -53,6 +107,11 @@ public:
 
 private:
     std::vector<RenderObject> m_objects;
+    std::vector<BoundingBox> m_objectBounds;
+    std::vector<int32_t> m_proxies;     // Spatial index proxy per object
+    DynamicAABBTree m_spatialIndex;
+    bool m_bulkAdding;
+    uint64_t m_structureVersion;
     Camera m_camera;
     LightUBO m_lights;
 };
@@ -0,0 +1,10 @@
+#version 450
+
+// One triangle covering the target, drawn with three vertices and no vertex
+// buffer. Post effects read fragUV, 0..1 across the target.
+layout(location = 0) out vec2 fragUV;
+
+void main() {
+  fragUV = vec2((gl_VertexIndex << 1) & 2, gl_VertexIndex & 2);
+  gl_Position = vec4(fragUV * 2.0 - 1.0, 0.0, 1.0);
+}
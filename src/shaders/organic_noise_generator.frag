@@ -0,0 +1,70 @@
+#version 450
+
+// Animated organic noise, regenerated every frame by the post chain for
+// effects that sample it. r is the layered fbm detail, g and b two of its
+// layers modulated by the breathing pattern, a the detail again.
+layout(location = 0) in vec2 fragUV;
+layout(location = 0) out vec4 outColor;
+
+layout(push_constant) uniform PostConstants {
+  vec2 inverseInputSize;
+  float time;
+  uint frame;
+  vec2 targetSize;
+  vec2 depthRange;
+} post;
+
+const float NOISE_SCALE = 3.0;
+const int NOISE_OCTAVES = 4;
+const float NOISE_PERSISTENCE = 0.5;
+
+float hash(vec3 p) {
+  p = fract(p * vec3(443.8975, 397.2973, 491.1871));
+  p += dot(p, p.yxz + 19.19);
+  return fract((p.x + p.y) * p.z);
+}
+
+float noise3D(vec3 p) {
+  vec3 i = floor(p);
+  vec3 f = fract(p);
+  f = f * f * (3.0 - 2.0 * f);
+
+  return mix(mix(mix(hash(i + vec3(0, 0, 0)), hash(i + vec3(1, 0, 0)), f.x),
+                 mix(hash(i + vec3(0, 1, 0)), hash(i + vec3(1, 1, 0)), f.x), f.y),
+             mix(mix(hash(i + vec3(0, 0, 1)), hash(i + vec3(1, 0, 1)), f.x),
+                 mix(hash(i + vec3(0, 1, 1)), hash(i + vec3(1, 1, 1)), f.x), f.y), f.z);
+}
+
+float fbm(vec3 p) {
+  float total = 0.0;
+  float frequency = 1.0;
+  float amplitude = 1.0;
+  float maxValue = 0.0;
+
+  for (int i = 0; i < NOISE_OCTAVES; i++) {
+    total += noise3D(p * frequency) * amplitude;
+    maxValue += amplitude;
+    amplitude *= NOISE_PERSISTENCE;
+    frequency *= 2.0;
+  }
+
+  return total / maxValue;
+}
+
+void main() {
+  vec2 coord = fragUV;
+  float time = post.time;
+  vec3 p = vec3(coord * NOISE_SCALE, time * 0.1);
+
+  float noise1 = fbm(p);
+  float noise2 = fbm(p * 2.0 + vec3(100.0, 50.0, time * 0.05));
+  float noise3 = fbm(p * 4.0 + vec3(200.0, 150.0, time * 0.02));
+
+  // Breathing, pulsing pattern over the layered detail
+  float breathingPattern = sin(time * 2.0 + coord.x * 3.0) * cos(time * 1.5 + coord.y * 2.0) * 0.5 + 0.5;
+
+  float organicDetail = noise1 * 0.5 + noise2 * 0.3 + noise3 * 0.2;
+  organicDetail = mix(organicDetail, organicDetail * breathingPattern, 0.3);
+
+  outColor = vec4(organicDetail, noise2 * breathingPattern, noise3 * (1.0 - breathingPattern * 0.5), organicDetail);
+}
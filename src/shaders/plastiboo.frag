@@ -1,17 +1,25 @@
 #version 450 
 
+// Every material lives in one storage buffer (MaterialRegistry), read by the
+// index the vertex stage passes on from the object's data. BINDLESS also samples textures from one descriptor
+// array; otherwise set 2 holds fixed palette, blue noise and albedo textures.
+#ifdef BINDLESS
+#extension GL_EXT_nonuniform_qualifier : require
+#endif
+
 layout(location = 0) in vec3 fragWorldPos;
 layout(location = 1) in vec3 fragNormal;
 layout(location = 2) in vec2 fragTexCoord;
 layout(location = 3) in vec3 fragColor;
 layout(location = 4) in vec3 fragVertexLighting;
 layout(location = 5) in float fragDepth;
+layout(location = 6) flat in uint fragMaterialIndex;
 
 
 layout(location = 0) out vec4 outColor;
 
 
-layout(set = 2, binding = 0) uniform MaterialUBO {
+struct MaterialData {
   vec4 baseColor;
   float clayRoughness;
   float ditherStrength;
@@ -19,15 +27,25 @@ layout(set = 2, binding = 0) uniform MaterialUBO {
   int paletteIndex;
   int useDithering;
   int useAffineMapping;
-} material;
+  int albedoTexture;
+  float padding;
+};
 
+layout(std430, set = 2, binding = 0) readonly buffer MaterialRegistry {
+  MaterialData materials[];
+} materialRegistry;
 
+MaterialData material;
 
+#ifdef BINDLESS
+layout(set = 2, binding = 1) uniform sampler2D textures[];
+#else
 layout(set = 2, binding = 1) uniform sampler2D paletteTex;
 
 layout(set = 2, binding = 2) uniform sampler2D blueNoiseTex;
 
 layout(set = 2, binding = 3) uniform sampler2D albedoTex;
+#endif
 
 
 const int bayerMatrix[64] = int[](
@@ -94,6 +112,9 @@ vec3 applyDithering(vec3 color, float strength) {
 }
 
 void main() {
+  // Every draw is a single material, so the index is uniform within a draw
+  material = materialRegistry.materials[fragMaterialIndex];
+
   vec2 texCoord = fragTexCoord;
   if (material.useAffineMapping == 1) {
     texCoord = fragTexCoord / fragDepth;
@@ -101,7 +122,12 @@ void main() {
 
   vec3 albedo = material.baseColor.rgb * fragColor;
 
+#ifdef BINDLESS
+  // The index comes from a push constant, so it is uniform across the draw
+  albedo *= texture(textures[material.albedoTexture], texCoord).rgb;
+#else
   // albedo *= texture(albedoTex, texCoord).rgb;
+#endif
 
   vec3 litColor = albedo * fragVertexLighting;
   
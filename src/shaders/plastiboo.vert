@@ -1,10 +1,20 @@
 #version 450
 
 
+// PACKED_VERTEX selects PackedPlastibooVertex: unorm16 positions within the
+// mesh's box (the model matrix carries the dequantisation), octahedral
+// normals, half float UVs and RGBA8 colour
+#ifdef PACKED_VERTEX
+layout(location = 0) in vec4 inPosition;
+layout(location = 1) in vec2 inNormal;
+layout(location = 2) in vec2 inTexCoord;
+layout(location = 3) in vec4 inColor;
+#else
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inNormal;
 layout(location = 2) in vec2 inTexCoord;
 layout(location = 3) in vec3 inColor;
+#endif
 
 layout(set = 0, binding = 0) uniform CameraUBO {
   mat4 view;
@@ -12,10 +22,27 @@ layout(set = 0, binding = 0) uniform CameraUBO {
   vec3 cameraPos;
 } camera;
 
-layout(set = 1, binding = 0) uniform ObjectUBO {
+struct ObjectData {
   mat4 model;
-  mat4 normalMatrix;
-} object;
+  mat3x4 normalMatrix;
+  uint materialIndex;
+};
+
+// One entry per object, written once per frame in batch order. gl_InstanceIndex
+// (firstInstance + instance) selects the slot, so instanced draws need no extra data
+layout(std430, set = 1, binding = 0) readonly buffer ObjectBuffer {
+  ObjectData objects[];
+} objectBuffer;
+
+// Per-draw data (DrawPushConstants). objectOffset is zero for instanced draws
+// and the object's slot when objects are drawn one at a time.
+layout(push_constant) uniform DrawConstants {
+  uint objectOffset;
+} draw;
+
+// The depth pre-pass runs this same shader; invariance guarantees both passes
+// produce bit-identical depth so the main pass can test with LESS_OR_EQUAL
+invariant gl_Position;
 
 layout(location = 0 ) out vec3 fragWorldPos;
 layout(location = 1) out vec3 fragNormal;
@@ -23,6 +50,7 @@ layout(location = 2) out vec2 fragTexCoord;
 layout(location = 3) out vec3 fragColor;
 layout(location = 4) out vec3 fragVertexLighting;
 layout(location = 5) out float fragDepth;
+layout(location = 6) flat out uint fragMaterialIndex;
 
 
 layout(set = 0, binding = 1) uniform LightUBO {
@@ -31,6 +59,14 @@ layout(set = 0, binding = 1) uniform LightUBO {
   int numLights;
 } lights;
 
+vec3 decodeOctahedral(vec2 e) {
+  vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+  float t = max(-n.z, 0.0);
+  n.x += n.x >= 0.0 ? -t : t;
+  n.y += n.y >= 0.0 ? -t : t;
+  return normalize(n);
+}
+
 vec3 snapToGrid(vec3 pos, float gridSize) {
   return floor(pos / gridSize) * gridSize;
 }
@@ -58,10 +94,22 @@ vec3 calculateVertexLighting(vec3 worldPos, vec3 normal) {
 }
 
 void main() {
-  vec4 worldPos = object.model * vec4(inPosition, 1.0);
+  ObjectData object = objectBuffer.objects[draw.objectOffset + gl_InstanceIndex];
+
+#ifdef PACKED_VERTEX
+  vec3 position = inPosition.xyz;
+  vec3 normal = decodeOctahedral(inNormal);
+  vec3 color = inColor.rgb;
+#else
+  vec3 position = inPosition;
+  vec3 normal = inNormal;
+  vec3 color = inColor;
+#endif
+
+  vec4 worldPos = object.model * vec4(position, 1.0);
   fragWorldPos = worldPos.xyz;
 
-  fragNormal = normalize(mat3(object.normalMatrix) * inNormal);
+  fragNormal = normalize(mat3(object.normalMatrix) * normal);
   
   float snapResolution = 0.05;
   vec3 snappedWorldPos = snapToGrid(fragWorldPos, snapResolution);
@@ -74,7 +122,8 @@ void main() {
   
   fragTexCoord = inTexCoord.xy * clipPos.w;
   
-  fragColor = inColor;
+  fragColor = color;
+  fragMaterialIndex = object.materialIndex;
   
   gl_Position = clipPos;
 }
@@ -0,0 +1,172 @@
+#version 450
+
+// Plastiboo look: PS1 snapping artifacts, organic breathing driven by the
+// post chain's noise, depth fog and vignette, hue drift, then a pull towards
+// one of four 8-colour palettes. Reads scene depth and organic noise.
+layout(location = 0) in vec2 fragUV;
+layout(location = 0) out vec4 outColor;
+
+layout(set = 0, binding = 0) uniform sampler2D inputTexture;
+layout(set = 0, binding = 1) uniform sampler2D depthTexture;
+layout(set = 0, binding = 2) uniform sampler2D organicNoise;
+
+layout(push_constant) uniform PostConstants {
+  vec2 inverseInputSize;
+  float time;
+  uint frame;
+  vec2 targetSize;
+  vec2 depthRange;
+} post;
+
+const float VERTEX_SNAP_EFFECT = 0.7;  // PS1 pixelation strength
+const float PALETTE_REDUCTION = 0.8;   // Colour quantization
+const float ORGANIC_BREATHING = 0.3;   // Living, breathing effect
+const float HORROR_ATMOSPHERE = 0.5;   // Unsettling distortions
+const float ANCIENT_DISTORTION = 0.2;  // Mysterious warping
+const int PALETTE_TYPE = 0;            // Medieval, ancient forest, cursed monastery, plague village
+
+const vec3 medievalPalette[8] = vec3[](
+  vec3(0.08, 0.06, 0.04),  // Deep shadow
+  vec3(0.15, 0.12, 0.08),  // Dark stone
+  vec3(0.25, 0.20, 0.12),  // Worn stone
+  vec3(0.40, 0.32, 0.20),  // Old wood
+  vec3(0.55, 0.45, 0.25),  // Torch light
+  vec3(0.70, 0.60, 0.35),  // Warm highlight
+  vec3(0.12, 0.15, 0.08),  // Moss shadow
+  vec3(0.35, 0.40, 0.25)   // Forest green
+);
+
+const vec3 ancientForestPalette[8] = vec3[](
+  vec3(0.05, 0.08, 0.05),  // Deep forest shadow
+  vec3(0.12, 0.18, 0.10),  // Dark moss
+  vec3(0.20, 0.28, 0.15),  // Forest green
+  vec3(0.35, 0.25, 0.15),  // Tree bark
+  vec3(0.45, 0.35, 0.20),  // Autumn light
+  vec3(0.25, 0.35, 0.20),  // Sage green
+  vec3(0.15, 0.25, 0.12),  // Deep green
+  vec3(0.40, 0.45, 0.25)   // Bright moss
+);
+
+const vec3 cursedMonasteryPalette[8] = vec3[](
+  vec3(0.08, 0.06, 0.12),  // Purple shadow
+  vec3(0.15, 0.12, 0.18),  // Cold stone
+  vec3(0.22, 0.20, 0.25),  // Ghostly gray
+  vec3(0.35, 0.30, 0.40),  // Pale purple
+  vec3(0.50, 0.45, 0.55),  // Ethereal light
+  vec3(0.18, 0.15, 0.25),  // Dark violet
+  vec3(0.30, 0.25, 0.35),  // Mystic purple
+  vec3(0.60, 0.55, 0.65)   // Ghost white
+);
+
+const vec3 plagueVillagePalette[8] = vec3[](
+  vec3(0.12, 0.10, 0.06),  // Diseased shadow
+  vec3(0.22, 0.18, 0.08),  // Sickly yellow
+  vec3(0.30, 0.25, 0.12),  // Rotting wood
+  vec3(0.18, 0.22, 0.08),  // Plague green
+  vec3(0.35, 0.30, 0.15),  // Feverish light
+  vec3(0.25, 0.20, 0.10),  // Decay brown
+  vec3(0.28, 0.24, 0.10),  // Sick yellow-green
+  vec3(0.40, 0.35, 0.18)   // Pale sick light
+);
+
+vec3 getPaletteColor(int index) {
+  if (PALETTE_TYPE == 1) {
+    return ancientForestPalette[index];
+  } else if (PALETTE_TYPE == 2) {
+    return cursedMonasteryPalette[index];
+  } else if (PALETTE_TYPE == 3) {
+    return plagueVillagePalette[index];
+  }
+  return medievalPalette[index];
+}
+
+// Distance from the camera; the scene projection maps -1..1 NDC depth and
+// Vulkan keeps the 0..1 half of it
+float linearDepth(float depth) {
+  float nearPlane = post.depthRange.x;
+  float farPlane = post.depthRange.y;
+  return 2.0 * nearPlane * farPlane / (farPlane + nearPlane - depth * (farPlane - nearPlane));
+}
+
+vec3 quantizeToPalette(vec3 color) {
+  float minDistance = 1000.0;
+  vec3 nearestColor = getPaletteColor(0);
+
+  for (int i = 0; i < 8; ++i) {
+    vec3 paletteColor = getPaletteColor(i);
+    float distance = length(color - paletteColor);
+    if (distance < minDistance) {
+      minDistance = distance;
+      nearestColor = paletteColor;
+    }
+  }
+
+  return nearestColor;
+}
+
+vec3 applyOrganicBreathing(vec3 color, vec2 screenPos) {
+  float breathingPattern = sin(post.time * 2.0 + screenPos.x * 5.0) *
+                           cos(post.time * 1.5 + screenPos.y * 3.0);
+
+  // The noise is already animated, so it is sampled where the pixel is
+  float noise = texture(organicNoise, screenPos).r;
+
+  float breathingIntensity = (breathingPattern * 0.5 + 0.5) * noise * ORGANIC_BREATHING;
+  return color + vec3(0.05, 0.03, 0.02) * breathingIntensity;
+}
+
+vec3 applyHorrorAtmosphere(vec3 color, vec2 screenPos, float depth) {
+  // Depth fog towards the darkest palette colour
+  float fogFactor = 1.0 - exp(-depth * 0.08);
+  vec3 fogColor = getPaletteColor(0) * 0.7;
+  color = mix(color, fogColor, fogFactor * HORROR_ATMOSPHERE);
+
+  // Vignetting for a claustrophobic feel
+  vec2 vignetteCoord = (screenPos - 0.5) * 2.0;
+  float vignette = 1.0 - length(vignetteCoord) * 0.4 * HORROR_ATMOSPHERE;
+  return color * vignette;
+}
+
+vec3 applyAncientDistortion(vec3 color, vec2 screenPos) {
+  float distortionPattern = sin(post.time + screenPos.x * 8.0) *
+                            cos(post.time * 0.7 + screenPos.y * 6.0);
+  float hueShift = distortionPattern * ANCIENT_DISTORTION * 0.1;
+
+  // Approximate hue shift around the grey axis
+  float avg = (color.r + color.g + color.b) / 3.0;
+  color.r = mix(color.r, avg + sin(hueShift) * 0.1, abs(hueShift));
+  color.g = mix(color.g, avg + sin(hueShift + 2.094) * 0.1, abs(hueShift));
+  color.b = mix(color.b, avg + sin(hueShift + 4.188) * 0.1, abs(hueShift));
+  return color;
+}
+
+vec3 applyVertexSnapping(vec3 color, vec2 screenPos) {
+  // Grid artifacts like those of PS1 vertex snapping
+  vec2 snapGrid = post.targetSize * VERTEX_SNAP_EFFECT;
+  vec2 snappedCoords = floor(screenPos * snapGrid) / snapGrid;
+
+  float snapArtifact = fract(length(screenPos - snappedCoords) * 10.0);
+  return color * (1.0 - snapArtifact * VERTEX_SNAP_EFFECT * 0.05);
+}
+
+void main() {
+  vec2 screenPos = fragUV;
+
+  vec4 originalColor = texture(inputTexture, fragUV);
+  float depth = linearDepth(texture(depthTexture, fragUV).r);
+
+  vec3 finalColor = originalColor.rgb;
+  finalColor = applyVertexSnapping(finalColor, screenPos);
+  finalColor = applyOrganicBreathing(finalColor, screenPos);
+  finalColor = applyHorrorAtmosphere(finalColor, screenPos, depth);
+  finalColor = applyAncientDistortion(finalColor, screenPos);
+
+  vec3 quantized = quantizeToPalette(finalColor);
+  finalColor = mix(finalColor, quantized, PALETTE_REDUCTION);
+
+  // Film grain from a drifting, tiled read of the noise
+  float grain = texture(organicNoise, fract(screenPos * 5.0 + vec2(0.37, 0.61) * post.time)).b;
+  finalColor += (grain - 0.5) * 0.03;
+
+  outColor = vec4(finalColor, originalColor.a);
+}
@@ -0,0 +1,129 @@
+#version 450
+
+// PS1 artifacts (affine-style warping, z-buffer flicker, colour banding),
+// then spatiotemporal dithering into a 12-colour medieval palette with
+// scanlines, grain and a slow breathing. Reads scene depth.
+layout(location = 0) in vec2 fragUV;
+layout(location = 0) out vec4 outColor;
+
+layout(set = 0, binding = 0) uniform sampler2D inputTexture;
+layout(set = 0, binding = 1) uniform sampler2D depthTexture;
+
+layout(push_constant) uniform PostConstants {
+  vec2 inverseInputSize;
+  float time;
+  uint frame;
+  vec2 targetSize;
+  vec2 depthRange;
+} post;
+
+const float TEXTURE_WARPING = 0.3;     // Affine texture mapping artifacts
+const float ZBUFFER_NOISE = 0.02;      // Z-buffer precision issues
+const float COLOR_BANDING = 0.5;       // Reduced colour precision
+const float SCANLINE_INTENSITY = 0.3;  // CRT scanlines
+const float DITHER_STRENGTH = 1.0;
+
+const vec3 medievalPalette[12] = vec3[](
+  vec3(0.08, 0.06, 0.04),  // Deep shadow
+  vec3(0.15, 0.12, 0.08),  // Dark brown
+  vec3(0.25, 0.20, 0.12),  // Medium brown
+  vec3(0.40, 0.32, 0.20),  // Light brown
+  vec3(0.55, 0.45, 0.25),  // Warm wood
+  vec3(0.70, 0.60, 0.35),  // Torch light
+  vec3(0.12, 0.15, 0.08),  // Dark moss
+  vec3(0.20, 0.25, 0.15),  // Forest green
+  vec3(0.35, 0.40, 0.25),  // Sage green
+  vec3(0.45, 0.35, 0.15),  // Rust/copper
+  vec3(0.25, 0.20, 0.25),  // Purple shadow
+  vec3(0.85, 0.75, 0.50)   // Ancient gold highlight
+);
+
+// Scene depth as a 0..1 fraction of the far plane; see linearDepth in
+// plastiboo_postprocess.frag
+float sceneDepth(vec2 uv) {
+  float nearPlane = post.depthRange.x;
+  float farPlane = post.depthRange.y;
+  float depth = texture(depthTexture, uv).r;
+  return 2.0 * nearPlane / (farPlane + nearPlane - depth * (farPlane - nearPlane));
+}
+
+// Interleaved gradient noise stepped through 64 frames, standing in for a
+// 128x128x64 blue noise volume
+float spatiotemporalNoise(vec2 pixel) {
+  pixel += 5.588238 * float(post.frame % 64u);
+  return fract(52.9829189 * fract(dot(pixel, vec2(0.06711056, 0.00583715))));
+}
+
+vec3 findNearestPaletteColor(vec3 color) {
+  float minDistance = 1000.0;
+  vec3 nearestColor = medievalPalette[0];
+
+  for (int i = 0; i < 12; ++i) {
+    float distance = length(color - medievalPalette[i]);
+    if (distance < minDistance) {
+      minDistance = distance;
+      nearestColor = medievalPalette[i];
+    }
+  }
+
+  return nearestColor;
+}
+
+vec3 applyTextureWarping(vec3 color, float depth) {
+  // PS1 had no perspective correction, so warp the lookup by depth
+  vec2 warpedCoord = fragUV + vec2(sin(fragUV.y * 20.0 + depth * 10.0),
+                                   cos(fragUV.x * 15.0 + depth * 8.0)) * TEXTURE_WARPING * 0.01;
+  vec3 warpedColor = texture(inputTexture, warpedCoord).rgb;
+  return mix(color, warpedColor, TEXTURE_WARPING * 0.3);
+}
+
+vec3 applyZBufferNoise(vec3 color, vec2 screenPos, float depth) {
+  // Flicker like z-fighting, stronger with distance
+  float zNoise = fract(sin(dot(screenPos + depth, vec2(12.9898, 78.233))) * 43758.5453);
+  zNoise = (zNoise - 0.5) * 2.0;
+  return color + vec3(zNoise * depth * ZBUFFER_NOISE);
+}
+
+vec3 applyColorBanding(vec3 color) {
+  float colorLevels = mix(256.0, 32.0, COLOR_BANDING);
+  vec3 bandedColor = floor(color * colorLevels) / colorLevels;
+  return mix(color, bandedColor, COLOR_BANDING);
+}
+
+vec3 applyScanlines(vec3 color, vec2 screenPos) {
+  float scanline = sin(screenPos.y * post.targetSize.y * 2.0) * 0.5 + 0.5;
+  scanline = mix(1.0, scanline, SCANLINE_INTENSITY);
+
+  // Phosphor persistence
+  float phosphor = sin(screenPos.y * post.targetSize.y * 6.0 + post.time * 10.0) * 0.1 + 0.9;
+  return color * scanline * phosphor;
+}
+
+vec3 applyFilmGrain(vec3 color, vec2 screenPos) {
+  float grain = fract(sin(dot(screenPos + post.time, vec2(12.9898, 78.233))) * 43758.5453);
+  grain = (grain - 0.5) * 0.1;
+  float temporalGrain = sin(post.time * 50.0 + screenPos.x * 100.0) * 0.02;
+  return color + vec3(grain + temporalGrain);
+}
+
+void main() {
+  vec2 screenPos = fragUV;
+  vec4 originalColor = texture(inputTexture, fragUV);
+  float depth = sceneDepth(fragUV);
+
+  vec3 finalColor = originalColor.rgb;
+  finalColor = applyTextureWarping(finalColor, depth);
+  finalColor = applyZBufferNoise(finalColor, screenPos, depth);
+  finalColor = applyColorBanding(finalColor);
+
+  // More dither at distance
+  float ditherIntensity = DITHER_STRENGTH * (1.0 + depth * 0.5);
+  vec3 ditheredColor = finalColor + (spatiotemporalNoise(gl_FragCoord.xy) - 0.5) * ditherIntensity * 0.1;
+
+  vec3 quantizedColor = findNearestPaletteColor(ditheredColor);
+  quantizedColor = applyScanlines(quantizedColor, screenPos);
+  quantizedColor = applyFilmGrain(quantizedColor, screenPos);
+
+  float breathe = sin(post.time * 1.5 + screenPos.x + screenPos.y) * 0.01 + 1.0;
+  outColor = vec4(quantizedColor * breathe, originalColor.a);
+}
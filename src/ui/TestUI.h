@@ -1,6 +1,7 @@
 #pragma once
 
 #include <imgui.h>
+#include "../renderer/RenderStats.h"
 
 class TestUI {
 public:
@@ -12,6 +13,27 @@ public:
         RenderOutliner();
     }
 
+    static void RenderStatsOverlay(const Plaster::RenderStats& stats) {
+        ImGui::SetNextWindowPos(ImVec2(40, 100), ImGuiCond_FirstUseEver);
+        ImGui::SetNextWindowBgAlpha(0.6f);
+
+        ImGui::Begin("Render Stats", nullptr, ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoFocusOnAppearing);
+
+        ImGui::Text("Objects: %u visible, %u culled", stats.objects, stats.culledObjects);
+        ImGui::Text("Draw calls: %u", stats.drawCalls);
+        ImGui::Text("Depth pre-pass draws: %u", stats.prepassDrawCalls);
+        ImGui::Separator();
+        ImGui::Text("Pipeline binds: %u", stats.pipelineBinds);
+        ImGui::Text("Descriptor set binds: %u", stats.descriptorSetBinds);
+        ImGui::Text("Vertex buffer binds: %u", stats.vertexBufferBinds);
+        ImGui::Text("Binds saved: %u", stats.bindsSaved);
+        ImGui::Separator();
+        ImGui::Text("Fragment invocations: %llu", static_cast<unsigned long long>(stats.fragmentInvocations));
+        ImGui::Text("Overdraw: %.2fx", stats.overdraw);
+
+        ImGui::End();
+    }
+
 private:
     static void RenderMainMenuBar() {
         if (ImGui::BeginMainMenuBar()) {